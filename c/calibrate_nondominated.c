@@ -0,0 +1,181 @@
+/*************************************************************************
+
+ calibrate_nondominated: measure, for each number of objectives, the number
+ of points for which Kung's algorithm becomes faster than brute force, and
+ print nondominated_dispatch.h.
+
+ Usage: make calibrate
+
+*************************************************************************/
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "nondominated.h"
+#include "sort.h"
+#include "rng.h"
+#include "timer.h"
+
+// Number of points tried, Kung's algorithm requires more than KUNG_SMALL_THRESHOLD.
+static const size_t sizes[] = {
+    KUNG_SMALL_THRESHOLD + 1, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512,
+    768, 1024, 1536, 2048, 3072, 4096, 6144, 8192 };
+#define NSIZES (sizeof(sizes) / sizeof(sizes[0]))
+// Stop after Kung's algorithm wins this many consecutive sizes.
+#define CONSECUTIVE_WINS 3
+// Minimum time (seconds) per measurement.
+#define MIN_TIME 0.02
+
+enum { RANDOM_CUBE, SPHERE_FRONT, NKINDS };
+
+/* Uniform points in [0,1]^dim (many dominated) or on the positive orthant of
+   the unit sphere (all nondominated).  */
+static double *
+generate_points(rng_state * rng, size_t size, dimension_t dim, int kind)
+{
+    double * points = MOOCORE_MALLOC(size * dim, double);
+    for (size_t k = 0; k < size; k++) {
+        double * p = points + k * dim;
+        double norm = 0;
+        for (dimension_t d = 0; d < dim; d++) {
+            p[d] = (kind == RANDOM_CUBE) ? rng_random(rng)
+                : fabs(rng_standard_normal(rng));
+            norm += p[d] * p[d];
+        }
+        if (kind == SPHERE_FRONT) {
+            norm = sqrt(norm);
+            for (dimension_t d = 0; d < dim; d++)
+                p[d] /= norm;
+        }
+    }
+    return points;
+}
+
+static double
+time_engine(const double * points, size_t size, dimension_t dim,
+            bool find_dominated, bool kung, boolvec * nondom)
+{
+    size_t reps = 0;
+    size_t dummy = 0;
+    Timer_t timer = timer_start(REAL_TIME);
+    double elapsed;
+    do {
+        if (find_dominated) {
+            dummy += kung
+                ? find_dominated_point_kung(points, size, dim, false)
+                : find_dominated_point_agree_bf(points, size, dim, false,
+                                                AGREE_MINIMISE, NULL);
+        } else {
+            nondom_init_true(nondom, size);
+            dummy += kung
+                ? find_nondominated_set_kung(points, size, dim, false, nondom)
+                : find_nondominated_set_agree_bf(points, size, dim, false,
+                                                 AGREE_MINIMISE, NULL, nondom);
+        }
+        reps++;
+        elapsed = timer_elapsed(&timer);
+    } while (elapsed < MIN_TIME);
+    // Prevent the compiler from removing the calls.
+    if (dummy == SIZE_MAX)
+        fprintf(stderr, "\n");
+    return elapsed / (double) reps;
+}
+
+/* Smallest size from which Kung's algorithm is not slower than brute force
+   (summed over both kinds of data).  */
+static size_t
+find_crossover(rng_state * rng, dimension_t dim, bool find_dominated)
+{
+    size_t crossover = SIZE_MAX;
+    int wins = 0;
+    for (size_t i = 0; i < NSIZES && wins < CONSECUTIVE_WINS; i++) {
+        const size_t size = sizes[i];
+        boolvec * nondom = nondom_alloc_true(size);
+        double time_bf = 0, time_kung = 0;
+        for (int kind = 0; kind < NKINDS; kind++) {
+            double * points = generate_points(rng, size, dim, kind);
+            time_bf += time_engine(points, size, dim, find_dominated, false, nondom);
+            time_kung += time_engine(points, size, dim, find_dominated, true, nondom);
+            free(points);
+        }
+        free(nondom);
+        fprintf(stderr, "# %s dim=%d size=%zu bf=%g kung=%g\n",
+                find_dominated ? "find_dominated" : "find_set", (int) dim,
+                size, time_bf, time_kung);
+        if (time_kung <= time_bf) {
+            if (wins == 0)
+                crossover = size;
+            wins++;
+        } else {
+            wins = 0;
+            crossover = SIZE_MAX;
+        }
+    }
+    // Kung never won consistently, so use brute force up to twice the largest size.
+    if (crossover == SIZE_MAX)
+        crossover = 2 * sizes[NSIZES - 1];
+    return crossover;
+}
+
+DEFINE_QSORT_CMP(cmp_size_asc, size_t *)
+{
+    return (*a < *b) ? -1 : (*a > *b);
+}
+
+/* Median of the crossovers of the numbers of objectives of one bucket.  */
+static size_t
+median_crossover(size_t * crossover, int n)
+{
+    qsort_typesafe(crossover, (size_t) n, cmp_size_asc);
+    return crossover[n / 2];
+}
+
+static void
+print_table(const char * name, const char * type, const size_t * table, int n)
+{
+    printf("static const %s %s[] = {", type, name);
+    for (int k = 0; k < n; k++)
+        printf(" %zu%s", table[k], (k < n - 1) ? "," : " };\n");
+}
+
+int main(void)
+{
+    /* The crossover of a single number of objectives is noisy, so the
+       numbers of objectives are grouped into buckets, given by the largest
+       number of objectives of each one, that share the median crossover.  */
+    static const size_t bucket_dim_max[] = { 5, 8, 12, 16 };
+    enum { DIM_MIN = 4, DIM_MAX = 16,
+           NBUCKETS = sizeof(bucket_dim_max) / sizeof(bucket_dim_max[0]) };
+    size_t find_set[NBUCKETS], find_dominated[NBUCKETS];
+    size_t crossover_set[DIM_MAX], crossover_dominated[DIM_MAX];
+    rng_state * rng = rng_new(42);
+    int d = DIM_MIN;
+    for (int k = 0; k < NBUCKETS; k++) {
+        int n = 0;
+        for (; d <= (int) bucket_dim_max[k]; d++, n++) {
+            dimension_t dim = (dimension_t) d;
+            crossover_set[n] = find_crossover(rng, dim, false);
+            crossover_dominated[n] = find_crossover(rng, dim, true);
+            fprintf(stderr, "# dim=%d find_set=%zu find_dominated=%zu\n",
+                    d, crossover_set[n], crossover_dominated[n]);
+        }
+        find_set[k] = median_crossover(crossover_set, n);
+        find_dominated[k] = median_crossover(crossover_dominated, n);
+    }
+    rng_free(rng);
+
+    printf("#ifndef NONDOMINATED_DISPATCH_H\n"
+           "#define NONDOMINATED_DISPATCH_H\n"
+           "/* Generated by calibrate_nondominated (see 'make calibrate').  */\n\n"
+           "/* With more than 3 objectives, nondominated.h uses brute force instead\n"
+           "   of Kung's algorithm for fewer points than nondom_dispatch_find_set[k],\n"
+           "   or nondom_dispatch_find_dominated[k] in find_dominated_point(), where k\n"
+           "   is the first bucket such that the number of objectives is at most\n"
+           "   nondom_dispatch_dim_max[k], or the last bucket if there is none.  */\n"
+           "#define NONDOM_DISPATCH_NBUCKETS %d\n", NBUCKETS);
+    print_table("nondom_dispatch_dim_max", "int", bucket_dim_max, NBUCKETS);
+    print_table("nondom_dispatch_find_set", "size_t", find_set, NBUCKETS);
+    print_table("nondom_dispatch_find_dominated", "size_t", find_dominated, NBUCKETS);
+    printf("\n#endif // NONDOMINATED_DISPATCH_H\n");
+    return EXIT_SUCCESS;
+}
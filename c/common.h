@@ -129,4 +129,33 @@ printf_point(const char * prefix, const double * p, dimension_t dim,
     fprintf(stderr, "%s", suffix);
 }
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* Set the number of threads used by the functions that support OpenMP.  It has
+   no effect when compiled without OpenMP.  */
+_attr_maybe_unused static void
+moocore_set_num_threads(int nthreads)
+{
+#ifdef _OPENMP
+    if (nthreads > 0)
+        omp_set_num_threads(nthreads);
+#else
+    (void) nthreads;
+#endif
+}
+
+/* Number of threads that the functions that support OpenMP will use.  It is 1
+   when compiled without OpenMP.  */
+_attr_maybe_unused static int
+moocore_get_num_threads(void)
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
 #endif 	    /* !MOOCORE_COMMON_H_ */
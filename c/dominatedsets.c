@@ -68,6 +68,8 @@ OPTION_VERSION_STR
 " -v, --verbose       print some information (time, number of points, etc.) \n"
 OPTION_QUIET_STR
 " -p, --percentages   print results also as percentages.                    \n"
+" -m, --matrix        print also the dominance relation between each pair of\n"
+"                     sets.                                                 \n"
 "     --no-check      do not check nondominance of sets (faster but unsafe).\n"
 OPTION_OBJ_STR
 "\n");
@@ -76,6 +78,7 @@ OPTION_OBJ_STR
 
 static bool verbose_flag = false;
 static bool percentages_flag = false;
+static bool matrix_flag = false;
 static bool check_flag = true;
 
 // strnlen() is not available in C99.
@@ -179,147 +182,50 @@ print_results (char **filenames, int numfiles, int *nruns, int **results)
     printf ("\n");
 }
 
-static inline int
-dominance(int dim, const double * restrict a, const double * restrict b, const int * restrict minmax)
-/***********************************************
- return: O  -> if a == b
-         1  -> if a dominates b
-         -1 -> if a NOT dominates b
-
-***********************************************/
-{
-    int d;
-
-    /* If any objective is worse, A can't dominate B. */
-    for (d = 0; d < dim; d++)
-        if ((minmax[d] < 0 && a[d] > b[d])
-            || (minmax[d] > 0 && a[d] < b[d]))
-            return -1;
-
-    /* If any objective is better, then A dominates B. */
-    for (d = 0; d < dim; d++)
-        if ((minmax[d] < 0 && a[d] < b[d])
-            || (minmax[d] > 0 && a[d] > b[d]))
-            return 1;
-
-    return 0;
-}
-
-static int set_dominates (int dim, const int * restrict minmax,
-                          const double *points_x, int size_x,
-                          const double *points_y, int size_y)
-{
-    bool x_dominates_y = false,
-        x_weakly_dominates_y = false;
-
-    for (int y = 0; y < size_y; y++) {
-        x_weakly_dominates_y = false;
-        for (int x = 0; x < size_x; x++) {
-            DEBUG2 (
-                printf ("X:");
-                vector_printf (points_x + x * dim, dim);
-                printf ("Y:");
-                vector_printf (points_y + y * dim, dim);
-                );
-            int result = dominance (dim, &points_x[x * dim],
-                                    &points_y[y * dim], minmax);
-            if (result == 1) {
-                DEBUG2(printf ("X dominates Y!\n"));
-                x_weakly_dominates_y = true;
-                x_dominates_y = true;
-                break;
-
-            } else if (result == 0) {
-                DEBUG2(printf ("X weakly dominates Y!\n"));
-                x_weakly_dominates_y = true;
-                break;
-            }
-        }
-        if (!x_weakly_dominates_y)
-            break;
-    }
-
-    if (!x_weakly_dominates_y)
-        return 1;
-    else if (size_x != size_y || x_dominates_y)
-        return -1;
-    else
-        return 0;
-}
-
-int
-pareto_better (int dim, const int * restrict minmax,
-               const double *points_a, int size_a,
-               const double *points_b, int size_b)
+/* Count the number of times that a set of file k is better than a set of file
+   j, for each pair of files, from the dominance relation between each pair of
+   sets.  */
+static void
+count_better(int numfiles, const int * restrict nruns, const int * restrict relation,
+             size_t nsets, int ** results)
 {
-    int result = set_dominates (dim, minmax, points_a, size_a, points_b, size_b);
-    if (result == 1) {
-        DEBUG2 (printf ("Trying with B\n"));
-        result = set_dominates (dim, minmax, points_b, size_b, points_a, size_a);
-        result = -result;
-        if (result != 1) {
-            DEBUG2(printf("A || B\n"));
-            result = 0;
-        }
-    }
-
-    int result2 = epsilon_additive_ind(minmax, (dimension_t) dim, points_a, size_a, points_b, size_b);
-
-    DEBUG2 (
-        printf ("result = %d, result2 = %d\n", result, result2);
-        for (int a = 0; a < size_a; a++) {
-            vector_printf (points_a + a * dim, dim);
+    for (int k = 0, start_k = 0; k < numfiles; start_k += nruns[k], k++) {
+        for (int j = 0, start_j = 0; j < numfiles; start_j += nruns[j], j++) {
+            if (k == j) continue;
+            int count = 0;
+            for (int a = start_k; a < start_k + nruns[k]; a++)
+                for (int b = start_j; b < start_j + nruns[j]; b++)
+                    count += (relation[(size_t) a * nsets + (size_t) b] < 0);
+            results[k][j] = count;
         }
-        printf("\n\n");
-        for (int b = 0; b < size_b; b++) {
-            vector_printf (points_b + b * dim, dim);
-        });
-    if (result != result2) {
-        printf ("result = %d  !=  result2 = %d\n", result, result2);
-        abort();
     }
-    return result;
 }
 
-void
-cmpparetos (int dim, const int * restrict minmax,
-            const double * points_a, int nruns_a,
-            const int *cumsizes_a, int *numbetter_a,
-            const double * points_b, int nruns_b,
-            const int *cumsizes_b, int *numbetter_b)
+static void
+print_matrix(const int * restrict relation, size_t nsets)
 {
-    *numbetter_a = 0;
-    *numbetter_b = 0;
-
-    for (int a = 0, size_a = 0; a < nruns_a; a++) {
-        for (int b = 0, size_b = 0; b < nruns_b; b++) {
-            int result =
-                pareto_better (dim, minmax,
-                               points_a + (dim * size_a),
-                               cumsizes_a[a] - size_a,
-                               points_b + (dim * size_b),
-                               cumsizes_b[b] - size_b);
-            if (result < 0)
-                (*numbetter_a)++;
-            else if (result > 0)
-                (*numbetter_b)++;
-
-            size_b = cumsizes_b[b];
-        }
-        size_a = cumsizes_a[a];
+    printf("\n"
+           "Dominance relation between each pair of sets"
+           " (-1: <row> is better, 1: <column> is better, 0: otherwise):\n\n");
+    for (size_t i = 0; i < nsets; i++) {
+        printf("%2d", relation[i * nsets]);
+        for (size_t j = 1; j < nsets; j++)
+            printf(" %2d", relation[i * nsets + j]);
+        printf("\n");
     }
 }
 
 int main(int argc, char *argv[])
 {
     // See the man page for getopt_long for an explanation of these fields.
-    static const char short_options[] = "hVvqpo:";
+    static const char short_options[] = "hVvqpmo:";
     static const struct option long_options[] = {
         {"help",       no_argument,       NULL, 'h'},
         {"version",    no_argument,       NULL, 'V'},
         {"verbose",    no_argument,       NULL, 'v'},
         {"quiet",      no_argument,       NULL, 'q'},
         {"percentages",no_argument,       NULL, 'p'},
+        {"matrix",     no_argument,       NULL, 'm'},
         {"no-check",   no_argument,       NULL, 'c'},
         {"obj",        required_argument, NULL, 'o'},
         {NULL, 0, NULL, 0} /* marks end of list */
@@ -347,6 +253,10 @@ int main(int argc, char *argv[])
             percentages_flag = true;
             break;
 
+        case 'm': // --matrix
+            matrix_flag = true;
+            break;
+
         case 'c': // --no-check
             check_flag = false;
             break;
@@ -450,16 +360,38 @@ int main(int argc, char *argv[])
             results[k][j] = -1;
     }
 
-    for (k = 0; k < numfiles; k++)
-        for (j = k + 1; j < numfiles; j++)
-            cmpparetos (dim, minmax,
-                        points[k], nruns[k], cumsizes[k], &(results[k][j]),
-                        points[j], nruns[j], cumsizes[j], &(results[j][k]));
+    // Compare all sets of all files at once.
+    size_t nsets = 0, npoints = 0;
+    for (k = 0; k < numfiles; k++) {
+        nsets += (size_t) nruns[k];
+        npoints += (size_t) cumsizes[k][nruns[k] - 1];
+    }
+    double * all_points = MOOCORE_MALLOC(npoints * (size_t) dim, double);
+    size_t * all_cumsizes = MOOCORE_MALLOC(nsets, size_t);
+    // The file of each set.  Sets of the same file are only compared for --matrix.
+    int * file = matrix_flag ? NULL : MOOCORE_MALLOC(nsets, int);
+    for (k = 0, npoints = 0, nsets = 0; k < numfiles; k++) {
+        size_t size = (size_t) cumsizes[k][nruns[k] - 1];
+        memcpy(all_points + npoints * (size_t) dim, points[k],
+               size * (size_t) dim * sizeof(*all_points));
+        for (n = 0; n < nruns[k]; n++) {
+            if (file) file[nsets] = k;
+            all_cumsizes[nsets++] = npoints + (size_t) cumsizes[k][n];
+        }
+        npoints += size;
+    }
+    int * relation = MOOCORE_MALLOC(nsets * nsets, int);
+    set_dominance_matrix_group_minmax(relation, file, minmax, (dimension_t) dim,
+                                      all_points, all_cumsizes, nsets);
+    free(file);
+    free(all_cumsizes);
+    free(all_points);
+    count_better(numfiles, nruns, relation, nsets, results);
 
     print_results (filenames, numfiles, nruns, results);
-
-    if (verbose_flag) {
-    }
+    if (matrix_flag)
+        print_matrix(relation, nsets);
+    free(relation);
 
     return EXIT_SUCCESS;
 }
@@ -35,6 +35,12 @@
 #define DEBUG_POLYGONS 0
 #endif
 
+/* eaf2d() computes the attainment surfaces with a single sweep over all
+   levels when at least this number of levels is requested.  */
+#ifndef EAF2D_SWEEP_MIN_LEVELS
+#define EAF2D_SWEEP_MIN_LEVELS 4
+#endif
+
 // FIXME: Move to sort.h
 DEFINE_QSORT_CMP(compare_x_asc, objective_t **)
 {
@@ -65,10 +71,9 @@ point_printf(FILE * stream, const objective_t * restrict p, dimension_t nobj)
         fprintf(stream, point_printf_sep point_printf_format, p[k]);
 }
 
-eaf_t * eaf_create(int nobj, int nruns, int npoints)
+eaf_t * eaf_create(int nobj, int nruns, size_t npoints, bool store_attained)
 {
-    ASSUME(nruns >= 0);
-    ASSUME(npoints >= 0);
+    ASSUME(nruns > 0);
 
     eaf_t * eaf = MOOCORE_MALLOC(1, eaf_t);
     eaf->nruns = nruns;
@@ -76,11 +81,12 @@ eaf_t * eaf_create(int nobj, int nruns, int npoints)
     eaf->nreallocs = 0;
     /* Maximum is npoints, but normally it will be smaller, so at most
        log2(2 * nruns) realloc will occur.  */
-    eaf->maxsize = 256 + npoints / (2 * nruns);
+    eaf->maxsize = 256 + npoints / (2 * (size_t) nruns);
     /* fprintf(stderr,"maxsize %ld = %d npoints, %d nruns\n", */
     /*         eaf->maxsize, npoints, nruns); */
     eaf->data = MOOCORE_MALLOC(nobj * eaf->maxsize, objective_t);
-    eaf->bit_attained = malloc(bit_array_bytesize(nruns) * eaf->maxsize);
+    eaf->bit_attained = store_attained
+        ? malloc(bit_array_bytesize(nruns) * eaf->maxsize) : NULL;
     return eaf;
 }
 
@@ -105,31 +111,39 @@ eaf_realloc(eaf_t * eaf, dimension_t nobj)
     eaf->data = realloc(eaf->data,
                         sizeof(objective_t) * nobj * eaf->maxsize);
     assert(eaf->data);
-    eaf->bit_attained = realloc(eaf->bit_attained,
-                                bit_array_bytesize(nruns) * eaf->maxsize);
-    assert(eaf->bit_attained);
+    if (eaf->bit_attained) {
+        eaf->bit_attained = realloc(eaf->bit_attained,
+                                    bit_array_bytesize(nruns) * eaf->maxsize);
+        assert(eaf->bit_attained);
+    }
 }
 
-objective_t *
-eaf_store_point_help(eaf_t * restrict eaf, dimension_t nobj,
-                     const int * restrict save_attained)
+static void
+eaf_reserve_point(eaf_t * restrict eaf, dimension_t nobj)
 {
-    const int nruns = eaf->nruns;
-
     if (eaf->size == eaf->maxsize) {
-        assert (eaf->size < INT_MAX / 2);
+        assert (eaf->size < SIZE_MAX / 2);
         //size_t old_maxsize = eaf->maxsize;
         eaf->maxsize = (size_t) ((double) eaf->maxsize * (1.0 + 1.0 / pow(2, eaf->nreallocs / 4.0)));
         eaf->maxsize += 100; // At least we increase it by 100 points
         /* fprintf(stderr,"maxsize (%d): %ld -> %ld\n", eaf->nreallocs, */
         /*         old_maxsize, eaf->maxsize); */
         eaf->nreallocs++;
-        // FIXME: We could save memory by only storing eaf->attained per point if requested.
         eaf_realloc(eaf, nobj);
     }
-    // FIXME: provide a bit_array function to do this.
-    for (int k = 0; k < nruns; k++) {
-        bit_array_set(bit_array_offset(eaf->bit_attained, eaf->size, nruns), k, (bool) save_attained[k]);
+}
+
+objective_t *
+eaf_store_point_help(eaf_t * restrict eaf, dimension_t nobj,
+                     const int * restrict save_attained)
+{
+    const int nruns = eaf->nruns;
+    eaf_reserve_point(eaf, nobj);
+    if (eaf->bit_attained) {
+        // FIXME: provide a bit_array function to do this.
+        for (int k = 0; k < nruns; k++) {
+            bit_array_set(bit_array_offset(eaf->bit_attained, eaf->size, nruns), k, (bool) save_attained[k]);
+        }
     }
     return eaf->data + nobj * eaf->size;
 }
@@ -155,6 +169,21 @@ eaf_store_point_2d(eaf_t * restrict eaf, objective_t x, objective_t y,
     eaf->size++;
 }
 
+static void
+eaf_store_point_2d_bits(eaf_t * restrict eaf, objective_t x, objective_t y,
+                        const bit_array * restrict attained)
+{
+    const dimension_t nobj = 2;
+    eaf_reserve_point(eaf, nobj);
+    if (eaf->bit_attained)
+        bit_array_copy(bit_array_offset(eaf->bit_attained, eaf->size, eaf->nruns),
+                       attained, eaf->nruns);
+    objective_t * pos = eaf->data + nobj * eaf->size;
+    pos[0] = x;
+    pos[1] = y;
+    eaf->size++;
+}
+
 static void
 eaf_print_line(FILE * coord_file, FILE * indic_file, FILE * diff_file,
                 const objective_t * restrict x, dimension_t nobj,
@@ -192,29 +221,31 @@ void
 eaf_print_attsurf(const eaf_t * restrict eaf, dimension_t nobj,
                   FILE * coord_file,  FILE * indic_file, FILE * diff_file)
 {
+    assert(eaf->bit_attained || (!indic_file && !diff_file));
     for (size_t i = 0; i < eaf->size; i++) {
         const objective_t * p = eaf->data + i * nobj;
         /* bit_array_fprintf(stderr, eaf->bit_attained, eaf->nruns * eaf->size); */
         eaf_print_line(coord_file, indic_file, diff_file,
                        p, nobj,
-                       bit_array_offset(eaf->bit_attained, i, eaf->nruns),
+                       eaf->bit_attained
+                       ? bit_array_offset(eaf->bit_attained, i, eaf->nruns) : NULL,
                        eaf->nruns);
     }
 }
 
 _attr_maybe_unused static void
-fprint_set2d (FILE * stream, const objective_t * const * data, int ntotal)
+fprint_set2d (FILE * stream, const objective_t * const * data, size_t ntotal)
 {
-    for (int k = 0; k < ntotal; k++)
-        fprintf (stream, "%6d: " point_printf_format " " point_printf_format "\n", k,
+    for (size_t k = 0; k < ntotal; k++)
+        fprintf (stream, "%6zu: " point_printf_format " " point_printf_format "\n", k,
                  data[k][0], data[k][1]);
 }
 
 void
-eaf2matrix_R(double * restrict rmat, eaf_t * const * eaf, int nobj, int totalpoints,
+eaf2matrix_R(double * restrict rmat, eaf_t * const * eaf, int nobj, size_t totalpoints,
              const double * restrict percentile, int nlevels)
 {
-    int pos = 0;
+    size_t pos = 0;
     for (int k = 0; k < nlevels; k++) {
         size_t npoints = eaf[k]->size;
         double p = percentile ? percentile[k] : level2percentile(k+1, nlevels);
@@ -230,11 +261,11 @@ eaf2matrix_R(double * restrict rmat, eaf_t * const * eaf, int nobj, int totalpoi
 
 void
 eaf2matrix(double * restrict rmat, eaf_t * const * eaf, int nobj,
-           _attr_maybe_unused int totalpoints,
+           _attr_maybe_unused size_t totalpoints,
            const double * restrict percentile, int nlevels)
 {
     const dimension_t ncol = (dimension_t)nobj + 1;
-    int pos = 0;
+    size_t pos = 0;
     for (int k = 0; k < nlevels; k++) {
         size_t npoints = eaf[k]->size;
         double p = percentile ? percentile[k] : level2percentile(k+1, nlevels);
@@ -249,15 +280,17 @@ eaf2matrix(double * restrict rmat, eaf_t * const * eaf, int nobj,
 }
 
 double *
-eaf_compute_matrix(int * restrict eaf_npoints, double * restrict data, int nobj,
-                   const int * restrict cumsizes, int nruns,
+eaf_compute_matrix(size_t * restrict eaf_npoints, double * restrict data, int nobj,
+                   const size_t * restrict cumsizes, int nruns,
                    const double * restrict percentile, int nlevels)
 {
     int * level = levels_from_percentiles(percentile, nlevels, nruns);
-    eaf_t ** eaf = attsurf(data, nobj, cumsizes, nruns, level, nlevels);
+    // The matrix only contains the coordinates and the percentile.
+    eaf_t ** eaf = attsurf(data, nobj, cumsizes, nruns, level, nlevels,
+                           /* store_attained = */false);
     free (level);
 
-    int totalpoints = eaf_totalpoints(eaf, nlevels);
+    size_t totalpoints = eaf_totalpoints(eaf, nlevels);
     double * mat = malloc(sizeof(*mat) * totalpoints * (nobj + 1));
     eaf2matrix(mat, eaf, nobj, totalpoints, percentile, nlevels);
     eaf_free(eaf, nlevels);
@@ -265,6 +298,130 @@ eaf_compute_matrix(int * restrict eaf_npoints, double * restrict data, int nobj,
     return mat;
 }
 
+/* Setup a lookup table to go from a point to the approximation set (run)
+   to which it belongs.  */
+static int *
+eaf_runtab_new(const size_t * restrict cumsize, int nruns)
+{
+    const size_t ntotal = cumsize[nruns - 1];
+    int * runtab = malloc(ntotal * sizeof(*runtab));
+    int j = 0;
+    for (size_t k = 0; k < ntotal; j++) {
+        for (; k < cumsize[j]; k++)
+            runtab[k] = j;
+    }
+    return runtab;
+}
+
+/*
+   eaf2d_sweep: compute all attainment surfaces with a single sweep along
+                the first objective.
+
+   For each run r, minimum[r] is the minimum second objective of the points
+   of r seen so far.  The runs are kept sorted by minimum, so that the
+   attainment surface at level l is at the l-th smallest minimum.  When a
+   point decreases the minimum of its run, only the levels between the old
+   and the new position of the run may change.  A new point is stored for
+   each of those levels whose value decreases.  The runs that attain a level
+   also attain all higher levels, so the attainment bits are built
+   incrementally while visiting the levels in increasing order.
+
+   The result is identical to eaf2d_per_level().
+*/
+static eaf_t **
+eaf2d_sweep(const objective_t * restrict data, const size_t * restrict cumsize, int nruns,
+            const int * restrict attlevel, const int nlevels, bool store_attained)
+{
+    const dimension_t nobj = 2;
+    const size_t ntotal = cumsize[nruns - 1]; /* total number of points in data */
+    const objective_t ** datax = malloc(ntotal * sizeof(*datax));
+    for (size_t k = 0; k < ntotal; k++)
+        datax[k] = data + nobj * k;
+    qsort_typesafe(datax, ntotal, compare_x_asc);
+    int * runtab = eaf_runtab_new(cumsize, nruns);
+
+    /* Requested levels sorted by level, so that the ones within a range of
+       levels are consecutive.  */
+    int * order = malloc(nlevels * sizeof(*order));
+    for (int l = 0; l < nlevels; l++) {
+        int k = l;
+        for (; k > 0 && attlevel[order[k - 1]] > attlevel[l]; k--)
+            order[k] = order[k - 1];
+        order[k] = l;
+    }
+
+    objective_t * minimum = malloc(2 * nruns * sizeof(*minimum));
+    objective_t * last = minimum + nruns; // Last value stored at each level.
+    int * sorted_runs = malloc(2 * nruns * sizeof(*sorted_runs));
+    int * run_pos = sorted_runs + nruns;
+    for (int r = 0; r < nruns; r++) {
+        minimum[r] = last[r] = objective_MAX;
+        sorted_runs[r] = run_pos[r] = r;
+    }
+    bit_array * attained = bit_array_calloc(nruns);
+
+    eaf_t ** eaf = malloc(nlevels * sizeof(*eaf));
+    for (int l = 0; l < nlevels; l++)
+        eaf[l] = eaf_create(nobj, nruns, ntotal, store_attained);
+
+    size_t x = 0;
+    while (x < ntotal) {
+        const objective_t curr_x = datax[x][0];
+        int lo = nruns, hi = -1; // Positions that changed.
+        do {
+            const int run = runtab[(datax[x] - data) / nobj];
+            const objective_t y = datax[x][1];
+            if (y < minimum[run]) {
+                minimum[run] = y;
+                int pos = run_pos[run];
+                if (pos > hi) hi = pos;
+                while (pos > 0 && minimum[sorted_runs[pos - 1]] > y) {
+                    sorted_runs[pos] = sorted_runs[pos - 1];
+                    run_pos[sorted_runs[pos]] = pos;
+                    pos--;
+                }
+                sorted_runs[pos] = run;
+                run_pos[run] = pos;
+                if (pos < lo) lo = pos;
+            }
+            x++;
+        } while (x < ntotal && datax[x][0] == curr_x);
+
+        if (hi < 0) continue;
+        // First requested level >= lo + 1.
+        int i = 0;
+        while (i < nlevels && attlevel[order[i]] <= lo) i++;
+        int k = 0; // Runs set in attained.
+        for (; i < nlevels && attlevel[order[i]] <= hi + 1; ) {
+            const int level = attlevel[order[i]];
+            const objective_t y = minimum[sorted_runs[level - 1]];
+            if (y < last[level - 1]) {
+                last[level - 1] = y;
+                if (store_attained)
+                    for (; k < nruns && minimum[sorted_runs[k]] <= y; k++)
+                        bit_array_set_one(attained, sorted_runs[k]);
+                // The same level may be requested more than once.
+                for (; i < nlevels && attlevel[order[i]] == level; i++)
+                    eaf_store_point_2d_bits(eaf[order[i]], curr_x, y, attained);
+            } else {
+                for (; i < nlevels && attlevel[order[i]] == level; i++);
+            }
+        }
+        if (k > 0)
+            bit_array_zero_all(attained, nruns);
+    }
+
+    for (int l = 0; l < nlevels; l++)
+        eaf_adjust_memory(eaf[l], nobj);
+    free(attained);
+    free(sorted_runs);
+    free(minimum);
+    free(order);
+    free(runtab);
+    free(datax);
+    return eaf;
+}
+
 /*
    eaf2d: compute attainment surfaces from points in objective space,
           using dimension sweeping.
@@ -277,25 +434,26 @@ eaf_compute_matrix(int * restrict eaf_npoints, double * restrict data, int nobj,
         nruns :	the number of independent non-dominated fronts.
         attlevel : an array containing the attainment levels to compute.
         nlevel : number of attainment levels to compute.
+        store_attained : whether to store which runs attain each point.
         coord_file  : stream to write the resulting attainment surfaces.
         indic_file  : stream to write the resulting attainment indices.
         diff_file   : stream to write the difference between the
                       first half and the second half of nruns.
 */
 
-eaf_t **
-eaf2d(const objective_t * restrict data, const int * restrict cumsize, int nruns,
-      const int * restrict attlevel, const int nlevels)
+static eaf_t **
+eaf2d_per_level(const objective_t * restrict data, const size_t * restrict cumsize, int nruns,
+                const int * restrict attlevel, const int nlevels, bool store_attained)
 {
     const dimension_t nobj = 2;
-    const int ntotal = cumsize[nruns - 1]; /* total number of points in data */
+    const size_t ntotal = cumsize[nruns - 1]; /* total number of points in data */
     /* Access to the data is made via two arrays of pointers: ix, iy
        These are sorted, to allow for dimension sweeping */
 
     const objective_t ** datax = malloc(2 * ntotal * sizeof(*datax));
     const objective_t ** datay = datax + ntotal;
 
-    for (int k = 0; k < ntotal; k++)
+    for (size_t k = 0; k < ntotal; k++)
         datax[k] = datay[k] = data + nobj * k;
 
     DEBUG1(/* Sanity check. */
@@ -317,33 +475,31 @@ eaf2d(const objective_t * restrict data, const int * restrict cumsize, int nruns
         fprint_set2d (stderr, datay, ntotal);
         );
 
-    /* Setup a lookup table to go from a point to the approximation set (run)
-       to which it belongs.  */
-
-    int * runtab = malloc(ntotal * sizeof(*runtab));
-    for (int k = 0, j = 0; k < ntotal; j++) {
-        for (; k < cumsize[j]; k++)
-            runtab[k] = j;
-    }
+    int * runtab = eaf_runtab_new(cumsize, nruns);
 
     DEBUG2(
         fprintf(stderr, "Runtab:\n");
-        for (int k = 0; k < ntotal; k++)
-            fprintf(stderr, "%6d: %6d\n", k, runtab[k]);
+        for (size_t k = 0; k < ntotal; k++)
+            fprintf(stderr, "%6zu: %6d\n", k, runtab[k]);
         );
 
-    /* Setup tables to keep attainment statistics. In particular,
-       save_attained is needed to cope with repeated values on the same
-       axis. */
-    int * attained = malloc(2 * nruns * sizeof(*attained));
-    int * save_attained = attained + nruns;
     eaf_t ** eaf = malloc(nlevels * sizeof(*eaf));
 
+    /* Levels are independent of each other and only read datax, datay and
+       runtab, thus they can be computed in parallel.  */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
     for (int l = 0; l < nlevels; l++) {
-        eaf[l] = eaf_create(nobj, nruns, ntotal);
+        /* Setup tables to keep attainment statistics. In particular,
+           save_attained is needed to cope with repeated values on the same
+           axis. */
+        int * attained = malloc(2 * nruns * sizeof(*attained));
+        int * save_attained = attained + nruns;
+        eaf[l] = eaf_create(nobj, nruns, ntotal, store_attained);
         int level = attlevel[l];
-        int x = 0;
-        int y = 0;
+        size_t x = 0;
+        size_t y = 0;
         int nattained = 0;
         for (int k = 0; k < nruns; k++) attained[k] = 0;
 
@@ -377,7 +533,8 @@ eaf2d(const objective_t * restrict data, const int * restrict cumsize, int nruns
             do {
                 /* If there are repeated values along the y axis,
                    we need to remember where we are.  */
-                memcpy (save_attained, attained, nruns * sizeof(*attained));
+                if (store_attained)
+                    memcpy (save_attained, attained, nruns * sizeof(*attained));
 
                 do {
                     if (datay[y][0] <= datax[x][0]) {
@@ -400,14 +557,23 @@ eaf2d(const objective_t * restrict data, const int * restrict cumsize, int nruns
 
         } while (x < ntotal - 1 && y < ntotal);
         eaf_adjust_memory(eaf[l], nobj);
+        free(attained);
     }
-    free(attained);
     free(runtab);
     free(datax);
 
     return eaf;
 }
 
+eaf_t **
+eaf2d(const objective_t * restrict data, const size_t * restrict cumsize, int nruns,
+      const int * restrict attlevel, const int nlevels, bool store_attained)
+{
+    if (nlevels >= EAF2D_SWEEP_MIN_LEVELS)
+        return eaf2d_sweep(data, cumsize, nruns, attlevel, nlevels, store_attained);
+    return eaf2d_per_level(data, cumsize, nruns, attlevel, nlevels, store_attained);
+}
+
 
 #if DEBUG_POLYGONS > 0
 #define PRINT_POINT(X,Y,C) do { \
@@ -432,6 +598,7 @@ eaf_max_size(eaf_t * const * eaf, int nlevels)
 static int
 eaf_diff_color(const eaf_t * eaf, size_t k, int nruns)
 {
+    assert(eaf->bit_attained);
     const bit_array * bit_attained = bit_array_offset(eaf->bit_attained, k, nruns);
     int count_left, count_right;
     attained_left_right(bit_attained, nruns/2, nruns, &count_left, &count_right);
@@ -607,18 +774,18 @@ eaf_compute_polygon(eaf_t ** eaf, int nobj, int nlevels)
 
     for (int b = 1; b < nlevels; b++) {
         const int a = b - 1;
-        const int eaf_a_size = (int) eaf[a]->size;
-        const int eaf_b_size = (int) eaf[b]->size;
+        const size_t eaf_a_size = eaf[a]->size;
+        const size_t eaf_b_size = eaf[b]->size;
         init_colors(color, eaf[a], eaf_a_size, nruns);
 
         /* Find color transitions along the EAF level set.  */
         objective_t topleft_y = objective_MAX;
-        int last_b = -1;
-        int ka = 0;
+        size_t end_b = 0; // One past the last point of b already used.
+        size_t ka = 0;
         while (true) {
             const objective_t * pka = NULL;
             const objective_t * pkb = NULL;
-            int kb = last_b + 1;
+            size_t kb = end_b;
             // Find a point in a that does not overlap with a point in b
             while (ka < eaf_a_size && kb < eaf_b_size) {
                 pka = eaf_point (a, ka);
@@ -627,7 +794,7 @@ eaf_compute_polygon(eaf_t ** eaf, int nobj, int nlevels)
                     break;
                 // They overlap in x, so we will skip kb, remember it.
                 topleft_y = pkb[1];
-                last_b = kb;
+                end_b = kb + 1;
                 if (pkb[1] == pka[1]) {
                     /* Ignore points that exactly overlap.  */
                     // FIXME: This should not happen, but it does. We should remove these points.
@@ -684,7 +851,7 @@ eaf_compute_polygon(eaf_t ** eaf, int nobj, int nlevels)
                 /* We don't have to go down the other side since eaf_a
                    completely dominates eaf_b, so just start by the
                    end. */
-                if (last_b == eaf_b_size - 1) {
+                if (end_b == eaf_b_size) {
                     /* The last point we skipped was the last point, so there
                        is nothing on the other side, just create two points in
                        the infinity. */
@@ -711,19 +878,18 @@ eaf_compute_polygon(eaf_t ** eaf, int nobj, int nlevels)
                     /* Now print in reverse.  */
                     objective_t prev_pkb_x = pkb[0];
                     push_point (pkb[0], pkb[1]);
-                    kb--;
-                    while (kb > last_b) {
+                    while (kb > end_b) {
+                        kb--;
                         pkb = eaf_point(b, kb);
                         assert (pkb[1] > pka[1]); // pkb cannot be below pka
                         push_point (prev_pkb_x, pkb[1]);
                         push_point (pkb[0], pkb[1]);
                         prev_pkb_x = pkb[0];
-                        kb--;
                     }
                     push_point (pkb[0], topleft_y);
                     assert (topleft_y > pkb[1]);
                 }
-                /* last_b = eaf_b_size - 1; */
+                /* end_b = eaf_b_size; */
                 polygon_close(color_0); /* DONE */
                 break; /* Really done! */
             } else {
@@ -733,9 +899,9 @@ eaf_compute_polygon(eaf_t ** eaf, int nobj, int nlevels)
                        two points in the infinity. */
                     push_point (objective_MAX, pka[1]);
                     push_point (objective_MAX, topleft_y);
-                    last_b = eaf_b_size - 1;
+                    end_b = eaf_b_size;
                 } else {
-                    // This polygon is bounded above by eaf_b from last_b up to kb.
+                    // This polygon is bounded above by eaf_b from end_b up to kb.
                     assert (kb < eaf_b_size);
                     pkb = eaf_point (b, kb);
                     // If we have not finished eaf_b is because pkb is not above pka
@@ -744,12 +910,12 @@ eaf_compute_polygon(eaf_t ** eaf, int nobj, int nlevels)
                     /* If pkb and pka are in the same horizontal, pkb
                        does not affect the next polygon. Otherwise, it
                        does. */
-                    int save_last_b = (pkb[1] == pka[1]) ? kb : kb - 1;
+                    size_t save_end_b = (pkb[1] == pka[1]) ? kb + 1 : kb;
                     /* Now print eaf_b in reverse.  */
                     objective_t prev_pkb_x = pkb[0];
                     push_point (pkb[0], pka[1]);
-                    kb--;
-                    while (kb > last_b) {
+                    while (kb > end_b) {
+                        kb--;
                         pkb = eaf_point (b, kb);
                         // pkb must be above pka or we would have found the
                         // intersection earlier.
@@ -757,11 +923,10 @@ eaf_compute_polygon(eaf_t ** eaf, int nobj, int nlevels)
                         push_point (prev_pkb_x, pkb[1]);
                         push_point (pkb[0], pkb[1]);
                         prev_pkb_x = pkb[0];
-                        kb--;
                     }
                     push_point (pkb[0], topleft_y);
                     assert (topleft_y > pkb[1]);
-                    last_b = save_last_b;
+                    end_b = save_end_b;
                 }
                 polygon_close(color_0); /* DONE */
                 assert(topleft_y >= pka[1]);
@@ -792,13 +957,13 @@ eaf_compute_polygon_old (eaf_t ** eaf, int nobj, int nlevels)
 
     for (int b = 1; b < nlevels; b++) {
         const int a = b - 1;
-        const int eaf_a_size = (int) eaf[a]->size;
-        const int eaf_b_size = (int) eaf[a + 1]->size;
+        const size_t eaf_a_size = eaf[a]->size;
+        const size_t eaf_b_size = eaf[a + 1]->size;
         init_colors(color, eaf[a], eaf_a_size, nruns);
         /* Find color transitions along the EAF level set.  */
-        int last_b = -1;
+        size_t end_b = 0; // One past the last point of b already used.
         objective_t topleft_y = objective_MAX;
-        int ka = 0;
+        size_t ka = 0;
         while (ka < eaf_a_size) {
             objective_t prev_pka_y = topleft_y;
             const objective_t * pka;
@@ -819,14 +984,13 @@ eaf_compute_polygon_old (eaf_t ** eaf, int nobj, int nlevels)
                 /* We don't have to go down the other side since eaf_a
                    completely dominates eaf_b, so just start by the
                    end. */
-                int kb = eaf_b_size - 1;
-
-                if (last_b == kb) {
+                if (end_b == eaf_b_size) {
                     /* There is nothing on the other side, just create
                        two points in the infinity. */
                     push_point (objective_MAX, pka[1]);
                     push_point (objective_MAX, topleft_y);
                 } else {
+                    size_t kb = eaf_b_size - 1;
                     const objective_t * pkb = eaf_point(a + 1, kb);
                     assert (pkb[1] >= pka[1]);
                     if (pkb[1] > pka[1]) {
@@ -836,20 +1000,19 @@ eaf_compute_polygon_old (eaf_t ** eaf, int nobj, int nlevels)
                     }
                     objective_t prev_pkb_x = pkb[0];
                     push_point (pkb[0], pkb[1]);
-                    kb--;
-                    while (kb > last_b) {
+                    while (kb > end_b) {
+                        kb--;
                         pkb = eaf_point(a + 1, kb);
                         push_point (prev_pkb_x, pkb[1]);
                         push_point (pkb[0], pkb[1]);
                         prev_pkb_x = pkb[0];
-                        kb--;
                     }
                     push_point (pkb[0], topleft_y);
-                    last_b = eaf_b_size - 1;
+                    end_b = eaf_b_size;
                 }
                 polygon_close(color_0); /* DONE */
             } else {
-                int kb = last_b + 1;
+                size_t kb = end_b;
                 /* Different color, go down by the other side until
                    reaching this point. */
                 if (kb == eaf_b_size) {
@@ -866,7 +1029,7 @@ eaf_compute_polygon_old (eaf_t ** eaf, int nobj, int nlevels)
                             break;
                         kb++;
                     } while (kb < eaf_b_size);
-                    int save_last_b = kb - 1;
+                    size_t save_end_b = kb;
                     if (kb == eaf_b_size) {
                         /* There is nothing on the other side, just create
                            two points in the infinity. */
@@ -876,18 +1039,17 @@ eaf_compute_polygon_old (eaf_t ** eaf, int nobj, int nlevels)
                         objective_t prev_pkb_x = pkb[0];
                         push_point (pkb[0], pka[1]);
                         /* Now print in reverse.  */
-                        kb--;
-                        while (kb > last_b) {
+                        while (kb > end_b) {
+                            kb--;
                             pkb = eaf_point (b, kb);
                             push_point (prev_pkb_x, pkb[1]);
                             push_point (pkb[0], pkb[1]);
                             prev_pkb_x = pkb[0];
-                            kb--;
                         }
                         push_point (pkb[0], topleft_y);
                     }
                     polygon_close(color_0); /* DONE */
-                    last_b = save_last_b;
+                    end_b = save_end_b;
                 }
             }
             topleft_y = pka[1];
@@ -951,7 +1113,7 @@ eaf_compute_rectangles(eaf_t **eaf, int nobj, int nlevels)
 #define eaf_point(A,K) (eaf[(A)]->data + (K) * nobj)
 #if 0
 #define printf_points(ka,kb,pka,pkb)                                           \
-    printf("%4d: pa[%d]=(" point_printf_format ", " point_printf_format "), pb[%d] = (" point_printf_format ", " point_printf_format ")\n", \
+    printf("%4d: pa[%zu]=(" point_printf_format ", " point_printf_format "), pb[%zu] = (" point_printf_format ", " point_printf_format ")\n", \
            __LINE__, ka, pka[0], pka[1], kb, pkb[0], pkb[1])
 #else
 #define printf_points(ka,kb,pka,pkb)
@@ -968,14 +1130,14 @@ eaf_compute_rectangles(eaf_t **eaf, int nobj, int nlevels)
 
     for (int b = 1; b < nlevels; b++) {
         const int a = b - 1;
-        const int eaf_a_size = (int) eaf[a]->size;
-        const int eaf_b_size = (int) eaf[b]->size;
+        const size_t eaf_a_size = eaf[a]->size;
+        const size_t eaf_b_size = eaf[b]->size;
         if (eaf_a_size == 0 || eaf_b_size == 0) continue;
 
         // FIXME: Skip points with color 0?
         init_colors(color, eaf[a], eaf_a_size, nruns);
         objective_t top = objective_MAX;
-        int ka = 0, kb = 0;
+        size_t ka = 0, kb = 0;
         const objective_t * pkb = eaf_point(b, kb);
         const objective_t * pka = eaf_point(a, ka);
         printf_points(ka, kb, pka, pkb);
@@ -1025,6 +1187,7 @@ eaf_compute_rectangles(eaf_t **eaf, int nobj, int nlevels)
     next_eaf:
         continue;
     }
+    free(color);
     return regions;
 #undef eaf_point
 }
@@ -55,6 +55,8 @@ typedef struct {
     size_t size;
     size_t maxsize;
     unsigned int nreallocs;
+    /* nruns bits per point telling which runs attain it.  NULL if the EAF was
+       computed with store_attained == false.  */
     bit_array *bit_attained;
     objective_t *data;
 } eaf_t;
@@ -66,48 +68,62 @@ eaf_print_attsurf(const eaf_t * restrict, dimension_t nobj,
                   FILE * indic_file, /* output file (attainment indicators) */
                   FILE * diff_file); /* output file (difference nruns/2)    */
 
-eaf_t * eaf_create (int nobj, int nruns, int npoints);
+eaf_t * eaf_create (int nobj, int nruns, size_t npoints, bool store_attained);
 void eaf_delete (eaf_t * eaf);
 void eaf_free (eaf_t ** eaf, int nruns);
 objective_t *
 eaf_store_point_help(eaf_t * eaf, dimension_t nobj, const int * save_attained);
 
-static inline int eaf_totalpoints(eaf_t ** eaf, int n)
+static inline size_t eaf_totalpoints(eaf_t ** eaf, int n)
 {
-    int totalpoints = 0;
+    size_t totalpoints = 0;
     for (int k = 0; k < n; k++)
-        totalpoints += (int) eaf[k]->size;
+        totalpoints += eaf[k]->size;
     return totalpoints;
 }
 
+/* If store_attained is false, the EAF does not record which runs attain each
+   point (eaf_t.bit_attained == NULL), which saves nruns bits per point.  The
+   attainment indicators are only needed by eaf_print_attsurf() with
+   indic_file or diff_file, by the EAF differences and by the polygons.  */
 eaf_t **
 eaf2d (const objective_t *data,    /* the objective vectors            */
-       const int *cumsize,         /* the cumulative sizes of the runs */
+       const size_t *cumsize,      /* the cumulative sizes of the runs */
        int nruns,		   /* the number of runs               */
        const int *attlevel,        /* the desired attainment levels    */
-       int nlevels                 /* the number of att levels         */
+       int nlevels,                /* the number of att levels         */
+       bool store_attained         /* store the attainment indicators  */
     );
 
 eaf_t **
-eaf3d(objective_t * data, const int * cumsize, int nruns,
-      const int * attlevel, const int nlevels);
+eaf3d(objective_t * data, const size_t * cumsize, int nruns,
+      const int * attlevel, const int nlevels, bool store_attained);
+
+/* Four or more objectives: dimension sweep along the last objective that
+   computes the surfaces of nobj - 1 objectives with attsurf().  */
+eaf_t **
+eafnd(objective_t * data, int nobj, const size_t * cumsize, int nruns,
+      const int * attlevel, const int nlevels, bool store_attained);
 
 static inline eaf_t **
 attsurf(objective_t * restrict data,   /* the objective vectors            */
         int nobj,                      /* the number of objectives         */
-        const int * restrict cumsize,  /* the cumulative sizes of the runs */
+        const size_t * restrict cumsize, /* the cumulative sizes of the runs */
         int nruns,		               /* the number of runs               */
         const int * restrict attlevel, /* the desired attainment levels    */
-        int nlevels                    /* the number of att levels         */
+        int nlevels,                   /* the number of att levels         */
+        bool store_attained            /* store the attainment indicators  */
     )
 {
     switch (nobj) {
       case 2:
-          return eaf2d(data, cumsize, nruns, attlevel, nlevels);
+          return eaf2d(data, cumsize, nruns, attlevel, nlevels, store_attained);
       case 3:
-          return eaf3d(data, cumsize, nruns, attlevel, nlevels);
+          return eaf3d(data, cumsize, nruns, attlevel, nlevels, store_attained);
       default:
-          fatal_error("this implementation only supports two or three dimensions.\n");
+          if (nobj < 2)
+              fatal_error("the EAF requires at least two dimensions.\n");
+          return eafnd(data, nobj, cumsize, nruns, attlevel, nlevels, store_attained);
     }
 }
 
@@ -174,19 +190,20 @@ all_percentiles (double * percentiles, int n_sets)
         percentiles[i-1] = i * x;
 }
 
-void eaf2matrix_R(double * rmat, eaf_t * const * eaf, int nobj, int totalpoints,
+void eaf2matrix_R(double * rmat, eaf_t * const * eaf, int nobj, size_t totalpoints,
                   const double * percentile, int nlevels);
 
-void eaf2matrix(double * rmat, eaf_t * const * eaf, int nobj, _attr_maybe_unused int totalpoints,
+void eaf2matrix(double * rmat, eaf_t * const * eaf, int nobj, _attr_maybe_unused size_t totalpoints,
                 const double * percentile, int nlevels);
 
 double *
-eaf_compute_matrix(int * eaf_npoints, double * data, int nobj, const int *cumsizes, int nruns,
+eaf_compute_matrix(size_t * eaf_npoints, double * data, int nobj, const size_t *cumsizes, int nruns,
                    const double * percentile, int nlevels);
 
 static inline double
 eafdiff_percentile(const eaf_t * eaf, size_t i, int division, int nruns, int n_intervals)
 {
+    assert(eaf->bit_attained);
     const bit_array * bit_attained = bit_array_offset(eaf->bit_attained, i, nruns);
     int count_left, count_right;
     attained_left_right(bit_attained, division, nruns, &count_left, &count_right);
@@ -195,11 +212,47 @@ eafdiff_percentile(const eaf_t * eaf, size_t i, int division, int nruns, int n_i
 }
 
 double *
-eafdiff_compute_rectangles(int * eaf_npoints, double * data, int nobj,
-                           const int *cumsizes, int nruns, int intervals);
+eafdiff_compute_rectangles(size_t * eaf_npoints, double * data, int nobj,
+                           const size_t *cumsizes, int nruns, int intervals);
+double *
+eafdiff_compute_matrix(size_t * eaf_npoints, double * data, int nobj,
+                       const size_t *cumsizes, int nruns, int intervals);
+
+/* EAF differences between a left and a right dataset of two objectives, each
+   with its own number of runs.  The difference at a point is intervals times
+   the fraction of left runs minus the fraction of right runs that attain it.
+   Each row is either a point where the difference changes (x, y, diff) or,
+   if rectangles is true, a rectangle (xmin, ymin, xmax, ymax, diff) where it
+   is constant.  No row is repeated.  If stream is not NULL, the rows are
+   written to it as soon as they are computed and NULL is returned.
+   Otherwise, the points are ordered as in eafdiff_compute_matrix().  */
+double *
+eafdiff2d(size_t * nrows,
+          const double * data_left, const size_t * cumsizes_left, int nruns_left,
+          const double * data_right, const size_t * cumsizes_right, int nruns_right,
+          int intervals, bool rectangles, FILE * stream);
+
+/* Pair (*best_a, *best_b), with *best_a < *best_b, of the ndata datasets of
+   two objectives with the largest EAF difference in the box [ideal, ref]
+   according to [DiaLop2020ejor].  The runs of dataset k are cumruns[k - 1]
+   ..cumruns[k] - 1 and cumsizes are the cumulative sizes of all the runs.
+   Returns the value of the pair, or 0 and -1 in both indexes if no pair has
+   a positive value.  */
+double
+largest_eafdiff(int * best_a, int * best_b, const double * data, const size_t * cumsizes,
+                const int * cumruns, int ndata, int intervals, const double * ideal,
+                const double * ref);
+
+/* Vorob'ev expectation (returned, with *ve_npoints rows), threshold (as a
+   percentile in [0, 100]) and average hypervolume of the sets.  */
 double *
-eafdiff_compute_matrix(int * eaf_npoints, double * data, int nobj,
-                       const int *cumsizes, int nruns, int intervals);
+vorob_expectation(double * threshold, double * avg_hyp, size_t * ve_npoints,
+                  double * data, int nobj, const size_t * cumsizes, int nruns,
+                  const double * ref);
+/* Vorob'ev deviation of the sets with respect to the expectation ve.  */
+double
+vorob_deviation(const double * data, int nobj, const size_t * cumsizes, int nruns,
+                const double * ref, const double * ve, size_t ve_npoints);
 
 #define cvector_assert(X) assert(X)
 #include "cvector.h"
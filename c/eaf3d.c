@@ -36,9 +36,83 @@ typedef struct dlnode {
     int set;
 } dlnode_t;
 
-typedef struct removed_list {
-    avl_node_t * head;
-} removed_list_t;
+/* All the nodes are allocated from a pool in large blocks, which are freed
+   all at once at the end.  The nodes removed from a level cannot be freed
+   before, because they are still referenced by find_all_promoters().  The
+   nodes removed from a set are recycled.  Each node has room for a copy of
+   its point, so the points of the levels do not need to be allocated
+   separately.  */
+typedef struct eaf3d_node {
+    avl_node_t avl; /* Must be the first member.  */
+    objective_t x[3];
+} eaf3d_node_t;
+
+typedef struct node_block {
+    struct node_block * next;
+    eaf3d_node_t nodes[];
+} node_block_t;
+
+typedef struct node_pool {
+    node_block_t * blocks;
+    size_t block_size;
+    size_t used; /* Nodes used from the first block.  */
+    avl_node_t * free_list;
+} node_pool_t;
+
+static void
+node_pool_init(node_pool_t * pool, size_t block_size)
+{
+    pool->blocks = NULL;
+    pool->block_size = block_size;
+    pool->used = block_size;
+    pool->free_list = NULL;
+}
+
+static avl_node_t *
+node_pool_alloc(node_pool_t * pool)
+{
+    avl_node_t * node = pool->free_list;
+    if (node) {
+        pool->free_list = node->next;
+        return node;
+    }
+    if (pool->used == pool->block_size) {
+        node_block_t * block = malloc(sizeof(*block)
+                                      + pool->block_size * sizeof(block->nodes[0]));
+        block->next = pool->blocks;
+        pool->blocks = block;
+        pool->used = 0;
+    }
+    return &(pool->blocks->nodes[pool->used++].avl);
+}
+
+static void
+node_pool_release(node_pool_t * pool, avl_node_t * node)
+{
+    node->next = pool->free_list;
+    pool->free_list = node;
+}
+
+static void
+node_pool_free(node_pool_t * pool)
+{
+    node_block_t * block = pool->blocks;
+    while (block) {
+        node_block_t * next = block->next;
+        free(block);
+        block = next;
+    }
+    pool->blocks = NULL;
+}
+
+/* New node whose item is a copy of point x.  */
+static avl_node_t *
+new_node(node_pool_t * pool, const objective_t * x)
+{
+    eaf3d_node_t * node = (eaf3d_node_t *) node_pool_alloc(pool);
+    memcpy(node->x, x, sizeof(node->x));
+    return avl_init_node(&node->avl, node->x);
+}
 
 /*
 static bool avl_tree_is_empty (const avl_tree_t *avltree)
@@ -66,14 +140,15 @@ static int compare_node(const void *p1, const void *p2)
   Create a list of points, ordered by the third coordinate.
 */
 static dlnode_t *
-setup_cdllist(objective_t * restrict data, int d, const int * restrict cumsize, int nsets)
+setup_cdllist(objective_t * restrict data, int d, const size_t * restrict cumsize, int nsets)
 {
-    int n = cumsize[nsets - 1];
+    size_t n = cumsize[nsets - 1];
     dlnode_t * head = malloc((n + 1) * sizeof(dlnode_t));
     head->x = data;
     head->set = 0;
 
-    int i, k;
+    size_t i;
+    int k;
     for (i = 0, k = 0; i < n; i++) {
         if (i == cumsize[k]) k++;
 
@@ -343,16 +418,9 @@ void add2output(avl_tree_t *output, avl_node_t *tnode)
 
 void add2output_all(avl_tree_t *output, avl_tree_t *tree_add){
 
-    avl_node_t *node = tree_add->head;
-    avl_unlink_node(tree_add, node);
-    free(node->item);
-    free(node);
-
-    node = tree_add->tail;
-    avl_unlink_node(tree_add, node);
-    free(node->item);
-    free(node);
-
+    // Remove the sentinels.
+    avl_unlink_node(tree_add, tree_add->head);
+    avl_unlink_node(tree_add, tree_add->tail);
 
     if(tree_add->head != NULL){
         if(output->tail != NULL){
@@ -368,7 +436,8 @@ void add2output_all(avl_tree_t *output, avl_tree_t *tree_add){
 //this fuction is called only when item isn't dominated by any point in tree.
 //note: prevnode is above and at item's left, so any dominated point that it may dominate is at its right
 static void
-add2set(avl_tree_t *tree, avl_node_t *prevnode, avl_node_t *tnode, objective_t *item)
+add2set(node_pool_t * pool, avl_tree_t *tree, avl_node_t *prevnode, avl_node_t *tnode,
+        objective_t *item)
 {
     avl_init_node (tnode, item);
     if (node_point(prevnode)[0] == item[0])
@@ -382,7 +451,7 @@ add2set(avl_tree_t *tree, avl_node_t *prevnode, avl_node_t *tnode, objective_t *
         avl_unlink_node(tree, tnode);
         avl_node_t *node = tnode;
         tnode = tnode->next;
-        free(node);
+        node_pool_release(pool, node);
     }
 
 }
@@ -397,15 +466,9 @@ static void avl_add_promoter(avl_node_t *avlnode, int set, avl_node_t *promoter)
 }
 
 
-static void add_removed(removed_list_t * removed_list, avl_node_t *node)
-{
-    node->next = removed_list->head;
-    removed_list->head = node;
-}
-
 static avl_node_t *
-add2level(removed_list_t * removed_list, avl_tree_t *tree,
-          objective_t *item, avl_tree_t *output, int set, avl_node_t * promoter)
+add2level(node_pool_t * pool, avl_tree_t *tree,
+          const objective_t *item, avl_tree_t *output, int set, avl_node_t * promoter)
 {
     avl_node_t *prevnode;
     switch (avl_search_closest_y(tree, item, &prevnode)) {
@@ -423,8 +486,7 @@ add2level(removed_list_t * removed_list, avl_tree_t *tree,
     avl_node_t * aux = prevnode->next;
     // A new point (item) is added, but only if it isn't dominated.
     if (node_point(aux)[0] > item[0]) {
-        avl_node_t * tnode = malloc(sizeof(*tnode));
-        avl_init_node(tnode, item);
+        avl_node_t * tnode = new_node(pool, item);
         avl_add_promoter(tnode, set, promoter);
         avl_node_t *newnode = tnode;
         avl_insert_after(tree, prevnode, tnode);
@@ -437,35 +499,16 @@ add2level(removed_list_t * removed_list, avl_tree_t *tree,
 
             if (node_point(aux)[2] < item[2])
                 add2output(output, aux);
-            else {
-                free(aux->item);
-                add_removed(removed_list, aux);
+            else
                 aux->remover = newnode;
-            }
             /* Each point that is removed from this level,
                 becomes a final point but only if the point
                 that dominates it (item) dominates it only from
                 dimension 0 to 1.  */
         }
         return newnode;
-    } else{
-        free(item);
-        return NULL;
     }
-}
-
-static objective_t * new_point(objective_t x1, objective_t x2, objective_t x3)
-{
-    objective_t *value = malloc(3 * sizeof(objective_t));
-    value[0] = x1;
-    value[1] = x2;
-    value[2] = x3;
-    return value;
-}
-
-static objective_t * copy_point(const objective_t * v)
-{
-    return new_point(v[0], v[1], v[2]);
+    return NULL;
 }
 
 
@@ -496,7 +539,7 @@ find_point_below(avl_tree_t *tree, objective_t *item)
 
 
 void
-eaf3df(removed_list_t * removed_list, dlnode_t *list, avl_tree_t **set,
+eaf3df(node_pool_t * pool, dlnode_t *list, avl_tree_t **set,
        avl_tree_t **level, avl_tree_t **output, int nset)
 {
     struct aux_nodes {
@@ -515,11 +558,11 @@ eaf3df(removed_list_t * removed_list, dlnode_t *list, avl_tree_t **set,
     dlnode_t *new = list->next; //new - represents the new point
 
     // add new to its set
-    avl_node_t * tnode = avl_init_node(malloc(sizeof(avl_node_t)), new->x);
+    avl_node_t * tnode = avl_init_node(node_pool_alloc(pool), new->x);
     avl_insert_after(set[new->set], set[new->set]->head, tnode);
 
     //new is the only point so far, so it is added to the first level
-    tnode = avl_init_node(malloc(sizeof(avl_node_t)), copy_point(new->x));
+    tnode = new_node(pool, new->x);
     avl_add_promoter(tnode, new->set, NULL);
     avl_insert_after(level[0], level[0]->head, tnode);
 
@@ -592,8 +635,8 @@ eaf3df(removed_list_t * removed_list, dlnode_t *list, avl_tree_t **set,
                         aux[k].levelNode = find_point_below(level[k], setNode->item);
                         aux[k].promoter = aux[k].levelNode;
                     } else {
-                        objective_t * value = new_point(node_point(aux[k].levelNode)[0], node_point(aux[k].levelNode)[1], new->x[2]);
-                        tnode = add2level(removed_list, level[k+1], value, output[k+1], new->set, aux[k].promoter);
+                        const objective_t value[] = { node_point(aux[k].levelNode)[0], node_point(aux[k].levelNode)[1], new->x[2] };
+                        tnode = add2level(pool, level[k+1], value, output[k+1], new->set, aux[k].promoter);
                         if (tnode != NULL && new->x[2] == node_point(aux[k].promoter)[2]
                             && node_point(aux[k].levelNode)[0] == node_point(aux[k].promoter)[0]) {
                             aux[k].promoter->equal = tnode;
@@ -613,8 +656,8 @@ eaf3df(removed_list_t * removed_list, dlnode_t *list, avl_tree_t **set,
             //isn't dominated, it is added to level k+1
             if (node_point(aux[k].levelNode)[0] < node_point(setNode)[0]) {
 
-                objective_t * value = new_point(node_point(aux[k].levelNode)[0], new->x[1], new->x[2]);
-                tnode = add2level(removed_list, level[k+1], value, output[k+1], new->set, aux[k].promoter);
+                const objective_t value[] = { node_point(aux[k].levelNode)[0], new->x[1], new->x[2] };
+                tnode = add2level(pool, level[k+1], value, output[k+1], new->set, aux[k].promoter);
                 if (tnode != NULL && new->x[2] == node_point(aux[k].levelNode)[2]
                     && new->x[1] == node_point(aux[k].levelNode)[1]) {
                     aux[k].promoter->equal = tnode;
@@ -623,11 +666,11 @@ eaf3df(removed_list_t * removed_list, dlnode_t *list, avl_tree_t **set,
         }
 
         //add new to its set
-        tnode = avl_init_node(malloc(sizeof(avl_node_t)), new->x);
-        add2set(set[new->set], newPrev, tnode, new->x);
+        tnode = node_pool_alloc(pool);
+        add2set(pool, set[new->set], newPrev, tnode, new->x);
 
         //add new to the lowest level where it isn't dominated by any point from that level
-        tnode = add2level(removed_list, level[stop_at], copy_point(new->x), output[stop_at], new->set, dom_new);
+        tnode = add2level(pool, level[stop_at], new->x, output[stop_at], new->set, dom_new);
         if(stop_at > 0 && tnode != NULL && new->x[2] == node_point(dom_new)[2] &&
            new->x[1] == node_point(dom_new)[1] && new->x[0] == node_point(dom_new)[0]){
             dom_new->equal = tnode;
@@ -644,78 +687,14 @@ eaf3df(removed_list_t * removed_list, dlnode_t *list, avl_tree_t **set,
 }
 
 
-static void
-freetree(avl_tree_t *avltree)
-{
-    avl_node_t * aux = avltree->head;
-    if (aux) { // FIXME: Double check of aux?
-        while (aux) {
-            avl_node_t * aux2 = aux;
-            aux = aux2->next;
-            free(aux2->item);
-            free(aux2);
-        }
-    }
-
-    free(avltree);
-}
-
-static void
-freetree2(avl_tree_t *avltree)
-{
-    avl_node_t * aux = avltree->head;
-    free(aux->item);
-
-    while (aux->next) {
-        avl_node_t * aux2 = aux;
-        aux = aux2->next;
-        // FIXME: aux2->time is not freed?
-        free(aux2);
-    }
-    // FIXME: Double free of aux->item
-    free(aux->item);
-    free(aux);
-    free(avltree);
-}
-
-
-static void free_removed(removed_list_t * removed_list)
+static void add_sentinels(node_pool_t * pool, avl_tree_t * tree)
 {
-    avl_node_t * node = removed_list->head;
-    while (node != NULL) {
-        avl_node_t * aux = node;
-        node = node->next;
-        // FIXME: Do not free aux->item? Same as freetree()?
-        free(aux);
-    }
-    free(removed_list);
-}
-
-_attr_maybe_unused static void
-freeoutput(removed_list_t * removed_list, avl_tree_t **output, int nset)
-{
-    for (int i = 0; i < nset; i++) {
-        freetree(output[i]);
-    }
-    free(output);
-    free_removed(removed_list);
-}
-
-
-void add_sentinels(avl_tree_t * tree, int n)
-{
-    objective_t *value = malloc(n * sizeof(objective_t));
-    value[0] = objective_MIN;
-    value[1] = objective_MAX;
-
-    avl_node_t *tnode = avl_init_node(malloc(sizeof(avl_node_t)), value);
+    const objective_t left[] = { objective_MIN, objective_MAX, objective_MAX };
+    avl_node_t *tnode = new_node(pool, left);
     avl_insert_top(tree, tnode);
 
-    value = malloc(n * sizeof(objective_t));
-    value[0] = objective_MAX;
-    value[1] = objective_MIN;
-
-    avl_node_t *tnode2 = avl_init_node(malloc(sizeof(avl_node_t)), value);
+    const objective_t right[] = { objective_MAX, objective_MIN, objective_MAX };
+    avl_node_t *tnode2 = new_node(pool, right);
     avl_insert_after(tree, tnode, tnode2);
 }
 
@@ -733,53 +712,46 @@ eaf_store_point_3d(eaf_t * restrict eaf, objective_t x, objective_t y, objective
 
 
 eaf_t **
-eaf3d(objective_t * restrict data, const int * restrict cumsize, int nruns,
-      const int * restrict attlevel, const int nlevels)
+eaf3d(objective_t * restrict data, const size_t * restrict cumsize, int nruns,
+      const int * restrict attlevel, const int nlevels, bool store_attained)
 {
     const int nobj = 3;
-    const int ntotal = cumsize[nruns - 1]; /* total number of points in data */
+    const size_t ntotal = cumsize[nruns - 1]; /* total number of points in data */
     DEBUG1(/* Sanity check. */
         for (int i = 1; i < nruns ; i++)
             assert(cumsize[i-1] < cumsize[i]);
         );
 
-    /* FIXME: This seems wrong. It should be:
-       avl_tree_t * set = malloc (nruns * sizeof(*set));
-       avl_tree_t * level = malloc (nruns * sizeof(*level));
-       avl_tree_t * output = malloc (nruns * sizeof(*output));
+    /* All the trees are allocated at once, instead of calling
+       avl_alloc_tree() for each one, and the pointer arrays are kept so that
+       the trees can be indexed by run or level.  */
+    avl_tree_t * trees = malloc(3 * nruns * sizeof(*trees));
+    avl_tree_t ** set = malloc(nruns * sizeof(*set));
+    avl_tree_t ** level = malloc(nruns * sizeof(*level));
+    avl_tree_t ** output = malloc(nruns * sizeof(*output));
 
-       This way we do not need to do avl_alloc_tree for each tree, which
-       creates a lot of small memory chunks.
-    */
-    avl_tree_t ** set = malloc(2 * nruns * sizeof(avl_tree_t));
-    avl_tree_t ** level = malloc(nruns * sizeof(avl_tree_t));
-    avl_tree_t ** output = malloc(nruns * sizeof(avl_tree_t));
+    /* Each set needs a node per point and the levels need at least as many,
+       plus the sentinels.  */
+    node_pool_t pool;
+    node_pool_init(&pool, MAX(ntotal + 4 * (size_t) nruns, (size_t) 1024));
 
     int i;
     for (i = 0; i < nruns; i++) {
-        set[i]  = avl_alloc_tree ((avl_compare_t) compare_tree_asc_x, (avl_freeitem_t) free);
-        level[i]  = avl_alloc_tree ((avl_compare_t) compare_tree_asc_x, (avl_freeitem_t) free);
-        output[i]  = avl_alloc_tree ((avl_compare_t) compare_tree_asc_x, (avl_freeitem_t) free);
-
-        add_sentinels(set[i], nobj);
-        add_sentinels(level[i], nobj);
+        set[i] = avl_init_tree(trees + 3 * i, (avl_compare_t) compare_tree_asc_x, NULL);
+        level[i] = avl_init_tree(trees + 3 * i + 1, (avl_compare_t) compare_tree_asc_x, NULL);
+        output[i] = avl_init_tree(trees + 3 * i + 2, (avl_compare_t) compare_tree_asc_x, NULL);
 
+        add_sentinels(&pool, set[i]);
+        add_sentinels(&pool, level[i]);
     }
 
-    removed_list_t removed_list;
-    removed_list.head = NULL;
     dlnode_t * list = setup_cdllist(data, nobj, cumsize, nruns);
-    eaf3df(&removed_list, list, set, level, output, nruns);
+    eaf3df(&pool, list, set, level, output, nruns);
 
     for (i = 0; i < nruns; i++) {
         add2output_all(output[i], level[i]);
     }
 
-    for (i = 0; i < nruns; i++) {
-        freetree2(set[i]);
-        free(level[i]);
-    }
-
     free(list);
     free(set);
     free(level);
@@ -787,20 +759,32 @@ eaf3d(objective_t * restrict data, const int * restrict cumsize, int nruns,
     /* Create output EAF */
     /* FIXME: This should be done earlier instead of creating the trees. */
 
-    int * attained = malloc(nruns * sizeof(*attained));
     eaf_t ** eaf = malloc(nlevels * sizeof(*eaf));
+    /* The output trees are only read from here, so each level is extracted
+       in parallel.  */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
     for (int l = 0; l < nlevels; l++) {
-        eaf[l] = eaf_create(nobj, nruns, ntotal);
+        int * attained = malloc(nruns * sizeof(*attained));
+        eaf[l] = eaf_create(nobj, nruns, ntotal, store_attained);
         int k = attlevel[l] - 1;
         avl_node_t * aux = output[k]->head;
         while (aux) {
             objective_t * val = aux->item;
-            for (int j = 0; j < nruns; j++)
-                attained[j] = 0;
-            find_all_promoters(aux, attained, nruns);
+            if (store_attained) {
+                for (int j = 0; j < nruns; j++)
+                    attained[j] = 0;
+                find_all_promoters(aux, attained, nruns);
+            }
             eaf_store_point_3d(eaf[l], val[0], val[1], val[2], attained);
             aux = aux->next;
         }
+        free(attained);
     }
+    /* The removed nodes are only needed by find_all_promoters().  */
+    node_pool_free(&pool);
+    free(output);
+    free(trees);
     return eaf;
 }
@@ -63,6 +63,17 @@ OPTION_VERSION_STR
 "                     If FILE is '-', print to stdout.                      \n"
 "                     If FILE is missing use the same file as for output.   \n"
 "        , --polygons Write EAF as R polygons.                             \n"
+"        , --threads N  use N threads to compute the attainment surfaces   \n"
+"                     (only if compiled with OpenMP).                       \n"
+"        , --eafdiff  write the differences between the EAF of the sets of  \n"
+"                     the first FILE and the EAF of the sets of the second  \n"
+"                     FILE, as the points where the difference changes and  \n"
+"                     the difference. Each line is written as soon as it is \n"
+"                     computed (only two objectives).                       \n"
+"        , --rectangles  with --eafdiff, write the rectangles where the     \n"
+"                     difference is constant instead of points.             \n"
+"        , --intervals N  with --eafdiff, the differences are within [-N, N]\n"
+"                     (default: half the total number of sets).             \n"
 "\n\n"        );
 }
 
@@ -169,6 +180,42 @@ void read_input_data (const char *filename, objective_t **data_p,
     }
 }
 
+static void
+eaf_main_diff(FILE * stream, const objective_t * data, int nobj, const int * cumsizes,
+              int nruns_left, int nruns, int intervals, bool rectangles, bool verbose)
+{
+    const int nruns_right = nruns - nruns_left;
+    if (nobj != 2)
+        fatal_error("--eafdiff only supports two objectives");
+    if (nruns_left < 1 || nruns_right < 1)
+        fatal_error("--eafdiff requires at least one set in each input file");
+    if (intervals == 0)
+        intervals = nruns / 2;
+
+    size_t * cumsizes_left = MOOCORE_MALLOC(nruns, size_t);
+    size_t * cumsizes_right = cumsizes_left + nruns_left;
+    for (int k = 0; k < nruns_left; k++)
+        cumsizes_left[k] = (size_t) cumsizes[k];
+    const size_t ntotal_left = cumsizes_left[nruns_left - 1];
+    for (int k = 0; k < nruns_right; k++)
+        cumsizes_right[k] = (size_t) cumsizes[nruns_left + k] - ntotal_left;
+
+    if (verbose) {
+        fprintf(stderr, "# objectives (%d): --\n", nobj);
+        fprintf(stderr, "# sets: %d - %d\n", nruns_left, nruns_right);
+        fprintf(stderr, "# points: %zu - %zu\n", ntotal_left,
+                cumsizes_right[nruns_right - 1]);
+        fprintf(stderr, "# intervals: %d\n", intervals);
+    }
+    size_t nrows;
+    eafdiff2d(&nrows, data, cumsizes_left, nruns_left,
+              data + ntotal_left * nobj, cumsizes_right, nruns_right,
+              intervals, rectangles, stream);
+    if (verbose)
+        fprintf(stderr, "# %s: %zu\n", rectangles ? "rectangles" : "points", nrows);
+    free(cumsizes_left);
+}
+
 int main(int argc, char *argv[])
 {
     bool verbose_flag = true;
@@ -183,6 +230,11 @@ int main(int argc, char *argv[])
     FILE *indic_file = NULL;
     FILE *diff_file = NULL;
 
+    bool eafdiff_flag = false;
+    bool rectangles_flag = false;
+    int intervals = 0;
+
+    enum { threads_opt = 1000, eafdiff_opt, rectangles_opt, intervals_opt };
     /* see the man page for getopt_long for an explanation of these fields */
     static const char short_options[] = "hVvqbmwl:p:o:i::d::P";
     static const struct option long_options[] = {
@@ -202,6 +254,10 @@ int main(int argc, char *argv[])
         {"percentile", required_argument, NULL, 'p'},
         {"level",      required_argument, NULL, 'l'},
         {"polygons",   no_argument,       NULL, 'P'},
+        {"threads",    required_argument, NULL, threads_opt},
+        {"eafdiff",    no_argument,       NULL, eafdiff_opt},
+        {"rectangles", no_argument,       NULL, rectangles_opt},
+        {"intervals",  required_argument, NULL, intervals_opt},
         {NULL, 0, NULL, 0} /* marks end of list */
     };
 #define MAX_LEVELS 50
@@ -275,6 +331,34 @@ int main(int argc, char *argv[])
               polygon_flag = true;
               break;
 
+          case threads_opt:
+          {
+              char * endp;
+              long nthreads = strtol(optarg, &endp, 10);
+              if (*endp != '\0' || nthreads < 1 || nthreads > INT_MAX)
+                  fatal_error("invalid argument '%s' for --threads, it should be a positive integer", optarg);
+              moocore_set_num_threads((int) nthreads);
+              break;
+          }
+
+          case eafdiff_opt:
+              eafdiff_flag = true;
+              break;
+
+          case rectangles_opt:
+              rectangles_flag = true;
+              break;
+
+          case intervals_opt:
+          {
+              char * endp;
+              long n = strtol(optarg, &endp, 10);
+              if (*endp != '\0' || n < 1 || n > INT_MAX)
+                  fatal_error("invalid argument '%s' for --intervals, it should be a positive integer", optarg);
+              intervals = (int) n;
+              break;
+          }
+
           case 'q': // --quiet
               verbose_flag = false;
               break;
@@ -288,9 +372,13 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (eafdiff_flag && argc - optind != 2)
+        fatal_error("--eafdiff requires exactly two input files");
+
     objective_t *data = NULL;
     int* cumsizes = NULL;
     int nobj = 0, nruns = 0, k;
+    int nruns_left = 0; // Sets in the first file.
     if (optind < argc) {
         for (k = optind; k < argc; k++) {
             if (strcmp (argv[k],"-"))
@@ -298,6 +386,8 @@ int main(int argc, char *argv[])
                                  &cumsizes, &nruns);
             else
                 read_input_data (NULL, &data, &nobj, &cumsizes, &nruns);
+            if (k == optind)
+                nruns_left = nruns;
         }
     } else
         read_input_data (NULL, &data, &nobj, &cumsizes, &nruns);
@@ -345,6 +435,17 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (eafdiff_flag) {
+        eaf_main_diff(coord_file, data, nobj, cumsizes, nruns_left, nruns,
+                      intervals, rectangles_flag, verbose_flag);
+        fclose(coord_file);
+        free(level);
+        free(data);
+        free(percentile);
+        free(cumsizes);
+        return EXIT_SUCCESS;
+    }
+
     if (best_flag) {
         level[0] = 1;
         nlevels = 1;
@@ -401,7 +502,15 @@ int main(int argc, char *argv[])
         fprintf (stderr, "\n");
     }
 
-    eaf_t ** eaf = attsurf(data, nobj, cumsizes, nruns, level, nlevels);
+    size_t * set_cumsizes = MOOCORE_MALLOC(nruns, size_t);
+    for (k = 0; k < nruns; k++)
+        set_cumsizes[k] = (size_t) cumsizes[k];
+    /* Which runs attain each point is only needed for the indices, the
+       differences and the polygons.  */
+    const bool store_attained = polygon_flag || indic_file || diff_file;
+    eaf_t ** eaf = attsurf(data, nobj, set_cumsizes, nruns, level, nlevels,
+                           store_attained);
+    free(set_cumsizes);
 
     if (polygon_flag) {
         eaf_print_polygon(coord_file, eaf, nobj, nlevels);
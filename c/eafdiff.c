@@ -1,26 +1,70 @@
-#include "eaf.h"
+#include <string.h>
+#include "eafdiff_priv.h"
+#include "sort.h"
+
+DEFINE_QSORT_CMP(cmp_rectangle_row, double **)
+{
+    for (int k = 0; k < 5; k++) {
+        int res = cmp_double_asc((*a)[k], (*b)[k]);
+        if (res) return res;
+    }
+    // Keep the first occurrence first.
+    return (*a < *b) ? -1 : ((*a > *b) ? 1 : 0);
+}
+
+/* Remove repeated rows of a matrix of rectangles (4 coordinates + color),
+   keeping the first occurrence of each one in its original position.
+   Returns the new number of rows.  */
+static size_t
+rectangles_remove_duplicated(double * rows, size_t nrow)
+{
+    const int ncol = 5;
+    if (nrow < 2) return nrow;
+    double ** sorted = malloc(nrow * sizeof(*sorted));
+    for (size_t k = 0; k < nrow; k++)
+        sorted[k] = rows + k * ncol;
+    qsort_typesafe(sorted, nrow, cmp_rectangle_row);
+    bool * repeated = calloc(nrow, sizeof(*repeated));
+    for (size_t k = 1; k < nrow; k++) {
+        int j = 0;
+        while (j < ncol && sorted[k - 1][j] == sorted[k][j]) j++;
+        if (j == ncol)
+            repeated[(size_t) (sorted[k] - rows) / ncol] = true;
+    }
+    free(sorted);
+    size_t n = 0;
+    for (size_t k = 0; k < nrow; k++) {
+        if (repeated[k]) continue;
+        if (n < k)
+            memmove(rows + n * ncol, rows + k * ncol, ncol * sizeof(*rows));
+        n++;
+    }
+    free(repeated);
+    return n;
+}
 
 /* FIXME: Rmoocore.R contains another version of this function. */
 /* FIXME: data cannot be const because eaf_compute_rectangles will sort it. */
 double *
-eafdiff_compute_rectangles(int *eaf_npoints, double * data, int nobj,
-                           const int *cumsizes, int nruns, int intervals)
+eafdiff_compute_rectangles(size_t *eaf_npoints, double * data, int nobj,
+                           const size_t *cumsizes, int nruns, int intervals)
 {
     /* This returns all levels. attsurf() should probably handle this case. */
     int * level = levels_from_percentiles(NULL, nruns, nruns);
-    eaf_t **eaf = attsurf(data, nobj, cumsizes, nruns, level, nruns);
+    eaf_t **eaf = attsurf(data, nobj, cumsizes, nruns, level, nruns,
+                          /* store_attained = */true);
     free (level);
 
     eaf_polygon_t * rects = eaf_compute_rectangles(eaf, nobj, nruns);
     eaf_free(eaf, nruns);
 
     const int division = nruns / 2;
-    int nrow = (int) vector_int_size(&rects->col);
+    size_t nrow = vector_int_size(&rects->col);
     // Two points per row + color
     const int ncol = 2 * nobj + 1;
     double *result = malloc(sizeof(double) * nrow * ncol);
     const double * p_xy = vector_objective_begin(&rects->xy);
-    for (int k = 0; k < nrow; k++) {
+    for (size_t k = 0; k < nrow; k++) {
         for (int i = 0; i < ncol - 1; i++, p_xy++)
             result[k * ncol + i] = *p_xy;
         double color = vector_int_at(&rects->col, k);
@@ -30,31 +74,31 @@ eafdiff_compute_rectangles(int *eaf_npoints, double * data, int nobj,
     vector_objective_dtor (&rects->xy);
     vector_int_dtor (&rects->col);
     free(rects);
-    *eaf_npoints = nrow;
-    // FIXME: This may return duplicated rows, remove them.
+    *eaf_npoints = rectangles_remove_duplicated(result, nrow);
     return result;
 }
 
 double *
-eafdiff_compute_matrix(int *eaf_npoints, double * data, int nobj,
-                       const int *cumsizes, int nruns, int intervals)
+eafdiff_compute_matrix(size_t *eaf_npoints, double * data, int nobj,
+                       const size_t *cumsizes, int nruns, int intervals)
 {
     // FIXME: This assumes that half of the runs come from each side of the
     // difference but we could make this a parameter.
     const int nsets1 = nruns / 2;
     /* This returns all levels. attsurf() should probably handle this case. */
     int * level = levels_from_percentiles(NULL, nruns, nruns);
-    eaf_t **eaf = attsurf(data, nobj, cumsizes, nruns, level, nruns);
+    eaf_t **eaf = attsurf(data, nobj, cumsizes, nruns, level, nruns,
+                          /* store_attained = */true);
     free (level);
 
-    const int nrow = eaf_totalpoints (eaf, nruns);
+    const size_t nrow = eaf_totalpoints (eaf, nruns);
     const int ncol = nobj + 1;
     double *result = malloc(sizeof(double) * nrow * ncol);
-    int pos = 0;
+    size_t pos = 0;
     for (int k = 0; k < nruns; k++) {
-        int npoints = (int) eaf[k]->size;
+        size_t npoints = eaf[k]->size;
         // FIXME: Find the most efficient order of the loop.
-        for (int i = 0; i < npoints; i++) {
+        for (size_t i = 0; i < npoints; i++) {
             for (int j = 0; j < nobj; j++) {
                 result[pos * ncol + j] = eaf[k]->data[i * nobj + j];
             }
@@ -66,3 +110,259 @@ eafdiff_compute_matrix(int *eaf_npoints, double * data, int nobj,
     *eaf_npoints = nrow;
     return result;
 }
+
+/*
+   eafdiff2d: EAF differences between two datasets of two objectives with a
+              single sweep along the first objective.
+
+   This is the sweep of eaf2d_sweep() over the runs of both datasets, where
+   run r < nruns_left belongs to the left dataset.  For each position p of
+   the runs sorted by their minimum second objective, the runs at positions
+   0..p attain the band of the second objective between the minimum at p and
+   the minimum at p + 1, thus the difference within the band only depends on
+   how many of them are left runs.  When a point changes the minimum of its
+   run, only the bands between the old and the new position of the run
+   change, so the rectangles of those bands are closed and new ones are
+   opened.  The rectangles still open at the end extend to infinity.  Each
+   rectangle is output once, so there are no repeated rows.
+
+   Points are emitted at the same time as eaf2d_sweep() stores a new point
+   of an attainment surface, but only once for all the surfaces that share
+   it.
+*/
+
+DEFINE_QSORT_CMP(cmp_eafdiff_point_x, eafdiff_point_t *)
+{
+    return cmp_double_asc(a->x, b->x);
+}
+
+eafdiff_point_t *
+eafdiff_sorted_points(const double * restrict data, const size_t * restrict cumsizes,
+                      int nruns, int run_offset)
+{
+    const dimension_t nobj = 2;
+    const size_t ntotal = cumsizes[nruns - 1];
+    eafdiff_point_t * points = malloc(ntotal * sizeof(*points));
+    size_t k = 0;
+    for (int r = 0; r < nruns; r++)
+        for (; k < cumsizes[r]; k++)
+            points[k] = (eafdiff_point_t) { data[k * nobj], data[k * nobj + 1],
+                                            r + run_offset };
+    qsort_typesafe(points, ntotal, cmp_eafdiff_point_x);
+    return points;
+}
+
+void
+eafdiff_merge_points(eafdiff_point_t * restrict dst,
+                     const eafdiff_point_t * restrict a, size_t na,
+                     const eafdiff_point_t * restrict b, size_t nb, int run_offset)
+{
+    size_t i = 0, j = 0;
+    while (i < na || j < nb) {
+        if (j == nb || (i < na && a[i].x <= b[j].x)) {
+            *dst++ = a[i++];
+        } else {
+            *dst = b[j++];
+            dst->run += run_offset;
+            dst++;
+        }
+    }
+}
+
+static void
+eafdiff_output_row(eafdiff_output_t * restrict out, const objective_t * restrict row,
+                   int level)
+{
+    out->nrows++;
+    if (out->stream) {
+        fprintf(out->stream, point_printf_format, row[0]);
+        for (int k = 1; k < out->ncol; k++)
+            fprintf(out->stream, point_printf_sep point_printf_format, row[k]);
+        fprintf(out->stream, "\n");
+        return;
+    }
+    for (int k = 0; k < out->ncol; k++)
+        vector_objective_push_back(&out->rows, row[k]);
+    if (level > 0)
+        vector_int_push_back(&out->level, level);
+}
+
+static inline double
+eafdiff_value(int count_left, int nruns_left, int count_right, int nruns_right,
+              int n_intervals)
+{
+    /* A single rounding, so that the result is exact whenever it is an
+       integer, as with n_intervals == nruns_left == nruns_right.  */
+    return n_intervals * ((double) count_left * nruns_right
+                          - (double) count_right * nruns_left)
+        / ((double) nruns_left * nruns_right);
+}
+
+/* Rectangle of the band at one position of the sorted runs, open since x.  */
+typedef struct {
+    objective_t x, ylo, yhi;
+    int nleft;
+} eafdiff_band_t;
+
+static void
+eafdiff_close_band(eafdiff_output_t * restrict out, const eafdiff_band_t * restrict band,
+                   objective_t x, int p, int nruns_left, int nruns_right, int intervals)
+{
+    const int nleft = band->nleft;
+    const objective_t row[] = {
+        band->x, band->ylo, x, band->yhi,
+        eafdiff_value(nleft, nruns_left, p + 1 - nleft, nruns_right, intervals) };
+    eafdiff_output_row(out, row, 0);
+}
+
+void
+eafdiff2d_sweep(eafdiff_output_t * restrict out, const eafdiff_point_t * restrict points,
+                size_t ntotal, int nruns_left, int nruns_right, int intervals,
+                bool rectangles)
+{
+    const int nruns = nruns_left + nruns_right;
+    objective_t * minimum = malloc(2 * nruns * sizeof(*minimum));
+    objective_t * last = minimum + nruns; // Last value stored at each level.
+    int * sorted_runs = malloc(3 * nruns * sizeof(*sorted_runs));
+    int * run_pos = sorted_runs + nruns;
+    int * nleft = run_pos + nruns; // Left runs at positions 0..p.
+    eafdiff_band_t * band = rectangles ? malloc(nruns * sizeof(*band)) : NULL;
+    for (int r = 0; r < nruns; r++) {
+        minimum[r] = last[r] = objective_MAX;
+        sorted_runs[r] = run_pos[r] = r;
+        nleft[r] = MIN(r + 1, nruns_left);
+        if (band)
+            band[r] = (eafdiff_band_t) { objective_MAX, objective_MAX, objective_MAX, nleft[r] };
+    }
+
+    size_t i = 0;
+    while (i < ntotal) {
+        const objective_t x = points[i].x;
+        int lo = nruns, hi = -1; // Positions that changed.
+        do {
+            const int run = points[i].run;
+            const objective_t y = points[i].y;
+            if (y < minimum[run]) {
+                minimum[run] = y;
+                int pos = run_pos[run];
+                if (pos > hi) hi = pos;
+                while (pos > 0 && minimum[sorted_runs[pos - 1]] > y) {
+                    sorted_runs[pos] = sorted_runs[pos - 1];
+                    run_pos[sorted_runs[pos]] = pos;
+                    pos--;
+                }
+                sorted_runs[pos] = run;
+                run_pos[run] = pos;
+                if (pos < lo) lo = pos;
+            }
+            i++;
+        } while (i < ntotal && points[i].x == x);
+
+        if (hi < 0) continue;
+        for (int p = lo; p <= hi; p++)
+            nleft[p] = ((p == 0) ? 0 : nleft[p - 1]) + (sorted_runs[p] < nruns_left);
+
+        if (rectangles) {
+            /* The band below lo also changes its upper limit.  The band
+               attained by all runs has always a zero difference and, as in
+               eaf_compute_rectangles(), it is not reported.  */
+            for (int p = MAX(lo - 1, 0); p <= MIN(hi, nruns - 2); p++) {
+                const eafdiff_band_t b = {
+                    x, minimum[sorted_runs[p]],
+                    (p + 1 < nruns) ? minimum[sorted_runs[p + 1]] : objective_MAX,
+                    nleft[p] };
+                if (b.ylo == band[p].ylo && b.yhi == band[p].yhi && b.nleft == band[p].nleft)
+                    continue;
+                if (band[p].ylo < band[p].yhi)
+                    eafdiff_close_band(out, &band[p], x, p, nruns_left, nruns_right, intervals);
+                band[p] = b;
+            }
+            continue;
+        }
+
+        for (int p = lo; p <= hi; ) {
+            // Levels p + 1 .. q + 1 share the same value y.
+            const objective_t y = minimum[sorted_runs[p]];
+            int level = 0;
+            int q = p;
+            for (; q < nruns && minimum[sorted_runs[q]] == y; q++) {
+                if (q <= hi && y < last[q]) {
+                    last[q] = y;
+                    if (level == 0) level = q + 1;
+                }
+            }
+            q--;
+            if (level > 0) {
+                const objective_t row[] = {
+                    x, y, eafdiff_value(nleft[q], nruns_left, q + 1 - nleft[q],
+                                        nruns_right, intervals) };
+                eafdiff_output_row(out, row, level);
+            }
+            p = q + 1;
+        }
+    }
+
+    if (rectangles) {
+        for (int p = 0; p < nruns - 1; p++)
+            if (band[p].ylo < band[p].yhi)
+                eafdiff_close_band(out, &band[p], objective_MAX, p, nruns_left,
+                                   nruns_right, intervals);
+        free(band);
+    }
+    free(sorted_runs);
+    free(minimum);
+}
+
+double *
+eafdiff2d(size_t * restrict nrows,
+          const double * restrict data_left, const size_t * restrict cumsizes_left,
+          int nruns_left,
+          const double * restrict data_right, const size_t * restrict cumsizes_right,
+          int nruns_right, int intervals, bool rectangles, FILE * stream)
+{
+    const dimension_t nobj = 2;
+    const int nruns = nruns_left + nruns_right;
+    const size_t ntotal_left = cumsizes_left[nruns_left - 1];
+    const size_t ntotal_right = cumsizes_right[nruns_right - 1];
+    const size_t ntotal = ntotal_left + ntotal_right;
+
+    eafdiff_point_t * left = eafdiff_sorted_points(data_left, cumsizes_left, nruns_left, 0);
+    eafdiff_point_t * right = eafdiff_sorted_points(data_right, cumsizes_right,
+                                                    nruns_right, 0);
+    eafdiff_point_t * points = malloc(ntotal * sizeof(*points));
+    eafdiff_merge_points(points, left, ntotal_left, right, ntotal_right, nruns_left);
+    free(right);
+    free(left);
+
+    eafdiff_output_t out = { .stream = stream, .ncol = rectangles ? 2 * nobj + 1 : nobj + 1 };
+    if (!stream) {
+        vector_objective_ctor(&out.rows, ntotal * out.ncol);
+        if (!rectangles)
+            vector_int_ctor(&out.level, ntotal);
+    }
+    eafdiff2d_sweep(&out, points, ntotal, nruns_left, nruns_right, intervals, rectangles);
+    free(points);
+
+    *nrows = out.nrows;
+    if (stream) return NULL;
+    double * result = vector_objective_begin(&out.rows);
+    if (!rectangles) {
+        /* Order the points by their lowest attainment level, then by the
+           first objective, as eafdiff_compute_matrix().  */
+        size_t * start = calloc(nruns + 1, sizeof(*start));
+        for (size_t k = 0; k < out.nrows; k++)
+            start[vector_int_at(&out.level, k)]++;
+        for (int l = 1; l <= nruns; l++)
+            start[l] += start[l - 1];
+        result = malloc(out.nrows * out.ncol * sizeof(*result));
+        const double * row = vector_objective_begin(&out.rows);
+        for (size_t k = 0; k < out.nrows; k++, row += out.ncol) {
+            const size_t pos = start[vector_int_at(&out.level, k) - 1]++;
+            memcpy(result + pos * out.ncol, row, out.ncol * sizeof(*result));
+        }
+        free(start);
+        vector_int_dtor(&out.level);
+        vector_objective_dtor(&out.rows);
+    }
+    return result;
+}
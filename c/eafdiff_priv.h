@@ -0,0 +1,39 @@
+#ifndef _EAFDIFF_PRIV_H
+#define _EAFDIFF_PRIV_H
+
+#include "eaf.h"
+
+/* A point of a run, as processed by eafdiff2d_sweep().  */
+typedef struct {
+    objective_t x, y;
+    int run;
+} eafdiff_point_t;
+
+typedef struct {
+    FILE * stream;
+    int ncol;
+    size_t nrows;
+    vector_objective rows;
+    vector_int level; // Lowest attainment level of each point (in memory only).
+} eafdiff_output_t;
+
+/* The points of the runs of one dataset sorted by the first objective.  The
+   run of each point is its index within the dataset plus run_offset.  */
+eafdiff_point_t *
+eafdiff_sorted_points(const double * data, const size_t * cumsizes, int nruns,
+                      int run_offset);
+
+/* Merge two lists sorted by eafdiff_sorted_points() into dst, adding
+   run_offset to the runs of b.  */
+void
+eafdiff_merge_points(eafdiff_point_t * dst, const eafdiff_point_t * a, size_t na,
+                     const eafdiff_point_t * b, size_t nb, int run_offset);
+
+/* The sweep of eafdiff2d() over the merged points of both datasets, where
+   the runs of the left dataset are 0..nruns_left - 1.  The rows are written
+   to out, which must be initialized by the caller.  */
+void
+eafdiff2d_sweep(eafdiff_output_t * out, const eafdiff_point_t * points, size_t ntotal,
+                int nruns_left, int nruns_right, int intervals, bool rectangles);
+
+#endif /* _EAFDIFF_PRIV_H */
@@ -0,0 +1,314 @@
+#include "config.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "eaf.h"
+#include "sort.h"
+#include "radixsort.h"
+
+#if OBJECTIVE_TYPE != OBJECTIVE_TYPE_DOUBLE
+# error "eafnd() requires OBJECTIVE_TYPE == OBJECTIVE_TYPE_DOUBLE"
+#endif
+
+/* Attainment surfaces of four or more objectives.
+
+   Dimension sweep along the last objective.  Let P(z) be the points whose
+   last objective is at most z, projected onto the first nobj - 1 objectives.
+   A point (v, z) belongs to the attainment surface of level l if and only if
+   v is a minimal point of the region attained at level l by P(z) that is not
+   attained at level l by P(z'), for the previous value z' < z of the last
+   objective.  Otherwise, (v, z') weakly dominates (v, z).
+
+   Such a v is newly attained, thus it is weakly dominated by a point u of
+   P(z) \ P(z').  The region attained by P(z) within the upper set of u is the
+   region attained by the points max(p, u) for p in P(z), so v is a point of
+   the (nobj - 1)-dimensional attainment surface of level l of these clipped
+   points.  A point of this surface was attained by P(z') if and only if it
+   is also a point of the surface of P(z') clipped by u.  The new points of
+   the surface at z are the minimal points among the points in the former
+   but not in the latter, for every new u.  A new point u weakly dominated by
+   a previous point of its run does not attain anything new and it is
+   skipped, so slices without other new points are skipped entirely.
+
+   The surfaces of the clipped points are computed by attsurf(), thus by
+   eaf3d() for four objectives and recursively for more.  They only cover
+   the upper set of u, so they are typically much smaller than the surfaces
+   of P(z).  */
+
+static inline bool
+eafnd_weakly_dominates(const objective_t * restrict a, const objective_t * restrict b,
+                       dimension_t dim)
+{
+    for (dimension_t d = 0; d < dim; d++)
+        if (a[d] > b[d])
+            return false;
+    return true;
+}
+
+/* Surface of one level, sorted lexicographically.  */
+typedef struct {
+    eaf_t * eaf;
+    const objective_t ** rows;
+} eafnd_surf_t;
+
+static const objective_t **
+eafnd_sorted_rows(const eaf_t * eaf, dimension_t nobj)
+{
+    const objective_t ** rows = generate_row_pointers(eaf->data, eaf->size, nobj);
+    radix_sort_asc_rev(rows, eaf->size, (dimension_t) (nobj - 1));
+    return rows;
+}
+
+/* Whether one of the first n points of a run weakly dominates u.  */
+static bool
+eafnd_run_attains(const objective_t ** restrict run, size_t n,
+                  const objective_t * restrict u, dimension_t dim)
+{
+    for (size_t j = 0; j < n; j++)
+        if (eafnd_weakly_dominates(run[j], u, dim))
+            return true;
+    return false;
+}
+
+/* The surfaces of the levels sub_attlevel[] of the first n[r] points of each
+   run r clipped by u, sorted lexicographically.  The points weakly dominated
+   by u are all clipped to u, so only one of them is kept per run.  The
+   surfaces of levels higher than the number of runs with points are empty
+   (NULL).  */
+static eafnd_surf_t *
+eafnd_clipped_surfaces(const objective_t * restrict u, dimension_t sub_nobj,
+                       const objective_t ** restrict run_rows,
+                       const size_t * restrict cumsize, int nruns,
+                       const size_t * restrict n, const int * restrict sub_attlevel,
+                       int nsublevels, objective_t * restrict sub_data,
+                       size_t * restrict sub_cumsize, int * restrict present_attlevel,
+                       int * restrict present_of)
+{
+    int nsub = 0;
+    size_t m = 0;
+    for (int r = 0; r < nruns; r++) {
+        if (n[r] == 0) continue;
+        const objective_t ** run = run_rows + ((r == 0) ? 0 : cumsize[r - 1]);
+        bool clipped_to_u = false;
+        for (size_t j = 0; j < n[r]; j++) {
+            if (eafnd_weakly_dominates(run[j], u, sub_nobj)) {
+                if (clipped_to_u) continue;
+                clipped_to_u = true;
+            }
+            for (dimension_t d = 0; d < sub_nobj; d++)
+                sub_data[m * sub_nobj + d] = MAX(run[j][d], u[d]);
+            m++;
+        }
+        sub_cumsize[nsub++] = m;
+    }
+
+    eafnd_surf_t * surf = calloc(nsublevels, sizeof(*surf));
+    int npresent = 0;
+    for (int s = 0; s < nsublevels; s++) {
+        if (sub_attlevel[s] <= nsub) {
+            present_attlevel[npresent] = sub_attlevel[s];
+            present_of[npresent++] = s;
+        }
+    }
+    if (npresent == 0)
+        return surf;
+    eaf_t ** sub_eaf = attsurf(sub_data, sub_nobj, sub_cumsize, nsub,
+                               present_attlevel, npresent, /* store_attained=*/false);
+    for (int s = 0; s < npresent; s++)
+        surf[present_of[s]] = (eafnd_surf_t) {
+            sub_eaf[s], eafnd_sorted_rows(sub_eaf[s], sub_nobj) };
+    free(sub_eaf);
+    return surf;
+}
+
+static void
+eafnd_surfaces_free(eafnd_surf_t * surf, int nsublevels)
+{
+    for (int s = 0; s < nsublevels; s++) {
+        if (surf[s].eaf == NULL) continue;
+        eaf_delete(surf[s].eaf);
+        free(surf[s].rows);
+    }
+    free(surf);
+}
+
+/* Append to cand the points of cur that are not in prev.  */
+static void
+eafnd_new_candidates(eaf_t * restrict cand, dimension_t sub_nobj,
+                     const eafnd_surf_t * restrict prev,
+                     const eafnd_surf_t * restrict cur)
+{
+    const size_t prev_size = prev->eaf ? prev->eaf->size : 0;
+    size_t j = 0;
+    for (size_t i = 0; i < cur->eaf->size; i++) {
+        const objective_t * v = cur->rows[i];
+        int cmp = 1;
+        while (j < prev_size
+               && (cmp = cmp_pdouble_asc_rev(prev->rows[j], v, sub_nobj - 1)) < 0)
+            j++;
+        if (j < prev_size && cmp == 0)
+            continue;
+        objective_t * pos = eaf_store_point_help(cand, sub_nobj, NULL);
+        memcpy(pos, v, sub_nobj * sizeof(*pos));
+        cand->size++;
+    }
+}
+
+/* Store (v, z) for every minimal point v of cand.  If only one new point
+   produced candidates, they are already minimal.  The runs attaining v are
+   those with a point seen so far that weakly dominates it.  */
+static void
+eafnd_store_new_points(eaf_t * restrict eaf, dimension_t nobj, objective_t z,
+                       const eaf_t * restrict cand, bool minimal,
+                       const objective_t ** restrict kept,
+                       const objective_t ** restrict run_rows,
+                       const size_t * restrict cumsize, const size_t * restrict nseen,
+                       int * restrict attained)
+{
+    const dimension_t sub_nobj = (dimension_t) (nobj - 1);
+    const objective_t ** rows = generate_row_pointers(cand->data, cand->size, sub_nobj);
+    /* A point can only be weakly dominated by a point sorted before it.  */
+    radix_sort_asc_rev(rows, cand->size, (dimension_t) (sub_nobj - 1));
+    size_t nkept = 0;
+    for (size_t i = 0; i < cand->size; i++) {
+        const objective_t * v = rows[i];
+        if (!minimal) {
+            size_t j = 0;
+            while (j < nkept && !eafnd_weakly_dominates(kept[j], v, sub_nobj))
+                j++;
+            if (j < nkept)
+                continue;
+            kept[nkept++] = v;
+        }
+        if (eaf->bit_attained) {
+            for (int r = 0; r < eaf->nruns; r++)
+                attained[r] = eafnd_run_attains(run_rows + ((r == 0) ? 0 : cumsize[r - 1]),
+                                                nseen[r], v, sub_nobj);
+        }
+        objective_t * pos = eaf_store_point_help(eaf, nobj, attained);
+        memcpy(pos, v, sub_nobj * sizeof(*pos));
+        pos[sub_nobj] = z;
+        eaf->size++;
+    }
+    free(rows);
+}
+
+eaf_t **
+eafnd(objective_t * restrict data, int nobj, const size_t * restrict cumsize,
+      int nruns, const int * restrict attlevel, const int nlevels,
+      bool store_attained)
+{
+    ASSUME(nobj >= 4);
+    const dimension_t last = (dimension_t) (nobj - 1);
+    const dimension_t sub_nobj = last;
+    const size_t ntotal = cumsize[nruns - 1]; /* total number of points in data */
+
+    /* The points of each run sorted by the last objective, and all points
+       sorted by the last objective.  radix_sort_asc_only() does not handle
+       any objective, but breaking ties with the other objectives is
+       harmless.  */
+    const objective_t ** run_rows = generate_row_pointers(data, ntotal, (dimension_t) nobj);
+    for (int r = 0; r < nruns; r++) {
+        const size_t start = (r == 0) ? 0 : cumsize[r - 1];
+        radix_sort_asc_rev(run_rows + start, cumsize[r] - start, last);
+    }
+    const objective_t ** rows = generate_row_pointers(data, ntotal, (dimension_t) nobj);
+    radix_sort_asc_rev(rows, ntotal, last);
+    int * runtab = malloc(ntotal * sizeof(*runtab));
+    size_t k = 0;
+    for (int r = 0; r < nruns; r++)
+        for (; k < cumsize[r]; k++)
+            runtab[k] = r;
+
+    size_t * nseen = calloc(nruns, sizeof(*nseen));
+    size_t * nold = malloc(nruns * sizeof(*nold));
+    objective_t * sub_data = malloc(ntotal * sub_nobj * sizeof(*sub_data));
+    size_t * sub_cumsize = malloc(nruns * sizeof(*sub_cumsize));
+    int * sub_attlevel = malloc(nlevels * sizeof(*sub_attlevel));
+    int * sub_level_of = malloc(nlevels * sizeof(*sub_level_of));
+    int * present_attlevel = malloc(nlevels * sizeof(*present_attlevel));
+    int * present_of = malloc(nlevels * sizeof(*present_of));
+    int * attained = store_attained ? malloc(nruns * sizeof(*attained)) : NULL;
+    const objective_t ** kept = NULL;
+    size_t kept_size = 0;
+
+    eaf_t ** eaf = malloc(nlevels * sizeof(*eaf));
+    eaf_t ** cand = malloc(nlevels * sizeof(*cand));
+    for (int l = 0; l < nlevels; l++) {
+        eaf[l] = eaf_create(nobj, nruns, ntotal, store_attained);
+        cand[l] = eaf_create(sub_nobj, nruns, 0, /* store_attained=*/false);
+    }
+
+    size_t i = 0;
+    while (i < ntotal) {
+        const objective_t z = rows[i][last];
+        memcpy(nold, nseen, nruns * sizeof(*nold));
+        do {
+            nseen[runtab[(rows[i] - data) / nobj]]++;
+            i++;
+        } while (i < ntotal && rows[i][last] == z);
+
+        int nsub = 0;
+        for (int r = 0; r < nruns; r++)
+            nsub += (nseen[r] > 0);
+        /* Levels higher than the number of runs seen are not attained yet.  */
+        int nsublevels = 0;
+        for (int l = 0; l < nlevels; l++) {
+            if (attlevel[l] <= nsub) {
+                sub_attlevel[nsublevels] = attlevel[l];
+                sub_level_of[nsublevels++] = l;
+            }
+        }
+        if (nsublevels == 0) continue;
+
+        for (int s = 0; s < nsublevels; s++)
+            cand[s]->size = 0;
+        int nnew = 0;
+        for (int r = 0; r < nruns; r++) {
+            const objective_t ** run = run_rows + ((r == 0) ? 0 : cumsize[r - 1]);
+            for (size_t j = nold[r]; j < nseen[r]; j++) {
+                if (eafnd_run_attains(run, j, run[j], sub_nobj))
+                    continue;
+                eafnd_surf_t * cur = eafnd_clipped_surfaces(
+                    run[j], sub_nobj, run_rows, cumsize, nruns, nseen,
+                    sub_attlevel, nsublevels, sub_data, sub_cumsize,
+                    present_attlevel, present_of);
+                eafnd_surf_t * prev = eafnd_clipped_surfaces(
+                    run[j], sub_nobj, run_rows, cumsize, nruns, nold,
+                    sub_attlevel, nsublevels, sub_data, sub_cumsize,
+                    present_attlevel, present_of);
+                for (int s = 0; s < nsublevels; s++)
+                    eafnd_new_candidates(cand[s], sub_nobj, &prev[s], &cur[s]);
+                eafnd_surfaces_free(prev, nsublevels);
+                eafnd_surfaces_free(cur, nsublevels);
+                nnew++;
+            }
+        }
+        for (int s = 0; s < nsublevels; s++) {
+            if (nnew > 1 && cand[s]->size > kept_size) {
+                kept_size = cand[s]->size;
+                kept = realloc(kept, kept_size * sizeof(*kept));
+            }
+            eafnd_store_new_points(eaf[sub_level_of[s]], (dimension_t) nobj, z,
+                                   cand[s], /* minimal=*/nnew <= 1, kept,
+                                   run_rows, cumsize, nseen, attained);
+        }
+    }
+
+    eaf_free(cand, nlevels);
+    free(kept);
+    free(attained);
+    free(present_of);
+    free(present_attlevel);
+    free(sub_level_of);
+    free(sub_attlevel);
+    free(sub_cumsize);
+    free(sub_data);
+    free(nold);
+    free(nseen);
+    free(runtab);
+    free(rows);
+    free(run_rows);
+    return eaf;
+}
@@ -54,6 +54,7 @@
 
 static bool verbose_flag = false;
 static bool additive_flag = true;
+static bool pairwise_flag = false;
 static const char *suffix = NULL;
 
 static void usage(void)
@@ -75,6 +76,9 @@ OPTION_QUIET_STR
 " -a, --additive       epsilon additive value %s.                       \n"
 " -m, --multiplicative epsilon multiplicative value %s.                 \n"
 " -r, --reference FILE file that contains the reference set                  \n"
+" -P, --pairwise       print the epsilon value of each set with respect to each\n"
+"                      other set of the same file (one row per set) instead \n"
+"                      of using a reference set.                            \n"
 OPTION_OBJ_STR
 OPTION_MAXIMISE_STR
 "   , --[no]-check     The reference set must be nondominated. By default, \n"
@@ -111,6 +115,28 @@ do_file(const char * filename, double * restrict reference, size_t reference_siz
     if (verbose_flag)
         printf("# file: %s\n", filename);
 
+    if (pairwise_flag) {
+        size_t nsets = (size_t) nruns;
+        size_t * set_cumsizes = MOOCORE_MALLOC(nsets, size_t);
+        for (size_t k = 0; k < nsets; k++)
+            set_cumsizes[k] = (size_t) cumsizes[k];
+        double * matrix = MOOCORE_MALLOC(nsets * nsets, double);
+        if (additive_flag)
+            epsilon_additive_matrix_minmax(matrix, minmax, nobj, data, set_cumsizes, nsets);
+        else
+            epsilon_mult_matrix_minmax(matrix, minmax, nobj, data, set_cumsizes, nsets);
+        for (size_t i = 0; i < nsets; i++) {
+            fprintf(outfile, indicator_printf_format, matrix[i * nsets]);
+            for (size_t j = 1; j < nsets; j++)
+                fprintf(outfile, point_printf_sep indicator_printf_format,
+                        matrix[i * nsets + j]);
+            fprintf(outfile, "\n");
+        }
+        free(matrix);
+        free(set_cumsizes);
+        goto finish;
+    }
+
     for (int n = 0, cumsize = 0; n < nruns; cumsize = cumsizes[n], n++) {
         // double time_elapsed = 0;
         //Timer_start ();
@@ -133,6 +159,7 @@ do_file(const char * filename, double * restrict reference, size_t reference_siz
          */
     }
 
+finish:
     fclose_outfile(outfile, filename, outfilename, verbose_flag);
     free(data);
     free(cumsizes);
@@ -142,7 +169,7 @@ do_file(const char * filename, double * restrict reference, size_t reference_siz
 int main(int argc, char *argv[])
 {
     // See the man page for getopt_long for an explanation of these fields.
-    static const char short_options[] = "hVvqamMr:s:o:";
+    static const char short_options[] = "hVvqamMPr:s:o:";
     static const struct option long_options[] = {
         {"help",            no_argument,        NULL, 'h'},
         {"version",         no_argument,        NULL, 'V'},
@@ -155,6 +182,7 @@ int main(int argc, char *argv[])
         {"maximise",        no_argument,        NULL, 'M'},
         {"maximize",        no_argument,        NULL, 'M'},
         {"reference",       required_argument,  NULL, 'r'},
+        {"pairwise",        no_argument,        NULL, 'P'},
         {"suffix",          required_argument,  NULL, 's'},
         {"obj",             required_argument,  NULL, 'o'},
         {NULL, 0, NULL, 0} /* marks end of list */
@@ -196,6 +224,10 @@ int main(int argc, char *argv[])
             minmax = parse_cmdline_minmax(minmax, optarg, &nobj);
             break;
 
+        case 'P': // --pairwise
+            pairwise_flag = true;
+            break;
+
         case 'r': // --reference
             reference_size = read_reference_set(optarg, &reference, &nobj);
             break;
@@ -222,22 +254,26 @@ int main(int argc, char *argv[])
                  ? "# Additive epsilon indicator\n"
                  : "# Multiplicative epsilon indicator\n");
 
-    if (reference == NULL) {
+    if (reference == NULL && !pairwise_flag) {
         errprintf ("a reference set must be provided (--reference)");
         exit (EXIT_FAILURE);
     }
-    if (minmax == NULL) {
+    if (reference != NULL && pairwise_flag) {
+        errprintf ("options --reference and --pairwise are incompatible");
+        exit (EXIT_FAILURE);
+    }
+    if (minmax == NULL && !pairwise_flag) {
         minmax = maximise_all_flag ? minmax_maximise((dimension_t) nobj) : minmax_minimise((dimension_t) nobj);
     }
-    if (check_flag) {
+    if (check_flag && !pairwise_flag) {
         // Ensure the reference set is nondominated.
         size_t prev_reference_size = reference_size;
         reference_size = filter_dominated_set(reference, reference_size, (dimension_t) nobj, minmax);
         if (prev_reference_size > reference_size)
-            warnprintf("removed %zd dominated points from the reference set",
+            warnprintf("removed %zu dominated points from the reference set",
                        prev_reference_size - reference_size);
     }
-    if (!additive_flag && !all_positive(reference, reference_size, (dimension_t) nobj)) {
+    if (!additive_flag && !pairwise_flag && !all_positive(reference, reference_size, (dimension_t) nobj)) {
         errprintf("cannot calculate multiplicative epsilon indicator with non-positive values in reference front.");
         exit(EXIT_FAILURE);
     }
@@ -3,11 +3,13 @@
 
 #include "config.h"
 #include <math.h>
+#include <string.h>
 #ifndef INFINITY
 #define INFINITY (HUGE_VAL)
 #endif
 #include "common.h"
 #include "nondominated.h" // minmax_from_bool
+#include "kdtree.h"
 
 static inline bool
 all_positive(const double * restrict points, size_t size, dimension_t dim)
@@ -44,18 +46,6 @@ all_positive(const double * restrict points, size_t size, dimension_t dim)
  */
 
 
-_attr_optimize_finite_math
-static inline double
-epsilon_helper_(bool do_mult, const enum objs_agree_t agree,
-                const int * restrict minmax, dimension_t dim,
-                const double * restrict points_a, size_t size_a,
-                const double * restrict points_b, size_t size_b)
-{
-    ASSUME(2 <= dim);
-    ASSUME(size_a > 0 && size_b > 0);
-    ASSUME(agree == AGREE_MINIMISE || agree == AGREE_MAXIMISE || agree == AGREE_NONE);
-    assert((agree == AGREE_NONE) == (minmax != NULL));
-
 // Converting these macros to an inline function hinders vectorization.
 #define eps_value_(X, Y)   (do_mult ? ((X) / (Y)) : ((X) - (Y)))
 #define eps_value_minmax_(M, X, Y)                                             \
@@ -64,8 +54,116 @@ epsilon_helper_(bool do_mult, const enum objs_agree_t agree,
     (minmax ? eps_value_minmax_(minmax[DIM], pa[DIM], pb[DIM])                 \
      : ((agree == AGREE_MINIMISE)                                              \
         ? eps_value_(pa[DIM], pb[DIM]) : eps_value_(pb[DIM], pa[DIM])))
+// Lower bound of eps_value_agree_(DIM) for any pa within the box [lo, hi].
+#define eps_bound_agree_(DIM)                                                  \
+    (minmax ? ((minmax[DIM] < 0) ? eps_value_(lo[DIM], pb[DIM])                \
+               : ((minmax[DIM] > 0) ? eps_value_(pb[DIM], hi[DIM]) : 0))       \
+     : ((agree == AGREE_MINIMISE)                                              \
+        ? eps_value_(lo[DIM], pb[DIM]) : eps_value_(pb[DIM], hi[DIM])))
+
+/******************************************************************************
+ For large sets, the point of A closest to each point of B is searched with a
+ k-d tree built over A (kdtree.h).  The bounding box of a node gives a lower
+ bound of the epsilon value of any point within it, so most of A is pruned.
+ As in epsilon_helper_(), the search for a point of B stops as soon as it
+ cannot increase the value found so far.  Only the values computed for actual
+ points are returned, so the result is exactly the same as brute force.
+******************************************************************************/
+
+/* Use the k-d tree when A has at least EPSILON_KDTREE_MIN_SIZE points.  With
+   more than EPSILON_KDTREE_DIM_MAX objectives, the tree does not prune enough
+   when many points of A are close to B.  */
+#ifndef EPSILON_KDTREE_MIN_SIZE
+#define EPSILON_KDTREE_MIN_SIZE 256
+#endif
+#define EPSILON_KDTREE_DIM_MAX 8
+
+static inline bool
+epsilon_use_kdtree(dimension_t dim, size_t size_a, size_t size_b)
+{
+    return dim >= 2 && dim <= EPSILON_KDTREE_DIM_MAX
+        && size_a >= EPSILON_KDTREE_MIN_SIZE && size_b >= 16;
+}
+
+_attr_optimize_finite_math
+static inline double
+epsilon_box_bound_(bool do_mult, const enum objs_agree_t agree,
+                   const int * restrict minmax, dimension_t dim,
+                   const double * restrict lo, const double * restrict pb)
+{
+    const double * restrict hi = lo + dim;
+    double bound = eps_bound_agree_(0);
+    for (dimension_t d = 1; d < dim; d++)
+        bound = MAX(bound, eps_bound_agree_(d));
+    return bound;
+}
+
+_attr_optimize_finite_math
+static void
+epsilon_kdtree_rec_(bool do_mult, const enum objs_agree_t agree,
+                    const int * restrict minmax, const kdtree_t * restrict tree,
+                    const double * restrict pb, size_t node, double stop,
+                    double * restrict best)
+{
+    const dimension_t dim = tree->dim;
+    const kdtree_node_t * n = tree->nodes + node;
+    if (n->left == 0) {
+        for (size_t i = n->begin; i < n->end; i++) {
+            const double * restrict pa = tree->points + i * dim;
+            double epsilon_max = eps_value_agree_(0);
+            for (dimension_t d = 1; d < dim; d++)
+                epsilon_max = MAX(epsilon_max, eps_value_agree_(d));
+            *best = MIN(*best, epsilon_max);
+        }
+        return;
+    }
+    size_t first = n->left, second = n->right;
+    double bound_first = epsilon_box_bound_(do_mult, agree, minmax, dim,
+                                            tree->bounds + first * 2 * dim, pb);
+    double bound_second = epsilon_box_bound_(do_mult, agree, minmax, dim,
+                                             tree->bounds + second * 2 * dim, pb);
+    if (bound_second < bound_first) {
+        SWAP(first, second);
+        SWAP(bound_first, bound_second);
+    }
+    if (bound_first < *best && *best > stop) {
+        epsilon_kdtree_rec_(do_mult, agree, minmax, tree, pb, first, stop, best);
+        if (bound_second < *best && *best > stop)
+            epsilon_kdtree_rec_(do_mult, agree, minmax, tree, pb, second, stop, best);
+    }
+}
+
+/* Starting from the value epsilon, which must not exceed the result, return
+   the epsilon indicator or, as soon as it exceeds limit, a value larger than
+   limit.  */
+_attr_optimize_finite_math
+static inline double
+epsilon_kdtree_(bool do_mult, const enum objs_agree_t agree,
+                const int * restrict minmax, const kdtree_t * restrict tree_a,
+                const double * restrict points_b, size_t size_b,
+                double epsilon, double limit)
+{
+    const dimension_t dim = tree_a->dim;
+    for (size_t b = 0; b < size_b; b++) {
+        double epsilon_min = INFINITY;
+        epsilon_kdtree_rec_(do_mult, agree, minmax, tree_a, points_b + b * dim,
+                            0, epsilon, &epsilon_min);
+        epsilon = MAX(epsilon, epsilon_min);
+        if (epsilon > limit)
+            break;
+    }
+    return epsilon;
+}
 
-    double epsilon = do_mult ? 0 : -INFINITY;
+/* Same as epsilon_kdtree_() without a tree.  */
+_attr_optimize_finite_math
+static inline double
+epsilon_brute_(bool do_mult, const enum objs_agree_t agree,
+               const int * restrict minmax, dimension_t dim,
+               const double * restrict points_a, size_t size_a,
+               const double * restrict points_b, size_t size_b,
+               double epsilon, double limit)
+{
     for (size_t b = 0; b < size_b; b++) {
         double epsilon_min = INFINITY;
         const double * restrict pb = points_b + b * dim;
@@ -86,15 +184,42 @@ epsilon_helper_(bool do_mult, const enum objs_agree_t agree,
             epsilon_min = MIN(epsilon_min, epsilon_max);
         }
         epsilon = MAX(epsilon, epsilon_min);
+        if (epsilon > limit)
+            break;
     skip_max:
         (void)0;
     }
     return epsilon;
 }
 
+_attr_optimize_finite_math
+static inline double
+epsilon_helper_(bool do_mult, const enum objs_agree_t agree,
+                const int * restrict minmax, dimension_t dim,
+                const double * restrict points_a, size_t size_a,
+                const double * restrict points_b, size_t size_b)
+{
+    ASSUME(2 <= dim);
+    ASSUME(size_a > 0 && size_b > 0);
+    ASSUME(agree == AGREE_MINIMISE || agree == AGREE_MAXIMISE || agree == AGREE_NONE);
+    assert((agree == AGREE_NONE) == (minmax != NULL));
+
+    const double epsilon = do_mult ? 0 : -INFINITY;
+    if (epsilon_use_kdtree(dim, size_a, size_b)) {
+        kdtree_t * tree = kdtree_new(points_a, size_a, dim);
+        double value = epsilon_kdtree_(do_mult, agree, minmax, tree, points_b, size_b,
+                                       epsilon, INFINITY);
+        kdtree_free(tree);
+        return value;
+    }
+    return epsilon_brute_(do_mult, agree, minmax, dim, points_a, size_a,
+                          points_b, size_b, epsilon, INFINITY);
+}
+
 #undef eps_value_
 #undef eps_value_minmax_
 #undef eps_value_agree_
+#undef eps_bound_agree_
 
 _attr_optimize_finite_math
 static inline double
@@ -216,6 +341,86 @@ epsilon_mult(const double * restrict data, size_t n, dimension_t dim,
     return value;
 }
 
+/******************************************************************************
+ Prepared reference set.
+
+ Keeps a copy of the reference set together with the objectives to minimise or
+ maximise, so that computing the epsilon indicator of many sets with respect
+ to the same reference set does not repeat the conversion and checks of the
+ reference set.
+******************************************************************************/
+
+typedef struct {
+    dimension_t dim;
+    size_t size;
+    int * minmax;
+    enum objs_agree_t agree;
+    double * points;
+    bool all_positive; // Whether the multiplicative indicator can be computed.
+} epsilon_refset_t;
+
+_attr_maybe_unused static epsilon_refset_t *
+epsilon_refset_new(const double * restrict ref, size_t ref_size, dimension_t dim,
+                   const boolvec * restrict maximise)
+{
+    ASSUME(dim >= 2);
+    ASSUME(ref_size > 0);
+    epsilon_refset_t * rs = MOOCORE_MALLOC(1, epsilon_refset_t);
+    rs->dim = dim;
+    rs->size = ref_size;
+    rs->minmax = minmax_from_boolvec(maximise, dim);
+    rs->agree = check_all_minimize_maximize(rs->minmax, dim);
+    rs->points = MOOCORE_MALLOC(ref_size * dim, double);
+    memcpy(rs->points, ref, ref_size * dim * sizeof(*ref));
+    rs->all_positive = all_positive(ref, ref_size, dim);
+    return rs;
+}
+
+_attr_maybe_unused static void
+epsilon_refset_free(epsilon_refset_t * rs)
+{
+    if (rs == NULL) return;
+    free(rs->points);
+    free(rs->minmax);
+    free(rs);
+}
+
+_attr_maybe_unused static double
+epsilon_additive_refset(const epsilon_refset_t * restrict rs,
+                        const double * restrict data, size_t n)
+{
+    const dimension_t dim = rs->dim;
+    switch (rs->agree) {
+      case AGREE_MINIMISE:
+          return epsilon_addi_agree_min(dim, data, n, rs->points, rs->size);
+      case AGREE_MAXIMISE:
+          return epsilon_addi_agree_max(dim, data, n, rs->points, rs->size);
+      default:
+          return epsilon_addi_agree_none(rs->minmax, dim, data, n, rs->points, rs->size);
+    }
+}
+
+_attr_maybe_unused static double
+epsilon_mult_refset(const epsilon_refset_t * restrict rs,
+                    const double * restrict data, size_t n)
+{
+    const dimension_t dim = rs->dim;
+#if DEBUG >= 1
+    if (!rs->all_positive || !all_positive(data, n, dim)) {
+        errprintf("cannot calculate multiplicative epsilon indicator with values <= 0.");
+        return INFINITY;
+    }
+#endif
+    switch (rs->agree) {
+      case AGREE_MINIMISE:
+          return epsilon_mult_agree_min(dim, data, n, rs->points, rs->size);
+      case AGREE_MAXIMISE:
+          return epsilon_mult_agree_max(dim, data, n, rs->points, rs->size);
+      default:
+          return epsilon_mult_agree_none(rs->minmax, dim, data, n, rs->points, rs->size);
+    }
+}
+
 /* FIXME: this can be done much faster. For example, the diff needs to
    be calculated just once and stored on a temporary array diff[].  */
 static inline int
@@ -238,4 +443,247 @@ epsilon_additive_ind(const int * restrict minmax, dimension_t dim,
         return 0;
 }
 
+/******************************************************************************
+ Pairwise matrices.
+
+ Set k is given by rows cumsizes[k-1], ..., cumsizes[k] - 1 of data (with
+ cumsizes[-1] == 0) and must not be empty.  Each value is the same as computed
+ by the functions above for a single pair of sets, but the objectives are
+ checked once and the k-d tree and bounding box of each set are built once
+ for all pairs.  The bounding box of A and the best value of each objective in
+ B give a lower bound of the epsilon value of A with respect to B, which is
+ used to start the search, so that points of B that cannot exceed it are
+ skipped.  Pairs are computed in parallel when compiled with OpenMP.
+******************************************************************************/
+
+typedef struct {
+    const double * points;
+    size_t size;
+    kdtree_t * tree; // NULL if the set is too small.
+    double * bounds; // dim lower bounds followed by dim upper bounds.
+    double * ideal;  // Best value of each objective.
+} epsilon_set_t;
+
+static inline epsilon_set_t *
+epsilon_sets_new(const enum objs_agree_t agree, const int * restrict minmax,
+                 dimension_t dim, const double * restrict data,
+                 const size_t * restrict cumsizes, size_t nsets)
+{
+    epsilon_set_t * sets = MOOCORE_MALLOC(nsets, epsilon_set_t);
+    double * bounds = MOOCORE_MALLOC(nsets * 3 * dim, double);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t k = 0; k < nsets; k++) {
+        const size_t start = (k == 0) ? 0 : cumsizes[k - 1];
+        assert(start < cumsizes[k]);
+        epsilon_set_t * set = sets + k;
+        set->points = data + start * dim;
+        set->size = cumsizes[k] - start;
+        // Build the tree if any other set is large enough to use it.
+        set->tree = epsilon_use_kdtree(dim, set->size, SIZE_MAX)
+            ? kdtree_new(set->points, set->size, dim) : NULL;
+        double * restrict lo = bounds + k * 3 * dim;
+        double * restrict hi = lo + dim;
+        double * restrict ideal = hi + dim;
+        memcpy(lo, set->points, dim * sizeof(*lo));
+        memcpy(hi, set->points, dim * sizeof(*hi));
+        for (size_t i = 1; i < set->size; i++) {
+            const double * restrict p = set->points + i * dim;
+            for (dimension_t d = 0; d < dim; d++) {
+                lo[d] = MIN(lo[d], p[d]);
+                hi[d] = MAX(hi[d], p[d]);
+            }
+        }
+        for (dimension_t d = 0; d < dim; d++)
+            ideal[d] = (agree == AGREE_MAXIMISE || (minmax && minmax[d] > 0))
+                ? hi[d] : lo[d];
+        set->bounds = lo;
+        set->ideal = ideal;
+    }
+    return sets;
+}
+
+static inline void
+epsilon_sets_free(epsilon_set_t * sets, size_t nsets)
+{
+    for (size_t k = 0; k < nsets; k++)
+        kdtree_free(sets[k].tree);
+    free(sets[0].bounds);
+    free(sets);
+}
+
+/* Epsilon value of set a with respect to set b or, as soon as it exceeds
+   limit, a value larger than limit.  */
+_attr_optimize_finite_math
+static inline double
+epsilon_pair_(bool do_mult, const enum objs_agree_t agree,
+              const int * restrict minmax, dimension_t dim,
+              const epsilon_set_t * restrict a, const epsilon_set_t * restrict b,
+              double limit)
+{
+    const double lower = epsilon_box_bound_(do_mult, agree, minmax, dim,
+                                            a->bounds, b->ideal);
+    if (lower > limit)
+        return lower;
+    if (a->tree != NULL && epsilon_use_kdtree(dim, a->size, b->size))
+        return epsilon_kdtree_(do_mult, agree, minmax, a->tree, b->points, b->size,
+                               lower, limit);
+    return epsilon_brute_(do_mult, agree, minmax, dim, a->points, a->size,
+                          b->points, b->size, lower, limit);
+}
+
+_attr_optimize_finite_math
+static void
+epsilon_matrix_(double * restrict result, bool do_mult,
+                const enum objs_agree_t agree, const int * restrict minmax,
+                dimension_t dim, const double * restrict data,
+                const size_t * restrict cumsizes, size_t nsets)
+{
+    epsilon_set_t * sets = epsilon_sets_new(agree, minmax, dim, data, cumsizes, nsets);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t p = 0; p < nsets * nsets; p++) {
+        const size_t i = p / nsets, j = p % nsets;
+        // The value of a set with respect to itself is exactly 0 (or 1).
+        result[p] = (i == j) ? (do_mult ? 1 : 0)
+            : epsilon_pair_(do_mult, agree, minmax, dim, sets + i, sets + j, INFINITY);
+    }
+    epsilon_sets_free(sets, nsets);
+}
+
+/* Weakly[p] is true if set p / nsets weakly dominates set p % nsets, that is,
+   if its additive epsilon value is not larger than zero.  Distinct sets in
+   the same group are not compared.  */
+_attr_optimize_finite_math
+static void
+weakly_dominates_matrix_(bool * restrict weakly, const int * restrict group,
+                         const enum objs_agree_t agree, const int * restrict minmax,
+                         dimension_t dim, const double * restrict data,
+                         const size_t * restrict cumsizes, size_t nsets)
+{
+    epsilon_set_t * sets = epsilon_sets_new(agree, minmax, dim, data, cumsizes, nsets);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t p = 0; p < nsets * nsets; p++) {
+        const size_t i = p / nsets, j = p % nsets;
+        weakly[p] = (i == j)
+            || ((group == NULL || group[i] != group[j])
+                && epsilon_pair_(/* do_mult=*/false, agree, minmax, dim,
+                                 sets + i, sets + j, /* limit=*/0) <= 0);
+    }
+    epsilon_sets_free(sets, nsets);
+}
+
+// This forces the compiler to generate three specialized versions of the function.
+#define epsilon_matrix_agree_(FUN, ...)                                        \
+    switch (check_all_minimize_maximize(minmax, dim)) {                        \
+      case AGREE_MINIMISE:                                                     \
+          FUN(__VA_ARGS__, AGREE_MINIMISE, NULL, dim, data, cumsizes, nsets);  \
+          break;                                                               \
+      case AGREE_MAXIMISE:                                                     \
+          FUN(__VA_ARGS__, AGREE_MAXIMISE, NULL, dim, data, cumsizes, nsets);  \
+          break;                                                               \
+      default:                                                                 \
+          FUN(__VA_ARGS__, AGREE_NONE, minmax, dim, data, cumsizes, nsets);    \
+    }
+
+/* result[i * nsets + j] is the additive epsilon value of set i with respect to
+   set j.  */
+_attr_maybe_unused static void
+epsilon_additive_matrix_minmax(double * restrict result, const int * restrict minmax,
+                               dimension_t dim, const double * restrict data,
+                               const size_t * restrict cumsizes, size_t nsets)
+{
+    ASSUME(dim >= 2);
+    if (nsets == 0) return;
+    epsilon_matrix_agree_(epsilon_matrix_, result, /* do_mult=*/false);
+}
+
+/* result[i * nsets + j] is the multiplicative epsilon value of set i with
+   respect to set j.  */
+_attr_maybe_unused static void
+epsilon_mult_matrix_minmax(double * restrict result, const int * restrict minmax,
+                           dimension_t dim, const double * restrict data,
+                           const size_t * restrict cumsizes, size_t nsets)
+{
+    ASSUME(dim >= 2);
+    if (nsets == 0) return;
+#if DEBUG >= 1
+    if (!all_positive(data, cumsizes[nsets - 1], dim)) {
+        errprintf("cannot calculate multiplicative epsilon indicator with values <= 0.");
+        for (size_t p = 0; p < nsets * nsets; p++)
+            result[p] = INFINITY;
+        return;
+    }
+#endif
+    epsilon_matrix_agree_(epsilon_matrix_, result, /* do_mult=*/true);
+}
+
+/* result[i * nsets + j] is -1 if set i is better than set j in terms of Pareto
+   dominance, 1 if set j is better than set i, and 0 otherwise, that is, the
+   value of epsilon_additive_ind() for each pair of sets.  If group is not NULL,
+   distinct sets i and j with group[i] == group[j] are not compared and their
+   value is 0.  */
+_attr_maybe_unused static void
+set_dominance_matrix_group_minmax(int * restrict result, const int * restrict group,
+                                  const int * restrict minmax,
+                                  dimension_t dim, const double * restrict data,
+                                  const size_t * restrict cumsizes, size_t nsets)
+{
+    ASSUME(dim >= 2);
+    if (nsets == 0) return;
+    bool * weakly = MOOCORE_MALLOC(nsets * nsets, bool);
+    epsilon_matrix_agree_(weakly_dominates_matrix_, weakly, group);
+    for (size_t i = 0; i < nsets; i++) {
+        for (size_t j = 0; j < nsets; j++) {
+            bool ij = weakly[i * nsets + j], ji = weakly[j * nsets + i];
+            result[i * nsets + j] = (ij && !ji) ? -1 : ((!ij && ji) ? 1 : 0);
+        }
+    }
+    free(weakly);
+}
+#undef epsilon_matrix_agree_
+
+_attr_maybe_unused static void
+set_dominance_matrix_minmax(int * restrict result, const int * restrict minmax,
+                            dimension_t dim, const double * restrict data,
+                            const size_t * restrict cumsizes, size_t nsets)
+{
+    set_dominance_matrix_group_minmax(result, /* group=*/NULL, minmax, dim, data,
+                                      cumsizes, nsets);
+}
+
+_attr_maybe_unused static void
+epsilon_additive_matrix(double * restrict result, const double * restrict data,
+                        dimension_t dim, const size_t * restrict cumsizes,
+                        size_t nsets, const boolvec * restrict maximise)
+{
+    const int * minmax = minmax_from_boolvec(maximise, dim);
+    epsilon_additive_matrix_minmax(result, minmax, dim, data, cumsizes, nsets);
+    free ((void *)minmax);
+}
+
+_attr_maybe_unused static void
+epsilon_mult_matrix(double * restrict result, const double * restrict data,
+                    dimension_t dim, const size_t * restrict cumsizes,
+                    size_t nsets, const boolvec * restrict maximise)
+{
+    const int * minmax = minmax_from_boolvec(maximise, dim);
+    epsilon_mult_matrix_minmax(result, minmax, dim, data, cumsizes, nsets);
+    free ((void *)minmax);
+}
+
+_attr_maybe_unused static void
+set_dominance_matrix(int * restrict result, const double * restrict data,
+                     dimension_t dim, const size_t * restrict cumsizes,
+                     size_t nsets, const boolvec * restrict maximise)
+{
+    const int * minmax = minmax_from_boolvec(maximise, dim);
+    set_dominance_matrix_minmax(result, minmax, dim, data, cumsizes, nsets);
+    free ((void *)minmax);
+}
+
 #endif /* EPSILON_H */
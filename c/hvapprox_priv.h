@@ -0,0 +1,152 @@
+#ifndef MOOCORE_HVAPPROX_PRIV_H_
+#define MOOCORE_HVAPPROX_PRIV_H_
+
+/* Low-discrepancy point sets shared by hvapprox.c and r2_approx.c.  Both
+   generate points u in [0,1)^dim that are later mapped to directions (for the
+   hypervolume) or to weight vectors (for the R2 indicator).  */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include "common.h"
+
+#ifndef M_PIl
+# define M_PIl		3.141592653589793238462643383279502884L /* pi */
+#endif
+
+// Returns fractional part. Equivalent to modfl(x, &dummy) but slightly faster.
+_attr_const_func
+static inline long double fractl(long double x) { return x - truncl(x); }
+
+/* Hua-Wang good lattice points (Korobov-type).  */
+static inline uint_fast32_t *
+construct_polar_a(dimension_t dim, uint_fast32_t nsamples)
+{
+    ASSUME(1 <= dim && dim <= MOOCORE_HVAPPROX_DIMENSION_MAX);
+    // Step 1: find prime p such that dim <= eularfunction(p)/2 == (p-1)/2
+    static const dimension_t primes [] = {
+        1,  3,  5,  7, 11, 11, 13, 17, 17, 19,
+        23, 23, 29, 29, 29, 31, 37, 37, 37, 41,
+        41, 43, 47, 47, 53, 53, 53, 59, 59, 59,
+        61, 67, 67 };
+
+    const dimension_t p = primes[dim];
+    DEBUG2_PRINT("construct_polar_a: prime: %d\n", p);
+
+    uint_fast32_t * a = malloc(dim * sizeof(*a));
+    a[0] = 1;
+    DEBUG2_PRINT("construct_polar_a: a[%d] = %lu", dim, (unsigned long) a[0]);
+    for (dimension_t k = 1; k < dim; k++) {
+        long double temp = fabsl(2 * cosl(2 * M_PIl * k / p));
+        temp = fractl(temp);
+        a[k] = STATIC_CAST(uint_fast32_t, llroundl(nsamples * temp));
+        DEBUG2_PRINT(", %lu", (unsigned long) a[k]);
+    }
+    DEBUG2_PRINT("\n");
+    return a;
+}
+
+static inline void
+compute_polar_sample(long double * restrict sample, dimension_t dim,
+                     uint_fast32_t i, uint_fast32_t nsamples,
+                     const uint_fast32_t * restrict a)
+{
+    ASSUME(i + 1 <= nsamples);
+    if (i + 1 < nsamples) {
+        long double factor = (i+1) / STATIC_CAST(long double, nsamples);
+        for (dimension_t k = 0; k < dim; k++) {
+            long double val = factor * a[k];
+            sample[k] = fractl(val);
+        }
+    } else { // Last point is always 0.
+        for (dimension_t k = 0; k < dim; k++)
+            sample[k] = 0.0;
+    }
+}
+
+/* R_phi (generalised golden ratio) sequence.  */
+static inline long double *
+Rphi_init(dimension_t dim)
+{
+    ASSUME(1 <= dim && dim <= MOOCORE_HVAPPROX_DIMENSION_MAX);
+    // Generated by rphi_seq.py
+    static const long double recip_phi_d[] = {
+        0x1.3c6ef372fe94f82be73980c0b9db9068p-1L, // d = 1, value = 0.6180339887498949
+        0x1.827f5352054c651e869fee365b2ee496p-1L, // d = 2, value = 0.7548776662466927
+        0x1.a36a9465a325da073fb954fadd3bfc1ep-1L, // d = 3, value = 0.8191725133961645
+        0x1.b69e1722eb5c42ca89cf1feab545b792p-1L, // d = 4, value = 0.8566748838545029
+        0x1.c33603553a858c666b0ed20913d97206p-1L, // d = 5, value = 0.8812714616335696
+        0x1.cc1c56e456a75dd75bdfb98e3acc2a36p-1L, // d = 6, value = 0.8986537126286993
+        0x1.d2bc3ba2fa6b001b3da7836af99d4a46p-1L, // d = 7, value = 0.9115923534820549
+        0x1.d7dbddb3b007902ac66a769dcced40e8p-1L, // d = 8, value = 0.921599319633983
+        0x1.dbf09da830ac4b5b78a071d357d8f69p-1L, // d = 9, value = 0.9295701282320229
+        0x1.df447355bfe101fe8e061906ef910892p-1L, // d = 10, value = 0.9360691110777584
+        0x1.e2084e4125eaf8bad4252c318d09f94p-1L, // d = 11, value = 0.9414696173216353
+        0x1.e45dd9ec23b286dcd71a526afbf60b0cp-1L, // d = 12, value = 0.9460285282856136
+        0x1.e65d03e6c54d3fb86d0f3719cc312b34p-1L, // d = 13, value = 0.9499283999636199
+        0x1.e817452aaafd610e9fb913ef9fd3d1f6p-1L, // d = 14, value = 0.9533025374016642
+        0x1.e999ac4fac81923526609aa9500c8714p-1L, // d = 15, value = 0.956250557637989
+        0x1.eaee2d784c7a2a12c3f8fb9f3e0c845ap-1L, // d = 16, value = 0.9588484010075614
+        0x1.ec1c812639bb4fcaf0c77ea1b928ce8p-1L, // d = 17, value = 0.9611549719964986
+        0x1.ed2abc080172300d8c99d6b7243efe06p-1L, // d = 18, value = 0.9632166633389015
+        0x1.ee1db8d5714f2db5cac4578507e8ea5ap-1L, // d = 19, value = 0.9650705109167163
+        0x1.eef963ac826a7c42c01de9f69371432p-1L, // d = 20, value = 0.9667464397509393
+        0x1.efc0f0b70647ebf090e01491ac5f7e7ep-1L, // d = 21, value = 0.9682688926142332
+        0x1.f0770473779aa3295949acf33d7863dp-1L, // d = 22, value = 0.9696580306006599
+        0x1.f11dd1d928f6e36afbb5b7bfaa5051cp-1L, // d = 23, value = 0.9709306314075385
+        0x1.f1b73133ed1bbcb86ce969d55f87f296p-1L, // d = 24, value = 0.9721007705580216
+        0x1.f244b1b08b20119afb70f95f23ee065ap-1L, // d = 25, value = 0.9731803443915511
+        0x1.f2c7a6fc9f4badc4ce6165ec81c87cap-1L, // d = 26, value = 0.9741794761063355
+        0x1.f34133f695ffb8b5ffd1bd93c5c298d2p-1L, // d = 27, value = 0.9751068342693539
+        0x1.f3b253244f82923c4b970872f0f7dfeap-1L, // d = 28, value = 0.9759698850464292
+        0x1.f41bdd76057468dfbf6d17f30fb8b3b6p-1L, // d = 29, value = 0.97677509370508
+        0x1.f47e8fb85ff198ad0ba7200a8f43f12cp-1L, // d = 30, value = 0.9775280869070884
+        0x1.f4db0effcb296f3423b8035a7f4efee8p-1L, // d = 31, value = 0.9782337844131516
+    };
+
+    long double * alpha = malloc(sizeof(*alpha) * dim);
+    alpha[0] = recip_phi_d[dim - 1];
+    for (dimension_t d = 1; d < dim; d++)
+        alpha[d] = alpha[d-1] * recip_phi_d[dim - 1]; // Same as pow(recip_phi_d[dim - 1], d)
+    return alpha;
+}
+
+static inline void
+Rphi_next(double * restrict u, dimension_t dim, const long double * restrict alpha)
+{
+    ASSUME(1 <= dim);
+    for (dimension_t d = 0; d < dim; d++) {
+        u[d] = STATIC_CAST(double, fractl(u[d] + alpha[d]));
+    }
+
+    /* The above is equivalent to the non-recurrent version, where i=(0,1,...,n):
+
+    const long double ip1 = i+1;
+    const long double seed = 0.0;
+    for (dimension_t d = 0; d < dim; d++)
+        dest[d] = STATIC_CAST(double, fractl(ip1 * alpha[d] + seed));
+    */
+
+    /* When a and n are integers and n > 0, then fract(a / 2^n) = r / 2^n,
+       where r is the remainder from dividing a by 2^n. In addition, we can
+       compute r = a & (2^n - 1), so fract(a / 2^n) = a & (2^n - 1).
+
+       Then, if a = (u + alpha)*2^n, then:
+
+          frac(u + alpha) = ((u + alpha)*2^n) & (2^n - 1)) / 2^n
+
+       For example, with n=64:
+
+         uint64_t ui = (uint64_t)(u[d] * exp2(64));
+         uint64_t alphai = (uint64_t)((double)alpha[d] * exp2(64));
+         ui = (uint64_t)(ui + alphai) & ((uint64_t)-1);
+         u[d] = ((double)ui) * exp2(-64);
+
+       If you need integers, and assuming u[d] is initialized with an integer,
+       the above simplifies to:
+
+         u[d] = (uint64_t)(u[d] + alphai) & ((uint64_t)-1);
+    */
+}
+
+#endif // MOOCORE_HVAPPROX_PRIV_H_
@@ -65,6 +65,7 @@ static bool gdp = false;
 static bool igdp = false;
 static bool igdplus = false;
 static bool hausdorff = false;
+static dist_norm_t norm = DIST_NORM_L2;
 
 static const char *suffix = NULL;
 static void usage(void)
@@ -91,6 +92,8 @@ OPTION_QUIET_STR
 "   , --hausdorff     report avg Hausdorff distance = max (GD_p, IGD_p)\n"
 " -a, --all           compute everything\n"
 " -p,                 exponent that averages the distances\n"
+"   , --norm=[1|2|inf] norm used to measure distances: taxicab (1),\n"
+"                      Euclidean (2, default) or Chebyshev (inf)\n"
 " -r, --reference FILE file that contains the reference set                  \n"
 OPTION_OBJ_STR
 OPTION_MAXIMISE_STR
@@ -119,11 +122,13 @@ do_file(const char * filename, double * restrict reference, size_t reference_siz
     FILE * outfile = fopen_outfile(&outfilename, filename, suffix);
     // Default minmax if not set yet.
     bool free_minmax = minmax_alloc(&minmax, maximise_all_flag, nobj);
+    gd_refset_t * refset = gd_refset_new_minmax(reference, reference_size, minmax, nobj, norm);
 
     const char * sep = "\0";
     if (verbose_flag) {
         printf("# file: %s\n", filename);
-        printf("# metrics (Euclidean distance) ");
+        printf("# metrics (%s distance) ", (norm == DIST_NORM_L1) ? "taxicab"
+               : (norm == DIST_NORM_LINF) ? "Chebyshev" : "Euclidean");
         /* This macro uses ## for comma elision in variadic macros. It should
            use __VA_OPT__ in the future when more compilers support it:
            https://gcc.gnu.org/onlinedocs/cpp/Variadic-Macros.html */
@@ -160,17 +165,17 @@ do_file(const char * filename, double * restrict reference, size_t reference_siz
         do {                                                                   \
             if (IF) {                                                          \
                 fprintf (outfile, "%s" indicator_printf_format, sep,           \
-                         FUN(minmax, nobj, points_a, size_a, reference, reference_size, ## __VA_ARGS__)); \
+                         FUN(refset, points_a, size_a, ## __VA_ARGS__)); \
                 sep = "\t";                                                    \
             }                                                                  \
         } while (0)
 
-        print_value_if(gd, GD_minmax);
-        print_value_if(igd, IGD_minmax);
-        print_value_if(gdp, GD_p, exponent_p);
-        print_value_if(igdp, IGD_p, exponent_p);
-        print_value_if(igdplus, IGD_plus_minmax);
-        print_value_if(hausdorff, avg_Hausdorff_dist_minmax, exponent_p);
+        print_value_if(gd, GD_refset);
+        print_value_if(igd, IGD_refset);
+        print_value_if(gdp, GD_p_refset, exponent_p);
+        print_value_if(igdp, IGD_p_refset, exponent_p);
+        print_value_if(igdplus, IGD_plus_refset);
+        print_value_if(hausdorff, avg_Hausdorff_dist_refset, exponent_p);
 #undef print_value_if
 #if defined(__clang__)
 #  pragma clang diagnostic pop
@@ -183,6 +188,7 @@ do_file(const char * filename, double * restrict reference, size_t reference_siz
     }
 
     fclose_outfile(outfile, filename, outfilename, verbose_flag);
+    gd_refset_free(refset);
     free(data);
     free(cumsizes);
     if (free_minmax) free((void *) minmax);
@@ -190,7 +196,7 @@ do_file(const char * filename, double * restrict reference, size_t reference_siz
 
 int main(int argc, char *argv[])
 {
-    enum { GD_opt = 1000, IGD_opt, GD_p_opt, IGD_p_opt, IGD_plus_opt, hausdorff_opt};
+    enum { GD_opt = 1000, IGD_opt, GD_p_opt, IGD_p_opt, IGD_plus_opt, hausdorff_opt, norm_opt};
 
     // See the man page for getopt_long for an explanation of these fields.
     static const char short_options[] = "hVvqap:Mr:s:o:";
@@ -209,6 +215,7 @@ int main(int argc, char *argv[])
         {"hausdorff",  no_argument,       NULL, hausdorff_opt},
         {"all",        no_argument,       NULL, 'a'},
         {"exponent-p", required_argument, NULL, 'p'},
+        {"norm",       required_argument, NULL, norm_opt},
         {"maximise",   no_argument,       NULL, 'M'},
         {"maximize",   no_argument,       NULL, 'M'},
         {"reference",  required_argument, NULL, 'r'},
@@ -274,6 +281,17 @@ int main(int argc, char *argv[])
               hausdorff = true;
               break;
 
+          case norm_opt:
+              if (strcmp(optarg, "1") == 0)
+                  norm = DIST_NORM_L1;
+              else if (strcmp(optarg, "2") == 0)
+                  norm = DIST_NORM_L2;
+              else if (strcmp(optarg, "inf") == 0 || strcmp(optarg, "Inf") == 0)
+                  norm = DIST_NORM_LINF;
+              else
+                  fatal_error("invalid argument '%s' for --norm, it should be 1, 2 or inf", optarg);
+              break;
+
         case 'M': // --maximise
             maximise_all_flag = true;
             break;
@@ -320,7 +338,7 @@ int main(int argc, char *argv[])
         size_t prev_reference_size = reference_size;
         reference_size = filter_dominated_set(reference, reference_size, (dimension_t)nobj, minmax);
         if (prev_reference_size > reference_size)
-            warnprintf("removed %zd dominated points from the reference set",
+            warnprintf("removed %zu dominated points from the reference set",
                        prev_reference_size - reference_size);
     }
 
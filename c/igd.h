@@ -9,8 +9,9 @@
  were proposed in [4] and they change how the numerator is computed. This has a
  significant effect for GD and less so for IGD given a constant reference
  set. IGD+ was proposed in [5] and changes how to compute the distances. In
- general, norm=2 (Euclidean distance), but other norms are possible [4]. See
- [6] for a comparison.
+ general, norm=2 (Euclidean distance), but other norms are possible [4]: the
+ taxicab (L1) and Chebyshev (L-infinity) norms are also implemented (see
+ dist_norm_t).  See [6] for a comparison.
 
  [1] D. A. Van Veldhuizen and G. B. Lamont. Evolutionary Computation and
      Convergence to a Pareto Front. In J. R. Koza, editor, Late Breaking Papers
@@ -52,18 +53,85 @@
 #include "common.h"
 #include "pow_int.h"
 #include "nondominated.h" // minmax_from_bool
+#include "kdtree.h"
 
 #ifndef INFINITY
 #define INFINITY (HUGE_VAL)
 #endif
 
+/* Use a k-d tree over the set searched for the nearest point when it has at
+   least gd_kdtree_min_size[dim] points, which is roughly where the tree
+   becomes faster than brute force for points close to a front.  With more
+   than GD_KDTREE_DIM_MAX objectives, the tree does not prune enough.  */
+#define GD_KDTREE_DIM_MAX 11
+static const size_t gd_kdtree_min_size[GD_KDTREE_DIM_MAX + 1] = {
+    SIZE_MAX, 32, 32, 64, 128, 128, 128, 256, 1024, 2048, 4096, 8192 };
+
+/* Use gd_common_tiled() instead of gd_common_helper_() when computing at least
+   this many distances.  */
+#ifndef GD_TILED_MIN_WORK
+#define GD_TILED_MIN_WORK (1 << 14)
+#endif
+
+/* Do not start threads to compute the nearest point of fewer points.  */
+#ifndef GD_PARALLEL_MIN_SIZE
+#define GD_PARALLEL_MIN_SIZE 64
+#endif
+
+static inline bool
+gd_use_kdtree(dimension_t dim, size_t size)
+{
+    return dim <= GD_KDTREE_DIM_MAX && size >= gd_kdtree_min_size[dim];
+}
+
+// From the distance (squared if Euclidean) to d^p.
+static inline double
+gd_dist_pow(double dist, uint_fast8_t p, dist_norm_t norm)
+{
+    if (norm != DIST_NORM_L2)
+        return (p == 1) ? dist : pow_uint(dist, p);
+    if (p == 1)
+        return sqrt(dist);
+    else if (p % 2 == 0)
+        return pow_uint(dist, p/2);
+    else
+        return pow_uint(sqrt(dist), p);
+}
+
+/* Sum d^p over the distances in order, so the result does not depend on how
+   they were computed.  Zero distances are skipped as in gd_common_helper_().  */
+static inline double
+gd_sum_min_dist(const double * restrict min_dist, size_t size, uint_fast8_t p,
+                dist_norm_t norm)
+{
+    double gd = 0;
+    for (size_t a = 0; a < size; a++) {
+        if (unlikely(min_dist[a] == 0))
+            continue;
+        gd += gd_dist_pow(min_dist[a], p, norm);
+    }
+    return gd;
+}
+
+static inline double
+gd_finish(double gd, size_t size_a, bool psize, uint_fast8_t p)
+{
+    ASSUME(gd >= 0);
+    if (p == 1)
+        return gd / (double) size_a;
+    else if (psize)
+        return (double) powl(gd / (double) size_a, 1.0 / p);
+    else
+        return (double) powl(gd, 1.0 / p) / (double) size_a;
+}
+
 _attr_optimize_finite_math
 static inline double
 gd_common_helper_(const enum objs_agree_t agree,
                   const int * restrict minmax, dimension_t dim,
                   const double * restrict points_a, size_t size_a,
                   const double * restrict points_r, size_t size_r,
-                  bool plus, bool psize, uint_fast8_t p)
+                  bool plus, bool psize, uint_fast8_t p, dist_norm_t norm)
 {
     ASSUME(2 <= dim);
     if (size_a == 0) return INFINITY;
@@ -79,7 +147,6 @@ gd_common_helper_(const enum objs_agree_t agree,
         for (size_t r = 0; r < size_r; r++) {
             double diff[MOOCORE_DIMENSION_MAX + 1];
             const double * restrict pr = points_r + r * dim;
-            // TODO: Implement taxicab and infinity norms
             for (dimension_t d = 0; d < dim; d++) {
                 double a_d = pa[d];
                 double r_d = pr[d];
@@ -93,7 +160,7 @@ gd_common_helper_(const enum objs_agree_t agree,
             }
             double dist = 0.0;
             for (dimension_t d = 0; d < dim; d++)
-                dist += diff[d] * diff[d];
+                dist = dist_norm_add(norm, dist, diff[d]);
 
             if (unlikely(dist == 0))
                 goto zero_skip;
@@ -103,24 +170,131 @@ gd_common_helper_(const enum objs_agree_t agree,
         }
         ASSUME(min_dist > 0);
         // Here we calculate the actual Euclidean distance.
-        if (p == 1)
-            min_dist = sqrt(min_dist);
-        else if (p % 2 == 0)
-            min_dist = pow_uint(min_dist, p/2);
-        else
-            min_dist = pow_uint(sqrt(min_dist), p);
-        gd += min_dist;
+        gd += gd_dist_pow(min_dist, p, norm);
     zero_skip:
         (void)0;
     }
-    ASSUME(gd >= 0);
+    return gd_finish(gd, size_a, psize, p);
+}
 
-    if (p == 1)
-        return gd / (double) size_a;
-    else if (psize)
-        return (double) powl(gd / (double) size_a, 1.0 / p);
-    else
-        return (double) powl(gd, 1.0 / p) / (double) size_a;
+/* Same as gd_common_helper_() with AGREE_MINIMISE, but points_r is given as
+   a k-d tree.  */
+_attr_optimize_finite_math
+static inline double
+gd_common_kdtree(dimension_t dim,
+                 const double * restrict points_a, size_t size_a,
+                 const kdtree_t * restrict tree_r,
+                 bool plus, bool psize, uint_fast8_t p, dist_norm_t norm)
+{
+    if (size_a == 0) return INFINITY;
+    double * min_dist = MOOCORE_MALLOC(size_a, double);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) if (size_a >= GD_PARALLEL_MIN_SIZE)
+#endif
+    for (size_t a = 0; a < size_a; a++)
+        min_dist[a] = kdtree_nearest_dist(tree_r, points_a + a * dim, plus, norm);
+    double gd = gd_sum_min_dist(min_dist, size_a, p, norm);
+    free(min_dist);
+    return gd_finish(gd, size_a, psize, p);
+}
+
+/* Same as gd_common_agree_min(), but blocked for large inputs.  points_r is
+   copied by columns (structure of arrays), so that the distances from a block
+   of GD_BLOCK_A points of points_a to a tile of GD_TILE_R points of points_r
+   are computed by loops that vectorize and reuse each column load.  Each
+   block of points_a may run in a different thread.  */
+#define GD_BLOCK_A 4
+#define GD_TILE_R 256
+
+_attr_optimize_finite_math
+static inline void
+gd_tile_dist(double dist[restrict GD_BLOCK_A][GD_TILE_R],
+             const double * restrict pa, size_t nblock, dimension_t dim,
+             const double * restrict cols, size_t stride, size_t len, bool plus,
+             const dist_norm_t norm)
+{
+    for (size_t i = 0; i < nblock; i++)
+        for (size_t j = 0; j < len; j++)
+            dist[i][j] = 0;
+    for (dimension_t d = 0; d < dim; d++) {
+        const double * restrict col = cols + d * stride;
+        for (size_t i = 0; i < nblock; i++) {
+            const double a_d = pa[i * dim + d];
+            double * restrict dist_i = dist[i];
+            // Same operations as gd_common_helper_().
+            if (plus) {
+                for (size_t j = 0; j < len; j++) {
+                    double diff = MAX(col[j] - a_d, 0.);
+                    dist_i[j] = dist_norm_add(norm, dist_i[j], diff);
+                }
+            } else {
+                for (size_t j = 0; j < len; j++) {
+                    double diff = a_d - col[j];
+                    dist_i[j] = dist_norm_add(norm, dist_i[j], diff);
+                }
+            }
+        }
+    }
+}
+
+_attr_optimize_finite_math
+static inline double
+gd_common_tiled(dimension_t dim,
+                const double * restrict points_a, size_t size_a,
+                const double * restrict points_r, size_t size_r,
+                bool plus, bool psize, uint_fast8_t p, dist_norm_t norm)
+{
+    if (size_a == 0) return INFINITY;
+    ASSUME(size_r > 0);
+    double * cols = MOOCORE_MALLOC(size_r * dim, double);
+    for (size_t r = 0; r < size_r; r++)
+        for (dimension_t d = 0; d < dim; d++)
+            cols[d * size_r + r] = points_r[r * dim + d];
+
+    double * min_dist = MOOCORE_MALLOC(size_a, double);
+    const size_t nblocks = (size_a + GD_BLOCK_A - 1) / GD_BLOCK_A;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (size_a >= GD_PARALLEL_MIN_SIZE)
+#endif
+    for (size_t b = 0; b < nblocks; b++) {
+        double dist[GD_BLOCK_A][GD_TILE_R];
+        const size_t a0 = b * GD_BLOCK_A;
+        const size_t nblock = MIN((size_t) GD_BLOCK_A, size_a - a0);
+        double * restrict best = min_dist + a0;
+        for (size_t i = 0; i < nblock; i++)
+            best[i] = INFINITY;
+        for (size_t r0 = 0; r0 < size_r; r0 += GD_TILE_R) {
+            const size_t len = MIN((size_t) GD_TILE_R, size_r - r0);
+            gd_tile_dist(dist, points_a + a0 * dim, nblock, dim, cols + r0,
+                         size_r, len, plus, norm);
+            bool all_zero = true;
+            for (size_t i = 0; i < nblock; i++) {
+                for (size_t j = 0; j < len; j++)
+                    best[i] = MIN(best[i], dist[i][j]);
+                all_zero &= (best[i] == 0);
+            }
+            if (all_zero)
+                break;
+        }
+    }
+    free(cols);
+    double gd = gd_sum_min_dist(min_dist, size_a, p, norm);
+    free(min_dist);
+    return gd_finish(gd, size_a, psize, p);
+}
+
+/* Copy of points transformed to minimisation.  Objectives that are ignored
+   (minmax[d] == 0) become zero.  */
+static inline double *
+gd_minimise_copy(const int * restrict minmax, dimension_t dim,
+                 const double * restrict points, size_t size)
+{
+    double * copy = MOOCORE_MALLOC(size * dim, double);
+    for (size_t i = 0; i < size; i++)
+        for (dimension_t d = 0; d < dim; d++)
+            copy[i * dim + d] = (minmax[d] < 0) ? points[i * dim + d]
+                : ((minmax[d] > 0) ? -points[i * dim + d] : 0);
+    return copy;
 }
 
 _attr_optimize_finite_math
@@ -128,9 +302,9 @@ static inline double
 gd_common_agree_none(const int * restrict minmax, dimension_t dim,
                     const double * restrict points_a, size_t size_a,
                     const double * restrict points_r, size_t size_r,
-                    bool plus, bool psize, uint_fast8_t p)
+                    bool plus, bool psize, uint_fast8_t p, dist_norm_t norm)
 {
-    return gd_common_helper_(AGREE_NONE, minmax, dim, points_a, size_a, points_r, size_r, plus, psize, p);
+    return gd_common_helper_(AGREE_NONE, minmax, dim, points_a, size_a, points_r, size_r, plus, psize, p, norm);
 }
 
 _attr_optimize_finite_math
@@ -138,9 +312,9 @@ static inline double
 gd_common_agree_min(dimension_t dim,
                     const double * restrict points_a, size_t size_a,
                     const double * restrict points_r, size_t size_r,
-                    bool plus, bool psize, uint_fast8_t p)
+                    bool plus, bool psize, uint_fast8_t p, dist_norm_t norm)
 {
-    return gd_common_helper_(AGREE_MINIMISE, /*minmax=*/NULL, dim, points_a, size_a, points_r, size_r, plus, psize, p);
+    return gd_common_helper_(AGREE_MINIMISE, /*minmax=*/NULL, dim, points_a, size_a, points_r, size_r, plus, psize, p, norm);
 }
 
 _attr_optimize_finite_math
@@ -148,26 +322,85 @@ static inline double
 gd_common_agree_max(dimension_t dim,
                     const double * restrict points_a, size_t size_a,
                     const double * restrict points_r, size_t size_r,
-                    bool plus, bool psize, uint_fast8_t p)
+                    bool plus, bool psize, uint_fast8_t p, dist_norm_t norm)
+{
+    return gd_common_helper_(AGREE_MAXIMISE, /*minmax=*/NULL, dim, points_a, size_a, points_r, size_r, plus, psize, p, norm);
+}
+
+static inline bool
+gd_use_tiled(size_t size_a, size_t size_r)
 {
-    return gd_common_helper_(AGREE_MAXIMISE, /*minmax=*/NULL, dim, points_a, size_a, points_r, size_r, plus, psize, p);
+    return size_a * size_r >= GD_TILED_MIN_WORK;
+}
+
+/* Same as gd_common_agree_min() but builds a k-d tree over points_r when it
+   is large enough, or uses gd_common_tiled() for large inputs.  */
+static inline double
+gd_common_min_maybe_kdtree(dimension_t dim,
+                           const double * restrict points_a, size_t size_a,
+                           const double * restrict points_r, size_t size_r,
+                           bool plus, bool psize, uint_fast8_t p, dist_norm_t norm)
+{
+    if (size_a == 0 || !gd_use_kdtree(dim, size_r)) {
+        if (size_a > 0 && gd_use_tiled(size_a, size_r))
+            return gd_common_tiled(dim, points_a, size_a, points_r, size_r, plus, psize, p, norm);
+        return gd_common_agree_min(dim, points_a, size_a, points_r, size_r, plus, psize, p, norm);
+    }
+    kdtree_t * tree = kdtree_new(points_r, size_r, dim);
+    double value = gd_common_kdtree(dim, points_a, size_a, tree, plus, psize, p, norm);
+    kdtree_free(tree);
+    return value;
 }
 
 _attr_optimize_finite_math
 static inline double
-gd_common(const int * restrict minmax, dimension_t dim,
-          const double * restrict points_a, size_t size_a,
-          const double * restrict points_r, size_t size_r,
-          bool plus, bool psize, uint_fast8_t p)
+gd_common_norm_(const int * restrict minmax, dimension_t dim,
+                const double * restrict points_a, size_t size_a,
+                const double * restrict points_r, size_t size_r,
+                bool plus, bool psize, uint_fast8_t p, const dist_norm_t norm)
 {
+    const enum objs_agree_t agree = check_all_minimize_maximize(minmax, dim);
+    if (size_a > 0 && (gd_use_kdtree(dim, size_r) || gd_use_tiled(size_a, size_r))) {
+        if (agree == AGREE_MINIMISE)
+            return gd_common_min_maybe_kdtree(dim, points_a, size_a, points_r, size_r,
+                                              plus, psize, p, norm);
+        double * a = gd_minimise_copy(minmax, dim, points_a, size_a);
+        double * r = gd_minimise_copy(minmax, dim, points_r, size_r);
+        double value = gd_common_min_maybe_kdtree(dim, a, size_a, r, size_r,
+                                                  plus, psize, p, norm);
+        free(a);
+        free(r);
+        return value;
+    }
     // This forces the compiler to generate three specialized versions of the function.
-    switch (check_all_minimize_maximize(minmax, dim)) {
+    switch (agree) {
       case AGREE_MINIMISE:
-          return gd_common_agree_min(dim, points_a, size_a, points_r, size_r, plus, psize, p);
+          return gd_common_agree_min(dim, points_a, size_a, points_r, size_r, plus, psize, p, norm);
       case AGREE_MAXIMISE:
-          return gd_common_agree_max(dim, points_a, size_a, points_r, size_r, plus, psize, p);
+          return gd_common_agree_max(dim, points_a, size_a, points_r, size_r, plus, psize, p, norm);
       default:
-          return gd_common_agree_none(minmax, dim, points_a, size_a, points_r, size_r, plus, psize, p);
+          return gd_common_agree_none(minmax, dim, points_a, size_a, points_r, size_r, plus, psize, p, norm);
+    }
+}
+
+_attr_optimize_finite_math
+static inline double
+gd_common(const int * restrict minmax, dimension_t dim,
+          const double * restrict points_a, size_t size_a,
+          const double * restrict points_r, size_t size_r,
+          bool plus, bool psize, uint_fast8_t p, dist_norm_t norm)
+{
+    // This forces the compiler to generate specialized versions for each norm.
+    switch (norm) {
+      case DIST_NORM_L1:
+          return gd_common_norm_(minmax, dim, points_a, size_a, points_r, size_r,
+                                 plus, psize, p, DIST_NORM_L1);
+      case DIST_NORM_LINF:
+          return gd_common_norm_(minmax, dim, points_a, size_a, points_r, size_r,
+                                 plus, psize, p, DIST_NORM_LINF);
+      default:
+          return gd_common_norm_(minmax, dim, points_a, size_a, points_r, size_r,
+                                 plus, psize, p, DIST_NORM_L2);
     }
 }
 
@@ -180,7 +413,7 @@ GD_minmax(const int * restrict minmax, dimension_t dim,
     return gd_common(minmax, dim,
                      points_a, size_a,
                      points_r, size_r,
-                     /*plus=*/false, /*psize=*/false, /*p=*/1);
+                     /*plus=*/false, /*psize=*/false, /*p=*/1, DIST_NORM_L2);
 }
 
 _attr_optimize_finite_math
@@ -192,20 +425,29 @@ IGD_minmax(const int * restrict minmax, dimension_t dim,
     return gd_common(minmax, dim,
                      points_r, size_r,
                      points_a, size_a,
-                     /*plus=*/false, /*psize=*/false, /*p=*/1);
+                     /*plus=*/false, /*psize=*/false, /*p=*/1, DIST_NORM_L2);
 }
 
 _attr_maybe_unused static double
-IGD(const double * restrict data, size_t npoints, dimension_t nobj,
-    const double * restrict ref, size_t ref_size,
-    const boolvec * restrict maximise)
+IGD_norm(const double * restrict data, size_t npoints, dimension_t nobj,
+         const double * restrict ref, size_t ref_size,
+         const boolvec * restrict maximise, dist_norm_t norm)
 {
     const int * minmax = minmax_from_boolvec(maximise, nobj);
-    double value = IGD_minmax(minmax, nobj, data, npoints, ref, ref_size);
+    double value = gd_common(minmax, nobj, ref, ref_size, data, npoints,
+                             /*plus=*/false, /*psize=*/false, /*p=*/1, norm);
     free ((void *)minmax);
     return value;
 }
 
+_attr_maybe_unused static double
+IGD(const double * restrict data, size_t npoints, dimension_t nobj,
+    const double * restrict ref, size_t ref_size,
+    const boolvec * restrict maximise)
+{
+    return IGD_norm(data, npoints, nobj, ref, ref_size, maximise, DIST_NORM_L2);
+}
+
 _attr_optimize_finite_math
 static inline double
 GD_p(const int * restrict minmax, dimension_t dim,
@@ -215,7 +457,7 @@ GD_p(const int * restrict minmax, dimension_t dim,
     return gd_common(minmax, dim,
                      points_a, size_a,
                      points_r, size_r,
-                     /*plus=*/false, /*psize=*/true, (uint_fast8_t)p);
+                     /*plus=*/false, /*psize=*/true, (uint_fast8_t)p, DIST_NORM_L2);
 }
 
 _attr_optimize_finite_math
@@ -227,7 +469,7 @@ IGD_p(const int * restrict minmax, dimension_t dim,
     return gd_common(minmax, dim,
                      points_r, size_r,
                      points_a, size_a,
-                     /*plus=*/false, /*psize=*/true, (uint_fast8_t) p);
+                     /*plus=*/false, /*psize=*/true, (uint_fast8_t) p, DIST_NORM_L2);
 }
 
 _attr_optimize_finite_math
@@ -239,21 +481,30 @@ IGD_plus_minmax(const int * restrict minmax, dimension_t dim,
     return gd_common(minmax, dim,
                      points_r, size_r,
                      points_a, size_a,
-                     /*plus=*/true, /*psize=*/true, /*p=*/1);
+                     /*plus=*/true, /*psize=*/true, /*p=*/1, DIST_NORM_L2);
 }
 
 _attr_maybe_unused static double
-IGD_plus(const double * restrict data, size_t npoints, dimension_t nobj,
-         const double * restrict ref, size_t ref_size,
-         const boolvec * restrict maximise)
+IGD_plus_norm(const double * restrict data, size_t npoints, dimension_t nobj,
+              const double * restrict ref, size_t ref_size,
+              const boolvec * restrict maximise, dist_norm_t norm)
 {
     ASSUME(nobj > 0);
     const int * minmax = minmax_from_boolvec(maximise, nobj);
-    double value = IGD_plus_minmax(minmax, nobj, data, npoints, ref, ref_size);
+    double value = gd_common(minmax, nobj, ref, ref_size, data, npoints,
+                             /*plus=*/true, /*psize=*/true, /*p=*/1, norm);
     free ((void *)minmax);
     return value;
 }
 
+_attr_maybe_unused static double
+IGD_plus(const double * restrict data, size_t npoints, dimension_t nobj,
+         const double * restrict ref, size_t ref_size,
+         const boolvec * restrict maximise)
+{
+    return IGD_plus_norm(data, npoints, nobj, ref, ref_size, maximise, DIST_NORM_L2);
+}
+
 _attr_optimize_finite_math
 static inline double
 avg_Hausdorff_dist_minmax(const int * restrict minmax, dimension_t dim,
@@ -264,26 +515,189 @@ avg_Hausdorff_dist_minmax(const int * restrict minmax, dimension_t dim,
     double gd_p = gd_common(minmax, dim,
                             points_a, size_a,
                             points_r, size_r,
-                            /*plus=*/false, /*psize=*/true, (uint_fast8_t)p);
+                            /*plus=*/false, /*psize=*/true, (uint_fast8_t)p, DIST_NORM_L2);
 
     double igd_p = gd_common(minmax, dim,
                              points_r, size_r,
                              points_a, size_a,
-                             /*plus=*/false, /*psize=*/true, (uint_fast8_t)p);
+                             /*plus=*/false, /*psize=*/true, (uint_fast8_t)p, DIST_NORM_L2);
     return MAX(gd_p, igd_p);
 }
 /* TODO: Implement p=INFINITY See [4] */
 
+_attr_maybe_unused static double
+avg_Hausdorff_dist_norm(const double * restrict data, size_t npoints, dimension_t nobj,
+                        const double * restrict ref, size_t ref_size,
+                        const boolvec * restrict maximise, unsigned int p,
+                        dist_norm_t norm)
+{
+    ASSUME(nobj > 0);
+    const int * minmax = minmax_from_boolvec(maximise, nobj);
+    double gd_p = gd_common(minmax, nobj, data, npoints, ref, ref_size,
+                            /*plus=*/false, /*psize=*/true, (uint_fast8_t)p, norm);
+    double igd_p = gd_common(minmax, nobj, ref, ref_size, data, npoints,
+                             /*plus=*/false, /*psize=*/true, (uint_fast8_t)p, norm);
+    free ((void *)minmax);
+    return MAX(gd_p, igd_p);
+}
+
 _attr_maybe_unused static double
 avg_Hausdorff_dist(const double * restrict data, size_t npoints, dimension_t nobj,
                    const double * restrict ref, size_t ref_size,
                    const boolvec * restrict maximise, unsigned int p)
+{
+    return avg_Hausdorff_dist_norm(data, npoints, nobj, ref, ref_size, maximise, p,
+                                   DIST_NORM_L2);
+}
+
+/******************************************************************************
+ Prepared reference set.
+
+ Computing several indicators of many sets with respect to the same reference
+ set repeats work that only depends on the reference set: transforming it to
+ minimisation and, for GD, building the k-d tree over it.  A gd_refset_t does
+ that work once.  It also fixes the norm used to measure distances.  For IGD
+ and IGD+, the nearest point is searched within the evaluated set, so the k-d
+ tree is built over that set when it is large enough.
+******************************************************************************/
+
+typedef struct {
+    dimension_t dim;
+    size_t size;
+    int * minmax;
+    dist_norm_t norm;
+    double * points;  // The reference set transformed to minimisation.
+    kdtree_t * tree;  // k-d tree over points or NULL if not useful.
+} gd_refset_t;
+
+static inline gd_refset_t *
+gd_refset_new_minmax(const double * restrict ref, size_t ref_size,
+                     const int * restrict minmax, dimension_t dim, dist_norm_t norm)
+{
+    ASSUME(dim > 0);
+    ASSUME(ref_size > 0);
+    gd_refset_t * rs = MOOCORE_MALLOC(1, gd_refset_t);
+    rs->dim = dim;
+    rs->size = ref_size;
+    rs->minmax = MOOCORE_MALLOC(dim, int);
+    memcpy(rs->minmax, minmax, dim * sizeof(*minmax));
+    rs->norm = norm;
+    rs->points = gd_minimise_copy(minmax, dim, ref, ref_size);
+    rs->tree = gd_use_kdtree(dim, ref_size) ? kdtree_new(rs->points, ref_size, dim) : NULL;
+    return rs;
+}
+
+_attr_maybe_unused static gd_refset_t *
+gd_refset_new(const double * restrict ref, size_t ref_size, dimension_t nobj,
+              const boolvec * restrict maximise, dist_norm_t norm)
 {
     ASSUME(nobj > 0);
-    const int * minmax = minmax_from_boolvec(maximise, nobj);
-    double value = avg_Hausdorff_dist_minmax(minmax, nobj, data, npoints, ref, ref_size, p);
-    free ((void *)minmax);
+    int * minmax = minmax_from_boolvec(maximise, nobj);
+    gd_refset_t * rs = gd_refset_new_minmax(ref, ref_size, minmax, nobj, norm);
+    free(minmax);
+    return rs;
+}
+
+_attr_maybe_unused static void
+gd_refset_free(gd_refset_t * rs)
+{
+    if (rs == NULL) return;
+    kdtree_free(rs->tree);
+    free(rs->points);
+    free(rs->minmax);
+    free(rs);
+}
+
+/* If inverted, compute the distance from each reference point to the nearest
+   point of data (IGD), otherwise from each point of data to the nearest
+   reference point (GD).  */
+_attr_optimize_finite_math
+static inline double
+gd_refset_norm_(const gd_refset_t * restrict rs,
+                const double * restrict data, size_t size, bool inverted,
+                bool plus, bool psize, uint_fast8_t p, const dist_norm_t norm)
+{
+    const dimension_t dim = rs->dim;
+    double * points = gd_minimise_copy(rs->minmax, dim, data, size);
+    double value;
+    if (inverted)
+        value = gd_common_min_maybe_kdtree(dim, rs->points, rs->size, points, size,
+                                           plus, psize, p, norm);
+    else if (rs->tree)
+        value = gd_common_kdtree(dim, points, size, rs->tree, plus, psize, p, norm);
+    else if (gd_use_tiled(size, rs->size))
+        value = gd_common_tiled(dim, points, size, rs->points, rs->size,
+                                plus, psize, p, norm);
+    else
+        value = gd_common_agree_min(dim, points, size, rs->points, rs->size,
+                                    plus, psize, p, norm);
+    free(points);
     return value;
 }
 
+_attr_optimize_finite_math
+static inline double
+gd_refset_common(const gd_refset_t * restrict rs,
+                 const double * restrict data, size_t size, bool inverted,
+                 bool plus, bool psize, uint_fast8_t p)
+{
+    if (size == 0)
+        return INFINITY;
+    // This forces the compiler to generate specialized versions for each norm.
+    switch (rs->norm) {
+      case DIST_NORM_L1:
+          return gd_refset_norm_(rs, data, size, inverted, plus, psize, p, DIST_NORM_L1);
+      case DIST_NORM_LINF:
+          return gd_refset_norm_(rs, data, size, inverted, plus, psize, p, DIST_NORM_LINF);
+      default:
+          return gd_refset_norm_(rs, data, size, inverted, plus, psize, p, DIST_NORM_L2);
+    }
+}
+
+_attr_maybe_unused static double
+GD_refset(const gd_refset_t * restrict rs, const double * restrict data, size_t size)
+{
+    return gd_refset_common(rs, data, size, /*inverted=*/false,
+                            /*plus=*/false, /*psize=*/false, /*p=*/1);
+}
+
+_attr_maybe_unused static double
+IGD_refset(const gd_refset_t * restrict rs, const double * restrict data, size_t size)
+{
+    return gd_refset_common(rs, data, size, /*inverted=*/true,
+                            /*plus=*/false, /*psize=*/false, /*p=*/1);
+}
+
+_attr_maybe_unused static double
+GD_p_refset(const gd_refset_t * restrict rs, const double * restrict data, size_t size,
+            unsigned int p)
+{
+    return gd_refset_common(rs, data, size, /*inverted=*/false,
+                            /*plus=*/false, /*psize=*/true, (uint_fast8_t) p);
+}
+
+_attr_maybe_unused static double
+IGD_p_refset(const gd_refset_t * restrict rs, const double * restrict data, size_t size,
+             unsigned int p)
+{
+    return gd_refset_common(rs, data, size, /*inverted=*/true,
+                            /*plus=*/false, /*psize=*/true, (uint_fast8_t) p);
+}
+
+_attr_maybe_unused static double
+IGD_plus_refset(const gd_refset_t * restrict rs, const double * restrict data, size_t size)
+{
+    return gd_refset_common(rs, data, size, /*inverted=*/true,
+                            /*plus=*/true, /*psize=*/true, /*p=*/1);
+}
+
+_attr_maybe_unused static double
+avg_Hausdorff_dist_refset(const gd_refset_t * restrict rs,
+                          const double * restrict data, size_t size, unsigned int p)
+{
+    double gd_p = GD_p_refset(rs, data, size, p);
+    double igd_p = IGD_p_refset(rs, data, size, p);
+    return MAX(gd_p, igd_p);
+}
+
 #endif /* IGD_H */
@@ -216,6 +216,131 @@ read_datasets(const char * filename, double ** restrict data_p,
 }
 
 #ifndef R_PACKAGE
+/*
+ * Incremental reading of a data file, a few rows at a time, for processing
+ * files that do not fit in memory.
+ */
+int
+data_stream_open(data_stream_t * restrict ds, const char * filename)
+{
+    if (filename == NULL) {
+        ds->instream = stdin;
+        ds->filename = stdin_name;
+    } else if (unlikely(NULL == (ds->instream = fopen (filename,"rb")))) {
+        errprintf ("%s: %s", filename, strerror (errno));
+        return ERROR_FOPEN;
+    } else {
+        ds->filename = filename;
+    }
+    ds->nobjs = 0;
+    ds->line = 0;
+    /* skip over leading whitespace, comments and empty lines.  */
+    do {
+        ds->line++;
+        ds->retval = skip_comment_line (ds->instream);
+    } while (ds->retval == 1);
+
+    if (unlikely(ds->retval == EOF)) {
+        data_stream_close(ds);
+        return READ_INPUT_FILE_EMPTY;
+    }
+    return 0;
+}
+
+void
+data_stream_close(data_stream_t * restrict ds)
+{
+    if (ds->instream != stdin)
+        fclose(ds->instream);
+    ds->instream = NULL;
+}
+
+/*
+ * Read at most max_rows rows of the current data set into data, which must
+ * have space for max_rows * ds->nobjs values (ds->nobjs is zero until the
+ * first row has been read).  The number of rows
+ * read is stored in *nrows_p.  *end_of_set_p becomes true if the current data
+ * set ends after the rows read, and *eof_p becomes true if there are no more
+ * data sets.
+ */
+int
+data_stream_read(data_stream_t * restrict ds, double * restrict data,
+                 size_t max_rows, size_t * restrict nrows_p,
+                 bool * restrict end_of_set_p, bool * restrict eof_p)
+{
+    FILE * instream = ds->instream;
+    const char * filename = ds->filename;
+    size_t nrows = 0;
+    int errorcode = 0;
+    *end_of_set_p = *eof_p = false;
+
+    while (nrows < max_rows) {
+        assert(ds->retval == 0);
+        /* beginning of row */
+        int column = 0;
+        int retval;
+        do {
+            /* new column */
+            column++;
+            if (unlikely(column > MOOCORE_DIMENSION_MAX)) {
+                errprintf ("%s: line %d: more than %d columns",
+                           filename, ds->line, MOOCORE_DIMENSION_MAX);
+                errorcode = ERROR_COLUMNS;
+                goto read_data_finish;
+            }
+            double number;
+            retval = fread_double(instream, &number);
+            if (unlikely(retval != 1)) {
+                char buffer[64];
+                if (fscanf (instream, "%60[^ \t\r\n]", buffer) != 1) {
+                    errprintf ("%s: line %d column %d: "
+                               "read error or unexpected end of file",
+                               filename, ds->line, column);
+                } else {
+                    errprintf ("%s: line %d column %d: "
+                               "could not convert string `%s' to double",
+                               filename, ds->line, column, buffer);
+                }
+                errorcode = ERROR_CONVERSION;
+                goto read_data_finish;
+            }
+            ds->row[column - 1] = number;
+            /* skip possible trailing whitespace */
+            retval = skip_trailing_whitespace(instream);
+        } while (retval == 0);
+
+        if (!ds->nobjs)
+            ds->nobjs = column;
+        else if (unlikely(column != ds->nobjs)) {
+            errprintf ("%s: line %d has different number of columns (%d)"
+                       " from first row (%d)\n",
+                       filename, ds->line, column, ds->nobjs);
+            errorcode = ERROR_COLUMNS;
+            goto read_data_finish;
+        }
+        memcpy(data + nrows * column, ds->row, column * sizeof(*data));
+        nrows++;
+
+        /* look for an empty line */
+        ds->line++;
+        ds->retval = skip_comment_line (instream);
+        if (ds->retval != 0) {
+            /* skip over successive empty lines */
+            while (ds->retval == 1) {
+                ds->line++;
+                ds->retval = skip_comment_line (instream);
+            }
+            *end_of_set_p = true;
+            *eof_p = (ds->retval == EOF);
+            break;
+        }
+    }
+
+read_data_finish:
+    *nrows_p = nrows;
+    return errorcode;
+}
+
 void
 vector_fprintf (FILE *stream, const double * vector, int size)
 {
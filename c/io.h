@@ -46,6 +46,21 @@ int write_sets_filtered (FILE * outfile, const double * data, int ncols,
                          const int * cumsizes, int nruns,
                          const boolvec * write_p);
 
+typedef struct {
+    FILE * instream;
+    const char * filename;
+    int nobjs;
+    int line;
+    int retval;
+    double row[MOOCORE_DIMENSION_MAX];
+} data_stream_t;
+
+int data_stream_open(data_stream_t * restrict ds, const char * filename);
+void data_stream_close(data_stream_t * restrict ds);
+int data_stream_read(data_stream_t * restrict ds, double * restrict data,
+                     size_t max_rows, size_t * restrict nrows_p,
+                     bool * restrict end_of_set_p, bool * restrict eof_p);
+
 static inline const int *
 read_minmax (const char *str, int *nobj_p)
 {
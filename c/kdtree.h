@@ -0,0 +1,273 @@
+#ifndef MOOCORE_KDTREE_H_
+#define MOOCORE_KDTREE_H_
+
+/******************************************************************************
+ k-d tree for nearest-distance queries.
+
+ The tree stores a copy of the points reordered so that each node covers a
+ contiguous range of rows, together with the bounding box of the node.
+ Queries return the distance to the nearest point, either the usual distance
+ or the modified distance of IGD+, where only the coordinates in which the
+ stored point is worse (larger, assuming minimisation) than the query point
+ contribute:
+
+   d^+(q, x) = || (max(x_k - q_k, 0))_k ||
+
+ The norm may be the taxicab (L1), Euclidean (L2) or Chebyshev (L-infinity)
+ norm.  Euclidean distances are returned squared.  All of them admit a lower
+ bound from the bounding box of a node, so the same tree (built over points
+ transformed to minimisation) answers all queries.
+******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "common.h"
+#include "maxminclamp.h"
+
+// Maximum number of points in a leaf.
+#ifndef KDTREE_LEAF_SIZE
+#define KDTREE_LEAF_SIZE 8
+#endif
+
+/* Norm used to measure the distance between two points.  */
+typedef enum {
+    DIST_NORM_L1 = 1,  // Taxicab (Manhattan) distance.
+    DIST_NORM_L2 = 2,  // Euclidean distance.
+    DIST_NORM_LINF = 3 // Chebyshev (maximum) distance.
+} dist_norm_t;
+
+/* Add the difference in one coordinate to a partial distance.  With
+   DIST_NORM_L2 the distance is kept squared.  When norm is a constant, loops
+   calling this function remain vectorizable.  */
+_attr_optimize_finite_math
+static inline double
+dist_norm_add(const dist_norm_t norm, double dist, double diff)
+{
+    switch (norm) {
+      case DIST_NORM_L1:
+          return dist + fabs(diff);
+      case DIST_NORM_LINF:
+          return MAX(dist, fabs(diff));
+      default:
+          return dist + diff * diff;
+    }
+}
+
+typedef struct {
+    size_t begin, end; // Range of rows [begin, end).
+    size_t left, right; // Children, or 0 if this is a leaf.
+} kdtree_node_t;
+
+typedef struct {
+    dimension_t dim;
+    size_t size;
+    double * points;   // size * dim, reordered.
+    size_t nnodes, maxnodes;
+    kdtree_node_t * nodes;
+    double * bounds;  // For each node, dim lower bounds followed by dim upper bounds.
+} kdtree_t;
+
+static inline size_t
+kdtree_new_node(kdtree_t * tree, size_t begin, size_t end)
+{
+    if (tree->nnodes == tree->maxnodes) {
+        tree->maxnodes *= 2;
+        tree->nodes = realloc(tree->nodes, tree->maxnodes * sizeof(*tree->nodes));
+        tree->bounds = realloc(tree->bounds,
+                               tree->maxnodes * 2 * tree->dim * sizeof(*tree->bounds));
+    }
+    size_t k = tree->nnodes++;
+    tree->nodes[k] = (kdtree_node_t) { .begin = begin, .end = end, .left = 0, .right = 0 };
+    return k;
+}
+
+/* Reorder idx[begin..end) so that idx[nth] has the nth smallest value of
+   coordinate d, smaller ones before and larger ones after.  */
+static inline void
+kdtree_select(size_t * restrict idx, size_t begin, size_t end, size_t nth,
+              const double * restrict points, dimension_t dim, dimension_t d)
+{
+#define key(I) points[idx[I] * dim + d]
+#define swap_idx(I, J) do { size_t tmp_ = idx[I]; idx[I] = idx[J]; idx[J] = tmp_; } while (0)
+    while (end - begin > 1) {
+        // Median of three as pivot.
+        size_t mid = begin + (end - begin) / 2, last = end - 1;
+        if (key(mid) < key(begin)) swap_idx(mid, begin);
+        if (key(last) < key(begin)) swap_idx(last, begin);
+        if (key(last) < key(mid)) swap_idx(last, mid);
+        const double pivot = key(mid);
+        size_t i = begin, j = last;
+        while (i <= j) {
+            while (key(i) < pivot) i++;
+            while (key(j) > pivot) j--;
+            if (i <= j) {
+                swap_idx(i, j);
+                i++;
+                if (j == 0) break;
+                j--;
+            }
+        }
+        if (nth <= j) end = j + 1;
+        else if (nth >= i) begin = i;
+        else return;
+    }
+#undef key
+#undef swap_idx
+}
+
+static void
+kdtree_build_rec(kdtree_t * tree, size_t * restrict idx, const double * restrict points,
+                 size_t node)
+{
+    const dimension_t dim = tree->dim;
+    const size_t begin = tree->nodes[node].begin, end = tree->nodes[node].end;
+    double * lo = tree->bounds + node * 2 * dim;
+    double * hi = lo + dim;
+    const double * p = points + idx[begin] * dim;
+    for (dimension_t d = 0; d < dim; d++)
+        lo[d] = hi[d] = p[d];
+    for (size_t i = begin + 1; i < end; i++) {
+        p = points + idx[i] * dim;
+        for (dimension_t d = 0; d < dim; d++) {
+            lo[d] = MIN(lo[d], p[d]);
+            hi[d] = MAX(hi[d], p[d]);
+        }
+    }
+    if (end - begin <= KDTREE_LEAF_SIZE)
+        return;
+
+    // Split the widest coordinate at the median.
+    dimension_t split = 0;
+    double width = hi[0] - lo[0];
+    for (dimension_t d = 1; d < dim; d++) {
+        if (hi[d] - lo[d] > width) {
+            width = hi[d] - lo[d];
+            split = d;
+        }
+    }
+    if (width <= 0) // All points are equal.
+        return;
+    const size_t mid = begin + (end - begin) / 2;
+    kdtree_select(idx, begin, end, mid, points, dim, split);
+    // tree->nodes may be reallocated.
+    size_t left = kdtree_new_node(tree, begin, mid);
+    size_t right = kdtree_new_node(tree, mid, end);
+    tree->nodes[node].left = left;
+    tree->nodes[node].right = right;
+    kdtree_build_rec(tree, idx, points, left);
+    kdtree_build_rec(tree, idx, points, right);
+}
+
+static inline kdtree_t *
+kdtree_new(const double * restrict points, size_t size, dimension_t dim)
+{
+    ASSUME(size > 0);
+    ASSUME(dim > 0);
+    kdtree_t * tree = MOOCORE_MALLOC(1, kdtree_t);
+    tree->dim = dim;
+    tree->size = size;
+    tree->nnodes = 0;
+    tree->maxnodes = 2 * (size / KDTREE_LEAF_SIZE) + 1;
+    tree->nodes = MOOCORE_MALLOC(tree->maxnodes, kdtree_node_t);
+    tree->bounds = MOOCORE_MALLOC(tree->maxnodes * 2 * dim, double);
+    size_t * idx = MOOCORE_MALLOC(size, size_t);
+    for (size_t i = 0; i < size; i++)
+        idx[i] = i;
+    kdtree_build_rec(tree, idx, points, kdtree_new_node(tree, 0, size));
+    tree->points = MOOCORE_MALLOC(size * dim, double);
+    for (size_t i = 0; i < size; i++)
+        memcpy(tree->points + i * dim, points + idx[i] * dim, dim * sizeof(double));
+    free(idx);
+    return tree;
+}
+
+static inline void
+kdtree_free(kdtree_t * tree)
+{
+    if (tree == NULL) return;
+    free(tree->points);
+    free(tree->nodes);
+    free(tree->bounds);
+    free(tree);
+}
+
+/* Distance from q to the closest point that may be in the box.  */
+_attr_optimize_finite_math
+static inline double
+kdtree_box_dist(const double * restrict q, const double * restrict lo,
+                dimension_t dim, const bool plus, const dist_norm_t norm)
+{
+    double dist = 0;
+    for (dimension_t d = 0; d < dim; d++) {
+        double diff = plus
+            ? MAX(lo[d] - q[d], 0.)
+            : MAX(MAX(lo[d] - q[d], q[d] - lo[d + dim]), 0.);
+        dist = dist_norm_add(norm, dist, diff);
+    }
+    return dist;
+}
+
+_attr_optimize_finite_math
+static void
+kdtree_nearest_rec(const kdtree_t * restrict tree, const double * restrict q,
+                   size_t node, const bool plus, const dist_norm_t norm,
+                   double * restrict best)
+{
+    const dimension_t dim = tree->dim;
+    const kdtree_node_t * n = tree->nodes + node;
+    if (n->left == 0) {
+        for (size_t i = n->begin; i < n->end; i++) {
+            const double * restrict p = tree->points + i * dim;
+            // Same operations as gd_common_helper_().
+            double dist = 0;
+            for (dimension_t d = 0; d < dim; d++) {
+                double diff = plus ? MAX(p[d] - q[d], 0.) : (q[d] - p[d]);
+                dist = dist_norm_add(norm, dist, diff);
+            }
+            *best = MIN(*best, dist);
+        }
+        return;
+    }
+    size_t first = n->left, second = n->right;
+    double dist_first = kdtree_box_dist(q, tree->bounds + first * 2 * dim, dim, plus, norm);
+    double dist_second = kdtree_box_dist(q, tree->bounds + second * 2 * dim, dim, plus, norm);
+    if (dist_second < dist_first) {
+        SWAP(first, second);
+        SWAP(dist_first, dist_second);
+    }
+    if (dist_first < *best) {
+        kdtree_nearest_rec(tree, q, first, plus, norm, best);
+        if (dist_second < *best)
+            kdtree_nearest_rec(tree, q, second, plus, norm, best);
+    }
+}
+
+/* Distance (or IGD+ distance) from q to the nearest point of the tree,
+   squared if norm is DIST_NORM_L2.  */
+static inline double
+kdtree_nearest_dist(const kdtree_t * restrict tree, const double * restrict q,
+                    const bool plus, const dist_norm_t norm)
+{
+    double best = INFINITY;
+    // This forces the compiler to generate specialized versions.
+#define kdtree_nearest_rec_norm_(PLUS)                                  \
+    switch (norm) {                                                     \
+      case DIST_NORM_L1:                                                \
+          kdtree_nearest_rec(tree, q, 0, PLUS, DIST_NORM_L1, &best);    \
+          break;                                                        \
+      case DIST_NORM_LINF:                                              \
+          kdtree_nearest_rec(tree, q, 0, PLUS, DIST_NORM_LINF, &best);  \
+          break;                                                        \
+      default:                                                          \
+          kdtree_nearest_rec(tree, q, 0, PLUS, DIST_NORM_L2, &best);    \
+    }
+    if (plus) {
+        kdtree_nearest_rec_norm_(true);
+    } else {
+        kdtree_nearest_rec_norm_(false);
+    }
+#undef kdtree_nearest_rec_norm_
+    return best;
+}
+
+#endif // MOOCORE_KDTREE_H_
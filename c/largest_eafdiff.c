@@ -0,0 +1,202 @@
+#include <string.h>
+#include "eafdiff_priv.h"
+#include "sort.h"
+#include "whv.h"
+
+/* Pair of datasets with the largest EAF difference [DiaLop2020ejor].
+
+   The value of a pair (a, b) is the minimum of the area, within the box
+   [ideal, ref], where the difference in favour of a is at least 1 and the
+   area where the difference in favour of b is at least 1.  A difference of
+   at least 1 in favour of a, with n intervals, requires that at least
+   ceil(nruns_a / n) runs of a attain the point and at most nruns_b -
+   ceil(nruns_b / n) runs of b attain it.  Thus, its area is at most
+   H(S_a U S_b) - H(S_b), where S_a and S_b are the attainment surfaces of
+   those levels.  Pairs are evaluated in decreasing order of this bound, so
+   the search stops as soon as no remaining pair can beat the best value
+   found so far.  Ties are broken in favour of the first pair in
+   lexicographic order.  */
+
+typedef struct {
+    int nruns;
+    size_t npoints;
+    eafdiff_point_t * points; // Sorted for eafdiff2d_sweep().
+    eaf_t ** eaf; // Attainment surfaces of all levels.
+    const double *** surf; // Sorted for hv2d_union_sorted().
+    size_t * nsurf;
+    double * hv;
+} largest_eafdiff_data_t;
+
+typedef struct {
+    double bound;
+    int a, b;
+} largest_eafdiff_pair_t;
+
+DEFINE_QSORT_CMP(cmp_pair_bound_desc, largest_eafdiff_pair_t *)
+{
+    if (a->bound != b->bound)
+        return (a->bound > b->bound) ? -1 : 1;
+    if (a->a != b->a)
+        return (a->a < b->a) ? -1 : 1;
+    return (a->b < b->b) ? -1 : (a->b > b->b);
+}
+
+static void
+largest_eafdiff_data_init(largest_eafdiff_data_t * restrict d, const double * restrict data,
+                          size_t start, const size_t * restrict cumsizes, int nruns,
+                          const double * restrict ref)
+{
+    data += 2 * start;
+    size_t * run_cumsizes = malloc(nruns * sizeof(*run_cumsizes));
+    for (int r = 0; r < nruns; r++)
+        run_cumsizes[r] = cumsizes[r] - start;
+    d->nruns = nruns;
+    d->npoints = run_cumsizes[nruns - 1];
+    d->points = eafdiff_sorted_points(data, run_cumsizes, nruns, 0);
+
+    int * level = levels_from_percentiles(NULL, nruns, nruns);
+    d->eaf = eaf2d(data, run_cumsizes, nruns, level, nruns, /* store_attained = */false);
+    free(level);
+    free(run_cumsizes);
+    d->surf = malloc(nruns * sizeof(*d->surf));
+    d->nsurf = malloc(nruns * sizeof(*d->nsurf));
+    d->hv = malloc(nruns * sizeof(*d->hv));
+    for (int l = 0; l < nruns; l++) {
+        d->nsurf[l] = d->eaf[l]->size;
+        d->surf[l] = generate_sorted_doublep_2d_filter_by_ref(d->eaf[l]->data, &d->nsurf[l],
+                                                              ref[0]);
+        d->hv[l] = hv2d_union_sorted(d->surf[l], d->nsurf[l], NULL, 0, ref);
+    }
+}
+
+static void
+largest_eafdiff_data_free(largest_eafdiff_data_t * d)
+{
+    for (int l = 0; l < d->nruns; l++)
+        if (d->nsurf[l] > 0) free(d->surf[l]);
+    free(d->hv);
+    free(d->nsurf);
+    free(d->surf);
+    eaf_free(d->eaf, d->nruns);
+    free(d->points);
+}
+
+static inline int
+largest_eafdiff_intervals(const largest_eafdiff_data_t * a,
+                          const largest_eafdiff_data_t * b, int intervals)
+{
+    return MIN(intervals, (a->nruns + b->nruns) / 2);
+}
+
+/* Upper bound of the area where the difference in favour of a is at least 1.  */
+static double
+largest_eafdiff_bound(const largest_eafdiff_data_t * restrict a,
+                      const largest_eafdiff_data_t * restrict b, int intervals,
+                      const double * restrict ref)
+{
+    const int la = (a->nruns + intervals - 1) / intervals - 1;
+    const int lb = b->nruns - (b->nruns + intervals - 1) / intervals;
+    return hv2d_union_sorted(a->surf[la], a->nsurf[la], b->surf[lb], b->nsurf[lb], ref)
+        - b->hv[lb];
+}
+
+/* Weighted hypervolume of the ideal point using the rectangles whose
+   difference is at least 1 in favour of the left (sign = 1) or the right
+   (sign = -1) dataset, with weight 1.  */
+static double
+largest_eafdiff_side(const double * restrict rows, size_t nrows, double sign,
+                     double * restrict rects, const double * restrict ideal,
+                     const double * restrict ref)
+{
+    const int ncol = 5;
+    size_t n = 0;
+    for (size_t k = 0; k < nrows; k++) {
+        const double * row = rows + k * ncol;
+        if (sign * row[4] < 1) continue;
+        memcpy(rects + n * ncol, row, (ncol - 1) * sizeof(*rects));
+        rects[n * ncol + 4] = 1;
+        n++;
+    }
+    double point[] = { ideal[0], ideal[1] };
+    return rect_weighted_hv2d(point, 1, rects, (int) n, ref);
+}
+
+static double
+largest_eafdiff_value(eafdiff_point_t * restrict points,
+                      const largest_eafdiff_data_t * restrict a,
+                      const largest_eafdiff_data_t * restrict b, int intervals,
+                      const double * restrict ideal, const double * restrict ref)
+{
+    const size_t ntotal = a->npoints + b->npoints;
+    eafdiff_merge_points(points, a->points, a->npoints, b->points, b->npoints, a->nruns);
+    eafdiff_output_t out = { .stream = NULL, .ncol = 5 };
+    vector_objective_ctor(&out.rows, ntotal * out.ncol);
+    eafdiff2d_sweep(&out, points, ntotal, a->nruns, b->nruns, intervals,
+                    /* rectangles = */true);
+
+    const double * rows = vector_objective_begin(&out.rows);
+    double * rects = malloc(out.nrows * out.ncol * sizeof(*rects));
+    const double value_a = largest_eafdiff_side(rows, out.nrows, 1, rects, ideal, ref);
+    const double value_b = largest_eafdiff_side(rows, out.nrows, -1, rects, ideal, ref);
+    free(rects);
+    vector_objective_dtor(&out.rows);
+    return MIN(value_a, value_b);
+}
+
+double
+largest_eafdiff(int * restrict best_a, int * restrict best_b,
+                const double * restrict data, const size_t * restrict cumsizes,
+                const int * restrict cumruns, int ndata, int intervals,
+                const double * restrict ideal, const double * restrict ref)
+{
+    *best_a = *best_b = -1;
+    if (ndata < 2 || intervals < 1) return 0;
+
+    largest_eafdiff_data_t * d = malloc(ndata * sizeof(*d));
+    size_t max_npoints = 0;
+    for (int k = 0; k < ndata; k++) {
+        const int first = (k == 0) ? 0 : cumruns[k - 1];
+        largest_eafdiff_data_init(&d[k], data, (first == 0) ? 0 : cumsizes[first - 1],
+                                  cumsizes + first, cumruns[k] - first, ref);
+        max_npoints = MAX(max_npoints, d[k].npoints);
+    }
+
+    const size_t npairs = (size_t) ndata * (size_t) (ndata - 1) / 2;
+    largest_eafdiff_pair_t * pairs = malloc(npairs * sizeof(*pairs));
+    size_t k = 0;
+    for (int a = 0; a < ndata - 1; a++) {
+        for (int b = a + 1; b < ndata; b++, k++) {
+            const int n = largest_eafdiff_intervals(&d[a], &d[b], intervals);
+            pairs[k] = (largest_eafdiff_pair_t) {
+                MIN(largest_eafdiff_bound(&d[a], &d[b], n, ref),
+                    largest_eafdiff_bound(&d[b], &d[a], n, ref)), a, b };
+        }
+    }
+    qsort_typesafe(pairs, npairs, cmp_pair_bound_desc);
+
+    eafdiff_point_t * points = malloc(2 * max_npoints * sizeof(*points));
+    double best_value = 0;
+    for (k = 0; k < npairs; k++) {
+        const largest_eafdiff_pair_t * pair = &pairs[k];
+        /* The bound and the value are computed differently, so allow for
+           rounding errors before discarding a pair that may tie.  */
+        if (pair->bound * (1 + 1e-9) < best_value)
+            break;
+        const largest_eafdiff_data_t * a = &d[pair->a], * b = &d[pair->b];
+        const double value = largest_eafdiff_value(
+            points, a, b, largest_eafdiff_intervals(a, b, intervals), ideal, ref);
+        if (value > best_value
+            || (value == best_value && value > 0
+                && (pair->a < *best_a || (pair->a == *best_a && pair->b < *best_b)))) {
+            best_value = value;
+            *best_a = pair->a;
+            *best_b = pair->b;
+        }
+    }
+    free(points);
+    free(pairs);
+    for (int l = 0; l < ndata; l++)
+        largest_eafdiff_data_free(&d[l]);
+    free(d);
+    return best_value;
+}
@@ -1,5 +1,5 @@
 # -*- Makefile-gmake -*-
-LIBHV_SRCS = hv.c hv3dplus.c hv4d.c hvc3d.c hv_contrib.c
+LIBHV_SRCS = hv.c hv3dplus.c hv4d.c hvc3d.c hv_contrib.c nondominated_dispatch.c
 LIBHV_HDRS = hv.h hv_priv.h hv3d_priv.h hv4d_priv.h hvc4d_priv.h libmoocore-config.h
 LIBHV_OBJS = $(LIBHV_SRCS:.c=.o)
 HV_LIB     = fpli_hv.a
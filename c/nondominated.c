@@ -39,6 +39,7 @@
 #include <math.h> // for log10()
 
 #include "nondominated.h"
+#include "nondominated_stream.h"
 
 #define READ_INPUT_WRONG_INITIAL_DIM_ERRSTR "either -o, --obj, -u, --upper or -l, --lower"
 #include "cmdline.h"
@@ -51,6 +52,8 @@ static bool filter_flag = false;
 static bool normalise_flag = false;
 static bool force_bounds_flag = false;
 static const char * suffix = "_dat";
+static size_t stream_size = 0;
+static enum { MERGE_NONE, MERGE_UNION, MERGE_SUM } merge_mode = MERGE_NONE;
 
 static void usage(void)
 {
@@ -85,6 +88,16 @@ OPTION_MAXIMISE_STR
 " -a, --agree=<max|min> transform objectives so all are maximised (or       \n"
 "                       minimised). See also the option --obj.              \n"
 " -f, --filter        check and filter out dominated points;                \n"
+"     --stream=POINTS like --filter, but keep at most about POINTS points in\n"
+"                     memory, using temporary files if needed. Only --obj,  \n"
+"                     --maximise, --union and --suffix may be combined with \n"
+"                     this option;                                          \n"
+"     --merge[=union|sum] read all sets from all inputs, which must be      \n"
+"                     nondominated, and print to stdout their nondominated  \n"
+"                     union (default), or the nondominated points of the    \n"
+"                     Minkowski sum of exactly two bi-objective sets (sum). \n"
+"                     Only --obj and --maximise may be combined with this   \n"
+"                     option;                                               \n"
 " -b, --force-bound   remove points that do not satisfy the bounds;         \n"
 " -n, --normalise RANGE normalise all objectives to a range, e.g., \"1 2\". \n"
 "                       If bounds are given with -l and -u, they are used   \n"
@@ -214,14 +227,14 @@ check_dominated(const char * filename, const double * restrict points,
                          filename_len - 2, "filename");
                 first_time = false;
             }
-            fprintf (stderr, "%-*s\t%d\t%zu\t%zu\t%zd\n",
+            fprintf (stderr, "%-*s\t%d\t%zu\t%zu\t%zu\n",
                      filename_len, filename, n+1, old_size, new_size, old_size - new_size);
         } else if (verbose_flag && new_size < old_size) {
             if (first_time) {
                 fprintf (stderr, "%-*s\tset\tdom\n", filename_len, "filename");
                 first_time = false;
             }
-            fprintf (stderr, "%-*s\t%d\t%zd dominated\n",
+            fprintf (stderr, "%-*s\t%d\t%zu dominated\n",
                      filename_len, filename, n+1, old_size - new_size);
         }
 
@@ -436,6 +449,151 @@ process_file(const char * filename,
     return dominated_found;
 }
 
+static void
+stream_emit(void * ctx, const double * points, size_t size, dimension_t nobj)
+{
+    FILE * outfile = ctx;
+    for (size_t k = 0; k < size; k++) {
+        vector_fprintf (outfile, &points[nobj * k], nobj);
+        fprintf (outfile, "\n");
+    }
+}
+
+/* Same output as process_file() with --filter, but the input is never fully
+   loaded in memory.  */
+static bool
+process_file_stream(const char * filename, const int * restrict minmax,
+                    int * restrict nobj_p, bool maximise_all_flag)
+{
+    data_stream_t ds;
+    handle_read_data_error(data_stream_open(&ds, filename), filename);
+    if (filename == NULL)
+        filename = stdin_name;
+
+    // Read the first row to know the number of objectives.
+    double first[MOOCORE_DIMENSION_MAX];
+    size_t nrows;
+    bool end_of_set, eof;
+    int err = data_stream_read(&ds, first, 1, &nrows, &end_of_set, &eof);
+    if (err) {
+        data_stream_close(&ds);
+        handle_read_data_error(err, filename);
+    }
+    if (*nobj_p == 0) {
+        *nobj_p = ds.nobjs;
+    } else if (*nobj_p != ds.nobjs) {
+        errprintf ("%s: line %d: input has dimension %d"
+                   " while previous data has dimension %d",
+                   filename, ds.line - 1, ds.nobjs, *nobj_p);
+        handle_read_data_error(READ_INPUT_WRONG_INITIAL_DIM, filename);
+    }
+    dimension_t nobj = (dimension_t) *nobj_p;
+    bool free_minmax = minmax_alloc(&minmax, maximise_all_flag, nobj);
+
+    const char * outfilename = NULL;
+    FILE * outfile = fopen_outfile(&outfilename, filename, suffix);
+
+    nondom_stream_t * stream = nondom_stream_new(nobj, minmax, stream_size);
+    nondom_stream_push(stream, first, nrows);
+    double * chunk = MOOCORE_MALLOC(stream->chunk_size * nobj, double);
+    // We use it for %-*s in fprintf, so it must be an int.
+    int filename_len = (int) MAX(strlen(filename), strlen("filename"));
+    if (verbose_flag >= 2)
+        fprintf (stderr, "# %*s\tset\tsize\tnondom\tdom\n",
+                 filename_len - 2, "filename");
+    bool dominated_found = false;
+    int nsets = 0;
+    while (true) {
+        if (end_of_set && (eof || !union_flag)) {
+            size_t old_size = stream->npoints;
+            if (nsets > 0)
+                fprintf (outfile, "\n");
+            nsets++;
+            size_t new_size = nondom_stream_finish(stream, stream_emit, outfile);
+            if (verbose_flag >= 2)
+                fprintf (stderr, "%-*s\t%d\t%zu\t%zu\t%zu\n",
+                         filename_len, filename, nsets, old_size, new_size,
+                         old_size - new_size);
+            if (new_size < old_size)
+                dominated_found = true;
+        }
+        if (eof)
+            break;
+        err = data_stream_read(&ds, chunk, stream->chunk_size, &nrows,
+                               &end_of_set, &eof);
+        if (err) {
+            data_stream_close(&ds);
+            handle_read_data_error(err, filename);
+        }
+        nondom_stream_push(stream, chunk, nrows);
+    }
+    data_stream_close(&ds);
+
+    if (verbose_flag >= 2)
+        fprintf (stderr, "# nondominated: %s\n", bool2str(!dominated_found));
+    fclose_outfile(outfile, filename, outfilename, verbose_flag);
+    free(chunk);
+    nondom_stream_free(stream);
+    if (free_minmax) free((void *) minmax);
+    return dominated_found;
+}
+
+/* Read all sets from all files and combine them into a single set.  */
+static void
+process_files_merge(char ** filenames, int numfiles,
+                    const int * restrict minmax, int * restrict nobj_p,
+                    bool maximise_all_flag)
+{
+    double * points = NULL;
+    int * cumsizes = NULL;
+    int nsets = 0;
+    if (numfiles <= 0)
+        robust_read_double_data(NULL, &points, nobj_p, &cumsizes, &nsets, false);
+    for (int k = 0; k < numfiles; k++)
+        robust_read_double_data(filenames[k], &points, nobj_p, &cumsizes, &nsets, false);
+    dimension_t nobj = (dimension_t) *nobj_p;
+    bool free_minmax = minmax_alloc(&minmax, maximise_all_flag, nobj);
+    const size_t size = (size_t) cumsizes[nsets - 1];
+    size_t new_size;
+    if (merge_mode == MERGE_SUM) {
+        if (nobj != 2 || minmax[0] == 0 || minmax[1] == 0)
+            fatal_error("--merge=sum requires exactly two objectives");
+        if (nsets != 2)
+            fatal_error("--merge=sum requires exactly two sets, but input has %d",
+                        nsets);
+        double * sum;
+        new_size = minkowski_sum_nondominated_2d(
+            &sum, points, (size_t) cumsizes[0],
+            points + 2 * cumsizes[0], (size_t) (cumsizes[1] - cumsizes[0]),
+            minmax);
+        for (size_t k = 0; k < new_size; k++) {
+            vector_fprintf (stdout, &sum[nobj * k], nobj);
+            fprintf (stdout, "\n");
+        }
+        if (verbose_flag >= 2)
+            fprintf (stderr, "# sizes: %d %d\n# nondominated sums: %zu\n",
+                     cumsizes[0], cumsizes[1] - cumsizes[0], new_size);
+        free(sum);
+    } else {
+        size_t * scumsizes = MOOCORE_MALLOC(nsets, size_t);
+        for (int k = 0; k < nsets; k++)
+            scumsizes[k] = (size_t) cumsizes[k];
+        boolvec * nondom = nondom_alloc_true(size);
+        new_size = find_nondominated_union(points, nobj, scumsizes, (size_t) nsets,
+                                           minmax, nondom);
+        int total = cumsizes[nsets - 1];
+        write_sets_filtered (stdout, points, nobj, &total, 1, nondom);
+        if (verbose_flag >= 2)
+            fprintf (stderr, "# sets: %d\n# points: %zu\n# nondominated: %zu\n",
+                     nsets, size, new_size);
+        free(nondom);
+        free(scumsizes);
+    }
+    free(points);
+    free(cumsizes);
+    if (free_minmax) free((void *) minmax);
+}
+
 int main(int argc, char *argv[])
 {
     // See the man page for getopt_long for an explanation of these fields.
@@ -458,6 +616,8 @@ int main(int argc, char *argv[])
         {"union",      no_argument,       NULL, 'U'},
         {"suffix",     required_argument, NULL, 's'},
         {"log",        required_argument, NULL, 'L'},
+        {"stream",     required_argument, NULL, 'S'},
+        {"merge",      optional_argument, NULL, 'm'},
         {NULL, 0, NULL, 0} /* marks end of list */
     };
     set_program_invocation_short_name(argv[0]);
@@ -551,6 +711,31 @@ int main(int argc, char *argv[])
                 fatal_error("invalid argument to --log '%s'", optarg);
             break;
 
+        case 'S': // --stream
+        {
+            char * endp;
+            long long value = strtoll(optarg, &endp, 10);
+            if (endp == optarg || *endp != '\0' || value < 4)
+                fatal_error("invalid argument '%s' for --stream"
+                            ", it should be an integer larger than 3", optarg);
+            stream_size = (size_t) value;
+            filter_flag = true;
+            check_flag  = true;
+            break;
+        }
+
+        case 'm': // --merge
+            if (optarg == NULL || !strcmp (optarg, "union"))
+                merge_mode = MERGE_UNION;
+            else if (!strcmp (optarg, "sum"))
+                merge_mode = MERGE_SUM;
+            else {
+                fatal_error("invalid argument '%s' for --merge"
+                            ", it should be either \'union\' or \'sum\'\n",
+                            optarg);
+            }
+            break;
+
         default:
             default_cmdline_handler(opt);
         }
@@ -562,6 +747,31 @@ int main(int argc, char *argv[])
     }
 
     int numfiles = argc - optind;
+    if (merge_mode != MERGE_NONE) {
+        if (agree || normalise_flag || force_bounds_flag || logarithm
+            || lower_bound || upper_bound || union_flag || stream_size > 0)
+            fatal_error("--merge cannot be combined with --agree, --normalise,"
+                        " --force-bounds, --log, --lower-bound, --upper-bound,"
+                        " --union or --stream");
+        process_files_merge(argv + optind, numfiles, minmax, &nobj,
+                            maximise_all_flag);
+        free((void *) minmax);
+        return EXIT_SUCCESS;
+    }
+
+    if (stream_size > 0) {
+        if (agree || normalise_flag || force_bounds_flag || logarithm
+            || lower_bound || upper_bound)
+            fatal_error("--stream cannot be combined with --agree, --normalise,"
+                        " --force-bounds, --log, --lower-bound or --upper-bound");
+        if (numfiles <= 0)
+            process_file_stream(NULL, minmax, &nobj, maximise_all_flag);
+        for (int k = 0; k < numfiles; k++)
+            process_file_stream(argv[optind + k], minmax, &nobj, maximise_all_flag);
+        free((void *) minmax);
+        return EXIT_SUCCESS;
+    }
+
     double *minimum = NULL;
     double *maximum = NULL;
 
@@ -1,7 +1,8 @@
 #ifndef NONDOMINATED_H
 #define NONDOMINATED_H
 
-#include "config.h"
+#include "libmoocore-config.h"
+#include <stddef.h> // ptrdiff_t
 #include <string.h> // memcpy
 #include <math.h> // INFINITY
 #include "sort.h"
@@ -612,6 +613,51 @@ find_dominated_point_agree_bf(const double * restrict points, size_t size, dimen
     }
 }
 
+#include "nondominated_kung.h"
+#include "nondominated_dispatch.h"
+
+/* Set the smallest number of points for which Kung's algorithm is used
+   instead of brute force when there are more than 3 objectives, when
+   filtering a set (find_set) and when searching for one dominated point
+   (find_dominated).  A value of 0 restores the default.  It may be called
+   while other threads are running the functions of this file.  */
+MOOCORE_API void moocore_set_kung_min_size(size_t find_set, size_t find_dominated);
+// The value set by moocore_set_kung_min_size() or 0 if not set.
+size_t nondom_kung_min_size_override(bool find_dominated);
+
+/**
+   Smallest number of points for which Kung's algorithm is used instead of
+   brute force when there are more than 3 objectives.  By default, it depends
+   on the number of objectives as given by nondominated_dispatch.h, which is
+   generated by calibrate_nondominated ('make calibrate').  Defining
+   KUNG_MIN_SIZE_FIND_SET or KUNG_MIN_SIZE_FIND_DOMINATED at compile time
+   overrides it for any number of objectives, and moocore_set_kung_min_size()
+   overrides both at runtime.
+*/
+static inline size_t
+nondom_kung_min_size(dimension_t dim, bool find_dominated)
+{
+    ASSUME(dim > 3);
+    size_t min_size = nondom_kung_min_size_override(find_dominated);
+    if (min_size == 0) {
+        int k = 0;
+        while (k < NONDOM_DISPATCH_NBUCKETS - 1 && (int) dim > nondom_dispatch_dim_max[k])
+            k++;
+        min_size = find_dominated
+            ? nondom_dispatch_find_dominated[k] : nondom_dispatch_find_set[k];
+#ifdef KUNG_MIN_SIZE_FIND_SET
+        if (!find_dominated)
+            min_size = KUNG_MIN_SIZE_FIND_SET;
+#endif
+#ifdef KUNG_MIN_SIZE_FIND_DOMINATED
+        if (find_dominated)
+            min_size = KUNG_MIN_SIZE_FIND_DOMINATED;
+#endif
+    }
+    // Kung's algorithm requires more than KUNG_SMALL_THRESHOLD points.
+    return MAX(min_size, (size_t) KUNG_SMALL_THRESHOLD + 1);
+}
+
 /* Stop as soon as one dominated point is found and return its position.
 **/
 static inline size_t
@@ -624,13 +670,16 @@ find_dominated_point_(const double * restrict points, size_t size, dimension_t d
         return size;
 
     ASSUME(dim >= 2);
-    if (dim <= 3) {
+    if (dim <= 3 || size >= nondom_kung_min_size(dim, /* find_dominated=*/true)) {
         const double * pp = force_agree_minimize(points, size, &dim, agree, minmax);
+        ASSUME(dim >= 2);
         size_t res;
         if (dim == 2) {
             res = find_dominated_2d_(pp, size, keep_weakly);
-        } else {
+        } else if (dim == 3) {
             res = find_dominated_3d_impl(pp, size, keep_weakly);
+        } else {
+            res = find_dominated_point_kung(pp, size, dim, keep_weakly);
         }
         if (pp != points)
             free((void *) pp);
@@ -645,8 +694,6 @@ find_dominated_point_(const double * restrict points, size_t size, dimension_t d
     return find_dominated_point_agree_bf(points, size, dim, keep_weakly, agree, minmax);
 }
 
-#include "nondominated_kung.h"
-
 /**
    Store which points are nondominated in nondom and return the number of
    nondominated points.
@@ -664,10 +711,7 @@ find_nondominated_set_(const double * restrict points, size_t size, dimension_t
     ASSUME(minmax != NULL);
     ASSUME(nondom != NULL);
 
-    /* FIXME: In theory, for large dim and small n, brute-force may be faster
-       than Kung's algorithm. How to set this threshold requires further
-       investigation.  */
-    if (dim <= 3 || size > KUNG_SMALL_THRESHOLD) {
+    if (dim <= 3 || size >= nondom_kung_min_size(dim, /* find_dominated=*/false)) {
         const double * pp = force_agree_minimize(points, size, &dim, agree, minmax);
         ASSUME(dim >= 2);
         size_t new_size;
@@ -745,8 +789,9 @@ find_nondominated_set(const double * restrict points, size_t size, dimension_t d
     if (new_size > size || new_size == 0 || new_size == SIZE_MAX) { /* This can't happen.  */
         fatal_error ("%s:%d: a bug happened: new_size > old_size!\n"
                      "# size\tnondom\tdom\n"
-                     "  %zu\t%zu\t%zd\n",
-                     __FILE__, __LINE__, size, new_size, size - new_size);
+                     "  %zu\t%zu\t%td\n",
+                     __FILE__, __LINE__, size, new_size,
+                     (ptrdiff_t) size - (ptrdiff_t) new_size);
     }
     return new_size;
 }
@@ -862,6 +907,249 @@ is_nondominated(boolvec * restrict nondom,
     free((void *)minmax);
 }
 
+/**
+   Same as is_nondominated() but dominance is only checked among points that
+   belong to the same set.  Set k is given by rows cumsizes[k-1], ...,
+   cumsizes[k] - 1 of data (with cumsizes[-1] == 0), thus points must be
+   already grouped by set.  This is much faster than calling is_nondominated()
+   for each set when there are many small sets.
+*/
+static inline void
+is_nondominated_within_sets(boolvec * restrict nondom,
+                            const double * restrict data, dimension_t nobj,
+                            const size_t * restrict cumsizes, size_t nsets,
+                            bool keep_weakly, const boolvec * restrict maximise)
+{
+    ASSUME(nobj >= 2);
+    if (nsets == 0)
+        return;
+    const int * minmax = minmax_from_boolvec(maximise, nobj);
+    nondom_init_true(nondom, cumsizes[nsets - 1]);
+    for (size_t k = 0, start = 0; k < nsets; start = cumsizes[k], k++) {
+        assert(start <= cumsizes[k]);
+        is_nondominated_minmax(nondom + start, data + start * nobj,
+                               cumsizes[k] - start, nobj, keep_weakly, minmax);
+    }
+    free((void *)minmax);
+}
+
+/* True if all rows point within the same set, where set k ends just before
+   set_end[k].  */
+static inline bool
+rows_within_one_set(const double ** restrict rows, size_t size,
+                    const double * const * restrict set_end, size_t nsets)
+{
+    const double * lo = rows[0], * hi = rows[0];
+    for (size_t k = 1; k < size; k++) {
+        if (rows[k] < lo) lo = rows[k];
+        else if (rows[k] > hi) hi = rows[k];
+    }
+    // Find the set of lo.
+    size_t a = 0, b = nsets - 1;
+    while (a < b) {
+        size_t mid = a + (b - a) / 2;
+        if (set_end[mid] > lo)
+            b = mid;
+        else
+            a = mid + 1;
+    }
+    return hi < set_end[a];
+}
+
+static size_t
+maxima_union_rec(const double ** restrict rows, size_t size, dimension_t dim,
+                 const double * const * restrict set_end, size_t nsets);
+
+static inline size_t
+maxima_union_half(const double ** restrict rows, size_t size, dimension_t dim,
+                  const double * const * restrict set_end, size_t nsets)
+{
+    if (size <= 1 || rows_within_one_set(rows, size, set_end, nsets))
+        return size;
+    return (size <= KUNG_SMALL_THRESHOLD)
+        ? maxima_brute_force_filter_dom(rows, size, dim, /*keep_weakly=*/false)
+        : maxima_union_rec(rows, size, dim, set_end, nsets);
+}
+
+/* Same as maxima_rec() but the rows are the union of nondominated sets, so a
+   subproblem whose rows all belong to the same set does not need to be
+   solved.  */
+static size_t
+maxima_union_rec(const double ** restrict rows, size_t size, dimension_t dim,
+                 const double * const * restrict set_end, size_t nsets)
+{
+    ASSUME(dim > 3);
+    size_t r_size = half_size_with_duplicates(rows, size);
+    size_t s_size = size - r_size;
+    if (s_size == 0)
+        return maxima_rec_dim(rows, size, dim, /*keep_weakly=*/false);
+
+    const double ** s = rows + r_size;
+    size_t old_r_size = r_size;
+    r_size = maxima_union_half(rows, r_size, dim, set_end, nsets);
+    s_size = maxima_union_half(s, s_size, dim, set_end, nsets);
+    s_size = kung_merge_rec_dim(rows, r_size, s, s_size, dim);
+    size_t new_size = compact_rows(rows, r_size, s, s_size, old_r_size);
+    assert(check_nondom(rows, new_size));
+    return new_size;
+}
+
+/**
+   Mark in nondom (which must be already initialized to all true) the points
+   that are nondominated in the union of nsets sets, and return their number.
+   Set k is given by rows cumsizes[k-1], ..., cumsizes[k] - 1 of points (with
+   cumsizes[-1] == 0).  Each set must be already nondominated, so Kung's
+   divide-and-conquer skips any subproblem whose points come from a single
+   set.  As in find_nondominated_set(), only the first copy of duplicated
+   points is kept.
+
+   Based on: Kathrin Klamroth, Bruno Lang, Michael Stiglmayr. Efficient
+   dominance filtering for unions and Minkowski sums of non-dominated sets.
+   Computers & Operations Research, 163:106506, 2024.
+*/
+static inline size_t
+find_nondominated_union(const double * restrict points, dimension_t dim,
+                        const size_t * restrict cumsizes, size_t nsets,
+                        const int * restrict minmax, boolvec * restrict nondom)
+{
+    ASSUME(dim >= 2);
+    if (nsets == 0)
+        return 0;
+    const size_t size = cumsizes[nsets - 1];
+    if (size < 2 || nsets == 1)
+        return size;
+
+    dimension_t new_dim = 0;
+    for (dimension_t d = 0; d < dim; d++)
+        new_dim = (dimension_t) (new_dim + (minmax[d] != 0));
+    // The 2D and 3D algorithms are already O(n log n).
+    if (new_dim <= 3)
+        return find_nondominated_set(points, size, dim, minmax, nondom);
+
+    const double * pp = force_agree_minimize(points, size, &dim, AGREE_NONE, minmax);
+    ASSUME(dim == new_dim);
+    const double ** set_end = MOOCORE_MALLOC(nsets, const double *);
+    for (size_t k = 0; k < nsets; k++)
+        set_end[k] = pp + cumsizes[k] * dim;
+    const double ** rows = generate_row_pointers(pp, size, dim);
+    radix_sort_asc_1d(rows, size);
+    size_t new_size = maxima_union_half(rows, size, dim, set_end, nsets);
+    if (new_size < size) {
+        memset(nondom, 0, size * sizeof(*nondom));
+        for (size_t k = 0; k < new_size; k++)
+            nondom[row_index_from_ptr(pp, rows[k], dim)] = true;
+    }
+    free(rows);
+    free(set_end);
+    if (pp != points)
+        free((void *) pp);
+    return new_size;
+}
+
+typedef struct {
+    double f1, f2;
+    size_t a, b;
+} minkowski_heap_t;
+
+static inline void
+minkowski_heap_sift_down(minkowski_heap_t * restrict heap, size_t size, size_t k)
+{
+    minkowski_heap_t x = heap[k];
+    while (true) {
+        size_t child = 2 * k + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size
+            && cmp_double_asc_x_asc_y(heap[child + 1].f1, heap[child + 1].f2,
+                                      heap[child].f1, heap[child].f2) < 0)
+            child++;
+        if (cmp_double_asc_x_asc_y(heap[child].f1, heap[child].f2, x.f1, x.f2) >= 0)
+            break;
+        heap[k] = heap[child];
+        k = child;
+    }
+    heap[k] = x;
+}
+
+static inline double *
+minkowski_copy_sorted_2d(const double * restrict points, size_t size,
+                         const double * restrict sign)
+{
+    double * p = MOOCORE_MALLOC(2 * size, double);
+    for (size_t k = 0; k < size; k++) {
+        p[2 * k] = sign[0] * points[2 * k];
+        p[2 * k + 1] = sign[1] * points[2 * k + 1];
+    }
+    qsort(p, size, 2 * sizeof(*p), qsort_cmp_pdouble_asc_x_asc_y);
+    return p;
+}
+
+/**
+   Compute the nondominated points of the Minkowski sum {a + b : a in A, b in
+   B} of two bi-objective sets, store them in a newly allocated *result_p,
+   sorted by the first objective, and return their number.  Duplicated sums
+   are returned only once.
+
+   The sums are generated lazily in lexicographic order by merging the |A|
+   sorted chains a + B with a heap, which takes O(|A| |B| log |A|) time but
+   only O(|A| + |B|) memory besides the output.  It is faster when A is the
+   smaller set.  A and B do not need to be nondominated.
+*/
+static inline size_t
+minkowski_sum_nondominated_2d(double ** restrict result_p,
+                              const double * restrict a, size_t a_size,
+                              const double * restrict b, size_t b_size,
+                              const int * restrict minmax)
+{
+    ASSUME(minmax[0] != 0 && minmax[1] != 0);
+    *result_p = NULL;
+    if (a_size == 0 || b_size == 0)
+        return 0;
+    const double sign[] = { minmax[0] < 0 ? 1.0 : -1.0, minmax[1] < 0 ? 1.0 : -1.0 };
+    double * sa = minkowski_copy_sorted_2d(a, a_size, sign);
+    double * sb = minkowski_copy_sorted_2d(b, b_size, sign);
+    minkowski_heap_t * heap = MOOCORE_MALLOC(a_size, minkowski_heap_t);
+    // Sorted by construction, so it is already a heap.
+    for (size_t i = 0; i < a_size; i++) {
+        heap[i].f1 = sa[2 * i] + sb[0];
+        heap[i].f2 = sa[2 * i + 1] + sb[1];
+        heap[i].a = i;
+        heap[i].b = 0;
+    }
+    size_t heap_size = a_size;
+    size_t result_cap = a_size + b_size, new_size = 0;
+    double * result = MOOCORE_MALLOC(2 * result_cap, double);
+    double best_f2 = INFINITY;
+    while (heap_size > 0) {
+        minkowski_heap_t * top = heap;
+        if (top->f2 < best_f2) {
+            best_f2 = top->f2;
+            if (new_size == result_cap) {
+                result_cap *= 2;
+                result = realloc(result, 2 * result_cap * sizeof(*result));
+            }
+            result[2 * new_size] = sign[0] * top->f1;
+            result[2 * new_size + 1] = sign[1] * top->f2;
+            new_size++;
+        }
+        size_t j = top->b + 1;
+        if (j < b_size) {
+            const double * pa = sa + 2 * top->a;
+            top->f1 = pa[0] + sb[2 * j];
+            top->f2 = pa[1] + sb[2 * j + 1];
+            top->b = j;
+        } else {
+            heap[0] = heap[--heap_size];
+        }
+        minkowski_heap_sift_down(heap, heap_size, 0);
+    }
+    free(heap);
+    free(sb);
+    free(sa);
+    *result_p = realloc(result, 2 * new_size * sizeof(*result));
+    return new_size;
+}
+
 static inline void
 agree_objectives (double * restrict points, size_t size, dimension_t dim,
                   const enum objs_agree_t agree, const int * restrict minmax)
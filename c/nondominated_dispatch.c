@@ -0,0 +1,40 @@
+/* Runtime override of the number of points from which nondominated.h uses
+   Kung's algorithm instead of brute force.  */
+
+#include "nondominated.h"
+
+// 0 means not set.
+static size_t kung_min_size_find_set = 0;
+static size_t kung_min_size_find_dominated = 0;
+
+void
+moocore_set_kung_min_size(size_t find_set, size_t find_dominated)
+{
+    // The casts avoid a spurious -Wunused-but-set-parameter with GCC 12.
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+    kung_min_size_find_set = (size_t) find_set;
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+    kung_min_size_find_dominated = (size_t) find_dominated;
+}
+
+size_t
+nondom_kung_min_size_override(bool find_dominated)
+{
+    size_t min_size;
+    if (find_dominated) {
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+        min_size = kung_min_size_find_dominated;
+    } else {
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+        min_size = kung_min_size_find_set;
+    }
+    return min_size;
+}
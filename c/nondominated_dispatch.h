@@ -0,0 +1,15 @@
+#ifndef NONDOMINATED_DISPATCH_H
+#define NONDOMINATED_DISPATCH_H
+/* Generated by calibrate_nondominated (see 'make calibrate').  */
+
+/* With more than 3 objectives, nondominated.h uses brute force instead
+   of Kung's algorithm for fewer points than nondom_dispatch_find_set[k],
+   or nondom_dispatch_find_dominated[k] in find_dominated_point(), where k
+   is the first bucket such that the number of objectives is at most
+   nondom_dispatch_dim_max[k], or the last bucket if there is none.  */
+#define NONDOM_DISPATCH_NBUCKETS 4
+static const int nondom_dispatch_dim_max[] = { 5, 8, 12, 16 };
+static const size_t nondom_dispatch_find_set[] = { 24, 17, 17, 17 };
+static const size_t nondom_dispatch_find_dominated[] = { 48, 17, 17, 17 };
+
+#endif // NONDOMINATED_DISPATCH_H
@@ -762,6 +762,121 @@ find_nondominated_set_kung(const double * restrict points,
     return new_size;
 }
 
+/*
+   Early-exit variants of maxima_rec() and friends.  They return a pointer to a
+   dominated row as soon as one is found, or NULL if there is none.  Since they
+   stop at the first dominated row, nothing is ever filtered and rows keep the
+   same order after each call that returns NULL.
+*/
+static const double * maxima_find_dominated_rec(const double ** rows, size_t size,
+                                                dimension_t dim, bool keep_weakly);
+
+static const double *
+maxima_find_dominated_bf(const double ** restrict rows, size_t size,
+                         dimension_t dim, bool keep_weakly)
+{
+    for (size_t j = 1; j < size; j++) {
+        for (size_t k = 0; k < j; k++) {
+            dominance_cmp_t res = vec_cmp_dominance(rows[k], rows[j], dim, keep_weakly);
+            if (likely(res == VEC_INCOMPARABLE))
+                continue;
+            return (res == VEC_A_LT_B) ? rows[j] : rows[k];
+        }
+    }
+    return NULL;
+}
+
+static const double *
+maxima_find_dominated_rec_dim(const double ** rows, size_t size, dimension_t dim,
+                              bool keep_weakly)
+{
+    const double ** r_new = (const double **) malloc(size * sizeof(*rows));
+    shift_to_next_dimension(r_new, rows, size);
+    const double * dominated;
+    if (dim == 4) {
+        radix_sort_asc_rev_3d(r_new, size);
+        size_t pos = keep_weakly // Help GCC generate specialized code for true/false.
+            ? find_nondominated_3d_impl_sorted(r_new, size,  true, /* find_dominated=*/true)
+            : find_nondominated_3d_impl_sorted(r_new, size, false, /* find_dominated=*/true);
+        dominated = (pos < size) ? r_new[pos] : NULL;
+    } else {
+        radix_sort_asc_1d(r_new, size);
+        dominated = (size <= KUNG_SMALL_THRESHOLD)
+            ? maxima_find_dominated_bf(r_new, size, dim - 1, keep_weakly)
+            : maxima_find_dominated_rec(r_new, size, dim - 1, keep_weakly);
+    }
+    free(r_new);
+    return dominated ? dominated - 1 : NULL;
+}
+
+DEFINE_QSORT_CMP(cmp_ppdouble_address_asc, double **)
+{
+    return (*a < *b) ? -1 : ((*a > *b) ? 1 : 0);
+}
+
+// Find a row of S dominated by a row of R, assuming R and S are nondominated.
+static const double *
+kung_merge_find_dominated(const double ** restrict r, size_t r_size,
+                          const double ** restrict s, size_t s_size,
+                          dimension_t dim)
+{
+    const double ** s_copy = (const double **) malloc(s_size * sizeof(*s));
+    memcpy(s_copy, s, s_size * sizeof(*s));
+    size_t new_size = kung_merge_rec_dim(r, r_size, s, s_size, dim);
+    const double * dominated = NULL;
+    if (new_size < s_size) {
+        // Find the row of s_copy that is not in s.
+        qsort_typesafe(s_copy, s_size, cmp_ppdouble_address_asc);
+        qsort_typesafe(s, new_size, cmp_ppdouble_address_asc);
+        size_t k = 0;
+        while (k < new_size && s[k] == s_copy[k])
+            k++;
+        dominated = s_copy[k];
+    }
+    free(s_copy);
+    return dominated;
+}
+
+static const double *
+maxima_find_dominated_rec(const double ** restrict rows, size_t size, dimension_t dim,
+                          bool keep_weakly)
+{
+    ASSUME(dim > 3);
+    size_t r_size = half_size_with_duplicates(rows, size);
+    size_t s_size = size - r_size;
+    if (s_size == 0)
+        return maxima_find_dominated_rec_dim(rows, size, dim, keep_weakly);
+
+    const double ** s = rows + r_size;
+    const double * dominated = (r_size <= KUNG_SMALL_THRESHOLD)
+        ? maxima_find_dominated_bf(rows, r_size, dim, keep_weakly)
+        : maxima_find_dominated_rec(rows, r_size, dim, keep_weakly);
+    if (dominated)
+        return dominated;
+    dominated = (s_size <= KUNG_SMALL_THRESHOLD)
+        ? maxima_find_dominated_bf(s, s_size, dim, keep_weakly)
+        : maxima_find_dominated_rec(s, s_size, dim, keep_weakly);
+    if (dominated)
+        return dominated;
+    // Both halves are nondominated, so only rows of S may be dominated by
+    // rows of R.
+    return kung_merge_find_dominated(rows, r_size, s, s_size, dim);
+}
+
+/* Return the position of a dominated point or size if there is none.  */
+static inline size_t
+find_dominated_point_kung(const double * restrict points, size_t size,
+                          dimension_t dim, bool keep_weakly)
+{
+    ASSUME(size > KUNG_SMALL_THRESHOLD);
+    ASSUME(dim > 3);
+    const double ** rows = generate_row_pointers(points, size, dim);
+    radix_sort_asc_1d(rows, size);
+    const double * dominated = maxima_find_dominated_rec(rows, size, dim, keep_weakly);
+    free(rows);
+    return dominated ? row_index_from_ptr(points, dominated, dim) : size;
+}
+
 #undef KUNG_MERGE_THRESHOLD
 
 #endif // NONDOMINATED_KUNG_H
@@ -0,0 +1,335 @@
+#ifndef NONDOMINATED_STREAM_H
+#define NONDOMINATED_STREAM_H
+/*****************************************************************************
+
+ Out-of-core filtering of dominated points.
+
+ Points are pushed in chunks and merged into a running nondominated buffer.
+ When the buffer grows larger than the memory budget, it is spilled to a
+ temporary file (a "run") and a new buffer is started.  When all points have
+ been pushed, each run is filtered against every other run, two runs at a
+ time, so at most two runs are kept in memory.
+
+ The output is identical to find_nondominated_set(): dominated points are
+ removed, only the first copy of duplicated points is kept and the input order
+ of the remaining points is preserved.
+
+*****************************************************************************/
+#include <stdio.h>
+#include <errno.h>
+#include "common.h"
+#include "nondominated.h"
+
+typedef void (*nondom_stream_emit_t)(void * ctx, const double * points,
+                                     size_t size, dimension_t nobj);
+
+typedef struct {
+    FILE * file;
+    size_t size;
+} nondom_stream_run_t;
+
+typedef struct {
+    dimension_t nobj; // Number of objectives of the input.
+    dimension_t dim; // Number of objectives that are compared.
+    int minmax[MOOCORE_DIMENSION_MAX];
+    const int * minmax_min; // All minimised, for the transformed data.
+    size_t chunk_size; // Maximum number of points merged at once.
+    size_t run_size; // The buffer is spilled when it reaches this size.
+    size_t cap; // run_size + chunk_size.
+    // Original points (nobj columns) and transformed points (dim columns, all
+    // minimised).  Both have space for 3 * cap rows: the buffer and a chunk
+    // during the streaming phase, and two runs (one at offset cap and the
+    // other just before or after it) during the final phase.
+    double * odata;
+    double * tdata;
+    boolvec * nondom;
+    boolvec * keep; // Scratch for the marks of one run.
+    const double ** rows;
+    size_t size; // Number of points in the buffer.
+    size_t npoints; // Number of points pushed.
+    nondom_stream_run_t * runs;
+    size_t nruns;
+} nondom_stream_t;
+
+/**
+   Create a new stream for points with nobj objectives.  minmax has the same
+   meaning as in find_nondominated_set().  At most about max_points points are
+   kept in memory.
+*/
+static inline nondom_stream_t *
+nondom_stream_new(dimension_t nobj, const int * restrict minmax, size_t max_points)
+{
+    ASSUME(nobj >= 2);
+    nondom_stream_t * s = MOOCORE_MALLOC(1, nondom_stream_t);
+    s->nobj = nobj;
+    s->dim = 0;
+    for (dimension_t d = 0; d < nobj; d++) {
+        s->minmax[d] = minmax[d];
+        s->dim = (dimension_t) (s->dim + (minmax[d] != 0));
+    }
+    if (s->dim < 2)
+        fatal_error("at least two objectives must be compared");
+    s->minmax_min = minmax_minimise(s->dim);
+    s->chunk_size = (max_points < 12) ? 2 : max_points / 6;
+    s->run_size = s->chunk_size;
+    s->cap = s->run_size + s->chunk_size;
+    s->odata = MOOCORE_MALLOC(3 * s->cap * nobj, double);
+    s->tdata = MOOCORE_MALLOC(3 * s->cap * s->dim, double);
+    s->nondom = MOOCORE_MALLOC(3 * s->cap, boolvec);
+    s->keep = MOOCORE_MALLOC(s->cap, boolvec);
+    s->rows = MOOCORE_MALLOC(3 * s->cap, const double *);
+    s->size = 0;
+    s->npoints = 0;
+    s->runs = NULL;
+    s->nruns = 0;
+    return s;
+}
+
+static inline void
+nondom_stream_free(nondom_stream_t * s)
+{
+    for (size_t k = 0; k < s->nruns; k++)
+        fclose(s->runs[k].file);
+    free(s->runs);
+    free(s->rows);
+    free(s->keep);
+    free(s->nondom);
+    free(s->tdata);
+    free(s->odata);
+    free((void *) s->minmax_min);
+    free(s);
+}
+
+/* Copy the compared objectives of size points to tdata, negating maximised
+   ones.  */
+static inline void
+nondom_stream_transform(const nondom_stream_t * restrict s,
+                        double * restrict tdata,
+                        const double * restrict odata, size_t size)
+{
+    const dimension_t nobj = s->nobj, dim = s->dim;
+    for (size_t k = 0; k < size; k++) {
+        const double * restrict src = odata + k * nobj;
+        double * restrict dst = tdata + k * dim;
+        for (dimension_t d = 0, t = 0; d < nobj; d++) {
+            if (s->minmax[d] == 0) continue;
+            dst[t++] = (s->minmax[d] < 0) ? src[d] : -src[d];
+        }
+    }
+}
+
+/* Move the points at [offset, offset+size) marked in nondom to the front,
+   preserving their order.  Return the new size.  */
+static inline size_t
+nondom_stream_compact(nondom_stream_t * restrict s, size_t dest, size_t offset,
+                      size_t size)
+{
+    const dimension_t nobj = s->nobj, dim = s->dim;
+    size_t n = dest;
+    for (size_t k = offset; k < offset + size; k++) {
+        if (!s->nondom[k]) continue;
+        if (n != k) {
+            memcpy(s->odata + n * nobj, s->odata + k * nobj, nobj * sizeof(double));
+            memcpy(s->tdata + n * dim, s->tdata + k * dim, dim * sizeof(double));
+        }
+        n++;
+    }
+    return n - dest;
+}
+
+/* Sorted row pointers to the rows in [offset, offset+size) marked in nondom.  */
+static inline size_t
+nondom_stream_sorted_rows(nondom_stream_t * restrict s, const double ** rows,
+                          size_t offset, size_t size)
+{
+    size_t n = 0;
+    for (size_t k = offset; k < offset + size; k++)
+        if (s->nondom[k])
+            rows[n++] = s->tdata + k * s->dim;
+    radix_sort_asc_1d(rows, n);
+    return n;
+}
+
+/* Mark as dominated the points of S at [s_offset, s_offset+s_size) that are
+   weakly dominated by a point of R at [r_offset, r_offset+r_size).  Both R and
+   S must be nondominated (considering only the marked points).  Only
+   valid for dim > 3.  */
+static inline void
+nondom_stream_kung_filter(nondom_stream_t * restrict s,
+                          size_t r_offset, size_t r_size,
+                          size_t s_offset, size_t s_size)
+{
+    ASSUME(s->dim > 3);
+    const double ** r_rows = s->rows;
+    r_size = nondom_stream_sorted_rows(s, r_rows, r_offset, r_size);
+    const double ** s_rows = s->rows + r_size;
+    size_t old_s_size = nondom_stream_sorted_rows(s, s_rows, s_offset, s_size);
+    if (r_size == 0 || old_s_size == 0)
+        return;
+    size_t new_s_size = kung_merge(r_rows, r_size, s_rows, old_s_size, s->dim);
+    if (new_s_size == old_s_size)
+        return;
+    memset(s->nondom + s_offset, 0, s_size * sizeof(*s->nondom));
+    for (size_t k = 0; k < new_s_size; k++)
+        s->nondom[row_index_from_ptr(s->tdata, s_rows[k], s->dim)] = true;
+}
+
+/* Filter the size points at offset, which were just appended to the buffer,
+   and merge them with the buffer.  */
+static inline void
+nondom_stream_merge(nondom_stream_t * restrict s, size_t offset, size_t size)
+{
+    ASSUME(offset == s->size);
+    const dimension_t dim = s->dim;
+    if (dim <= 3 || offset == 0) {
+        // The 2D and 3D algorithms are O(n log n), so it is cheaper to filter
+        // everything at once.  The buffer goes first, so duplicates in the
+        // new points are removed.
+        size_t total = offset + size;
+        nondom_init_true(s->nondom, total);
+        size_t new_size = find_nondominated_set(s->tdata, total, dim,
+                                                s->minmax_min, s->nondom);
+        if (new_size < total)
+            s->size = nondom_stream_compact(s, 0, 0, total);
+        else
+            s->size = total;
+        return;
+    }
+    nondom_init_true(s->nondom, offset + size);
+    find_nondominated_set(s->tdata + offset * dim, size, dim, s->minmax_min,
+                          s->nondom + offset);
+    // Remove new points dominated by or equal to points in the buffer.
+    nondom_stream_kung_filter(s, 0, offset, offset, size);
+    // Remove points in the buffer dominated by the new points.
+    nondom_stream_kung_filter(s, offset, size, 0, offset);
+    size_t n = nondom_stream_compact(s, 0, 0, offset);
+    s->size = n + nondom_stream_compact(s, n, offset, size);
+}
+
+static inline void
+nondom_stream_spill(nondom_stream_t * restrict s)
+{
+    if (s->size == 0)
+        return;
+    FILE * file = tmpfile();
+    if (file == NULL)
+        fatal_error("cannot create temporary file: %s", strerror(errno));
+    if (fwrite(s->odata, sizeof(double) * s->nobj, s->size, file) != s->size)
+        fatal_error("cannot write to temporary file: %s", strerror(errno));
+    s->runs = realloc(s->runs, (s->nruns + 1) * sizeof(*s->runs));
+    s->runs[s->nruns].file = file;
+    s->runs[s->nruns].size = s->size;
+    s->nruns++;
+    s->size = 0;
+}
+
+static inline void
+nondom_stream_load(nondom_stream_t * restrict s, size_t run, size_t offset)
+{
+    FILE * file = s->runs[run].file;
+    size_t size = s->runs[run].size;
+    assert(offset + size <= 3 * s->cap);
+    double * odata = s->odata + offset * s->nobj;
+    rewind(file);
+    if (fread(odata, sizeof(double) * s->nobj, size, file) != size)
+        fatal_error("cannot read from temporary file: %s", strerror(errno));
+    nondom_stream_transform(s, s->tdata + offset * s->dim, odata, size);
+}
+
+/**
+   Add size points to the stream.
+*/
+static inline void
+nondom_stream_push(nondom_stream_t * restrict s, const double * restrict points,
+                   size_t size)
+{
+    const dimension_t nobj = s->nobj;
+    while (size > 0) {
+        size_t n = MIN(size, s->chunk_size);
+        size_t offset = s->size;
+        memcpy(s->odata + offset * nobj, points, n * nobj * sizeof(double));
+        nondom_stream_transform(s, s->tdata + offset * s->dim, points, n);
+        nondom_stream_merge(s, offset, n);
+        if (s->size >= s->run_size)
+            nondom_stream_spill(s);
+        s->npoints += n;
+        points += n * nobj;
+        size -= n;
+    }
+}
+
+/**
+   Call emit() with the nondominated points (possibly several times with
+   consecutive subsets), in input order, and return their number.  The stream
+   is then ready to accept a new set of points.
+*/
+static inline size_t
+nondom_stream_finish(nondom_stream_t * restrict s, nondom_stream_emit_t emit,
+                     void * ctx)
+{
+    size_t total = 0;
+    if (s->nruns == 0) {
+        if (s->size > 0)
+            emit(ctx, s->odata, s->size, s->nobj);
+        total = s->size;
+        goto finish;
+    }
+    nondom_stream_spill(s);
+    const size_t cap = s->cap;
+    const dimension_t dim = s->dim;
+    for (size_t i = 0; i < s->nruns; i++) {
+        // Run i is loaded at cap, earlier runs just before it and later runs
+        // just after it, so that the 2D/3D algorithms see the points in input
+        // order and keep only the first copy of duplicated points.
+        const size_t i_size = s->runs[i].size;
+        nondom_stream_load(s, i, cap);
+        boolvec * restrict nondom_i = s->nondom + cap;
+        nondom_init_true(nondom_i, i_size);
+        for (size_t j = 0; j < s->nruns; j++) {
+            if (j == i) continue;
+            const size_t j_size = s->runs[j].size;
+            const size_t j_offset = (j < i) ? cap - j_size : cap + i_size;
+            nondom_stream_load(s, j, j_offset);
+            nondom_init_true(s->nondom + j_offset, j_size);
+            if (dim <= 3) {
+                // find_nondominated_set() overwrites the marks of run i, so
+                // accumulate them separately.
+                memcpy(s->keep, nondom_i, i_size * sizeof(*nondom_i));
+                nondom_init_true(nondom_i, i_size);
+                size_t offset = MIN(j_offset, cap);
+                find_nondominated_set(s->tdata + offset * dim, i_size + j_size,
+                                      dim, s->minmax_min, s->nondom + offset);
+                for (size_t k = 0; k < i_size; k++)
+                    nondom_i[k] = nondom_i[k] && s->keep[k];
+            } else if (j < i) {
+                nondom_stream_kung_filter(s, j_offset, j_size, cap, i_size);
+            } else {
+                // Remove the copies of points of run i first, so they are not
+                // removed from run i.
+                nondom_stream_kung_filter(s, cap, i_size, j_offset, j_size);
+                nondom_stream_kung_filter(s, j_offset, j_size, cap, i_size);
+            }
+            bool any_nondom = false;
+            for (size_t k = 0; k < i_size && !any_nondom; k++)
+                any_nondom = nondom_i[k];
+            if (!any_nondom)
+                break;
+        }
+        size_t n = nondom_stream_compact(s, cap, cap, i_size);
+        if (n > 0)
+            emit(ctx, s->odata + cap * s->nobj, n, s->nobj);
+        total += n;
+    }
+
+finish:
+    for (size_t k = 0; k < s->nruns; k++)
+        fclose(s->runs[k].file);
+    free(s->runs);
+    s->runs = NULL;
+    s->nruns = 0;
+    s->size = 0;
+    s->npoints = 0;
+    return total;
+}
+
+#endif // NONDOMINATED_STREAM_H
@@ -0,0 +1,169 @@
+#include <stdlib.h>
+#include <math.h>
+#include "common.h"
+#include "r2_approx.h"
+#include "hvapprox_priv.h"
+
+/******************************************************************************
+ R2 indicator approximated by a finite set of weight vectors.
+
+ Let y = a - ref (clipped at zero).  The R2 indicator is the average, over the
+ weight vectors w, of the Tchebycheff utility of the best point:
+
+   R2(A) = 1/|W| * sum_{w in W} min_{a in A} max_k w_k y_k
+
+ If the weights are uniformly distributed on the unit simplex, this converges
+ to the value computed by r2_exact().
+******************************************************************************/
+
+/* Map u in [0,1)^(dim-1) to the unit simplex, such that uniformly distributed
+   u give uniformly distributed weights.  Each weight is the fraction of the
+   remaining mass taken by a Beta(1, dim - 1 - k) variable (stick-breaking).  */
+static void
+simplex_mapping(double * restrict w, dimension_t dim, const double * restrict u)
+{
+    ASSUME(2 <= dim && dim <= MOOCORE_HVAPPROX_DIMENSION_MAX);
+    double remaining = 1.;
+    for (dimension_t k = 0; k < dim - 1; k++) {
+        double t = pow(u[k], 1. / (dim - 1 - k));
+        w[k] = remaining * (1. - t);
+        remaining *= t;
+    }
+    w[dim - 1] = remaining;
+}
+
+void
+r2_weights_rphi(double * restrict weights, dimension_t dim, uint_fast32_t nweights)
+{
+    ASSUME(2 <= dim && dim <= MOOCORE_HVAPPROX_DIMENSION_MAX);
+    const long double * alpha = Rphi_init(dim - 1);
+    double * u = malloc((dim - 1) * sizeof(*u));
+    const double seed = 0.5;
+    for (dimension_t d = 0; d < dim - 1; d++)
+        u[d] = seed;
+    for (uint_fast32_t j = 0; j < nweights; j++) {
+        Rphi_next(u, dim - 1, alpha);
+        simplex_mapping(weights + j * dim, dim, u);
+    }
+    free(u);
+    free((void *)alpha);
+}
+
+void
+r2_weights_hua_wang(double * restrict weights, dimension_t dim, uint_fast32_t nweights)
+{
+    ASSUME(2 <= dim && dim <= MOOCORE_HVAPPROX_DIMENSION_MAX);
+    const uint_fast32_t * polar_a = construct_polar_a(dim - 1, nweights);
+    long double * sample = malloc((dim - 1) * sizeof(*sample));
+    double * u = malloc((dim - 1) * sizeof(*u));
+    for (uint_fast32_t j = 0; j < nweights; j++) {
+        compute_polar_sample(sample, dim - 1, j, nweights, polar_a);
+        for (dimension_t d = 0; d < dim - 1; d++)
+            u[d] = STATIC_CAST(double, sample[d]);
+        simplex_mapping(weights + j * dim, dim, u);
+    }
+    free(u);
+    free(sample);
+    free((void *) polar_a);
+}
+
+static double *
+transform_points(const double * restrict data, size_t npoints, dimension_t dim,
+                 const double * restrict ref)
+{
+    double * y = MOOCORE_MALLOC(npoints * dim, double);
+    for (size_t i = 0; i < npoints; i++)
+        for (dimension_t k = 0; k < dim; k++)
+            y[i * dim + k] = MAX(data[i * dim + k] - ref[k], 0.);
+    return y;
+}
+
+__attribute__((hot))
+_attr_optimize_finite_math // Required so that GCC will vectorize the inner loop.
+static double
+get_min_utility(const double * restrict y, size_t npoints, dimension_t dim,
+                const double * restrict w)
+{
+    ASSUME(2 <= dim);
+    ASSUME(npoints > 0);
+    /* Same blocking as get_expected_value() in hvapprox.c, with the roles of
+       min and max exchanged.  */
+    enum { BLOCK_SIZE = 16 };
+    double min_u = INFINITY;
+    size_t i = 0;
+    for (; i + BLOCK_SIZE <= npoints; i += BLOCK_SIZE) {
+        // y >= 0 && w >= 0 so the utility cannot be < 0.
+        double max_u[BLOCK_SIZE];
+        for (size_t j = 0; j < BLOCK_SIZE; j++)
+            max_u[j] = 0;
+
+        const double * restrict base = y + i * dim;
+        for (dimension_t k = 0; k < dim; k++) {
+            double w_k = w[k];
+            const double * restrict pk = base + k;
+            for (size_t j = 0; j < BLOCK_SIZE; j++) {
+                double u = pk[j * dim] * w_k;
+                max_u[j] = MAX(u, max_u[j]);
+            }
+        }
+
+        for (size_t j = 0; j < BLOCK_SIZE; j++)
+            min_u = MIN(min_u, max_u[j]);
+    }
+    // Scalar tail.
+    for (; i < npoints; i++) {
+        const double * restrict p = y + i * dim;
+        double u = p[0] * w[0];
+        if (likely(u >= min_u))
+            continue;
+        for (dimension_t k = 1; k < dim; k++)
+            u = MAX(u, p[k] * w[k]);
+        min_u = MIN(min_u, u);
+    }
+    ASSUME(min_u >= 0);
+    return min_u;
+}
+
+static double
+r2_approx_transformed(const double * restrict y, size_t npoints, dimension_t dim,
+                      const double * restrict weights, size_t nweights)
+{
+    if (unlikely(npoints == 0)) return -1;
+    double r2 = 0;
+    for (size_t j = 0; j < nweights; j++)
+        r2 += get_min_utility(y, npoints, dim, weights + j * dim);
+    return r2 / (double) nweights;
+}
+
+double
+r2_approx(const double * restrict data, size_t npoints, dimension_t dim,
+          const double * restrict ref, const double * restrict weights, size_t nweights)
+{
+    ASSUME(dim >= 2);
+    if (unlikely(npoints == 0)) return -1;
+    double * y = transform_points(data, npoints, dim, ref);
+    double r2 = r2_approx_transformed(y, npoints, dim, weights, nweights);
+    free(y);
+    return r2;
+}
+
+void
+r2_approx_sets(double * restrict r2, const double * restrict data, dimension_t dim,
+               const size_t * restrict cumsizes, size_t nsets,
+               const double * restrict ref, const double * restrict weights, size_t nweights)
+{
+    ASSUME(dim >= 2);
+    if (unlikely(nsets == 0)) return;
+    // Transform all points at once. Each set is then small enough to remain in
+    // cache while it is evaluated for all weights.
+    double * y = transform_points(data, cumsizes[nsets - 1], dim, ref);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t k = 0; k < nsets; k++) {
+        const size_t start = (k == 0) ? 0 : cumsizes[k - 1];
+        r2[k] = r2_approx_transformed(y + start * dim, cumsizes[k] - start, dim,
+                                      weights, nweights);
+    }
+    free(y);
+}
@@ -0,0 +1,38 @@
+/*************************************************************************
+
+ r2_approx.h
+
+*************************************************************************/
+#ifndef R2_APPROX_H_
+#define R2_APPROX_H_
+
+#include <stdbool.h>
+#include <stdint.h> // uint_fast32_t
+#include "libmoocore-config.h"
+
+// C++ needs to know that types and declarations are C, not C++.
+BEGIN_C_DECLS
+
+/* Fill weights (nweights * nobjs, row-major) with weight vectors on the unit
+   simplex generated from the R_phi sequence or from the good lattice points of
+   Hua and Wang.  */
+MOOCORE_API void r2_weights_rphi(double * restrict weights, dimension_t nobjs,
+                                 uint_fast32_t nweights);
+MOOCORE_API void r2_weights_hua_wang(double * restrict weights, dimension_t nobjs,
+                                     uint_fast32_t nweights);
+
+/* R2 indicator of the points with respect to the ideal point ref, averaged
+   over the given Tchebycheff weight vectors, assuming minimisation.  As in
+   r2_exact(), coordinates smaller than ref are treated as equal to it.  */
+MOOCORE_API double r2_approx(
+    const double * restrict data, size_t npoints, dimension_t nobjs,
+    const double * restrict ref, const double * restrict weights, size_t nweights);
+/* r2[k] is the R2 of set k, given by rows cumsizes[k-1], ..., cumsizes[k] - 1
+   of data (with cumsizes[-1] == 0).  */
+MOOCORE_API void r2_approx_sets(
+    double * restrict r2, const double * restrict data, dimension_t nobjs,
+    const size_t * restrict cumsizes, size_t nsets,
+    const double * restrict ref, const double * restrict weights, size_t nweights);
+
+END_C_DECLS
+#endif // R2_APPROX_H_
@@ -1,8 +1,11 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <float.h>
+#include <math.h>
 #include "common.h"
 #include "sort.h"
+#include "radixsort.h"
+#include "r2_exact.h"
 
 // Computes (two times) the utility of axis-parallel segment between y1, y2, and y2p.
 static double _utility(const double y1, const double y2, const double y2p)
@@ -22,47 +25,29 @@ static double _utility(const double y1, const double y2, const double y2p)
     return y1 * (wp * wp - w * w);
 }
 
-double r2_exact(const double * restrict data, size_t n, dimension_t dim,
-                const double * restrict ref)
+/* Exact R2 of n bi-objective points sorted by the first objective
+   (primarily) and the second one (secondarily) in ascending order.  The
+   coordinates of point j are ROW(j)[X] and ROW(j)[Y], where ROW(j) is p[j] or,
+   if p is NULL, the j-th row of data.  Thus, no memory is allocated here.  */
+static inline double
+r2_exact_2d_sorted(const double * restrict data, const double ** restrict p,
+                   size_t n, const double * restrict ref,
+                   const dimension_t X, const dimension_t Y)
 {
-    assert(dim == 2);
-    if (unlikely(n == 0)) return -1;
-
-    // p is sorted by f1 (primarily), then f2 (secondarily)
-    const double ** p = generate_row_pointers_asc_x_asc_y(data, n);
-    if (unlikely(!p)) return -1;
-
-    size_t j = 0;
-    // skip points not dominated by "ideal" ref point
-    while (j < n && p[j][0] < ref[0]) {
-        j++;
-    }
-
-    // no points to evaluate
-    if (unlikely(j == n)) {
-        if (p[j - 1][1] <= ref[1]) return 0.0; // ideal ref. is dominated.
-        return DBL_MAX; // ideal ref. is nondominated --> worst possible value
-    }
-
-    double prev_y1 = p[j][0] - ref[0];
-    double prev_y2 = p[j][1] - ref[1];
-
-    if (prev_y2 < 0) {
-        // ideal ref. is dominated.
-        return 0.0;
-    }
+#define ROW(J) (p ? p[J] : data + 2 * (J))
+    ASSUME(n > 0);
+    // Coordinates smaller than the reference point are treated as equal to it.
+    double prev_y1 = MAX(ROW(0)[X] - ref[X], 0.);
+    double prev_y2 = MAX(ROW(0)[Y] - ref[Y], 0.);
 
     // first element
     double r2_exact = _utility(prev_y1, prev_y2, DBL_MAX);
-    // printf("y2 segment: %f, %f, MAX: %f\n", p[j][0] - ref[0], p[j][1] - ref[1], _utility(p[j][0] - ref[0], p[j][1] - ref[1], DBL_MAX));
-
-    while (j < n - 1) {
-        j++;
-        double y1 = p[j][0] - ref[0];
-        double y2 = p[j][1] - ref[1];
+    // printf("y2 segment: %f, %f, MAX: %f\n", prev_y1, prev_y2, _utility(prev_y1, prev_y2, DBL_MAX));
 
-        // skip anything that's not dominated by ref
-        if (y2 < 0) continue;
+    for (size_t j = 1; j < n; j++) {
+        // Clipping keeps the points sorted by y1.
+        double y1 = MAX(ROW(j)[X] - ref[X], 0.);
+        double y2 = MAX(ROW(j)[Y] - ref[Y], 0.);
 
         // printf("%f\n", y1);
         // printf("%f\n", y2);
@@ -86,6 +71,256 @@ double r2_exact(const double * restrict data, size_t n, dimension_t dim,
     // we omitted a 1/2 in the computation thus far:
     r2_exact = 0.5 * r2_exact;
 
-    free(p);
+#undef ROW
     return r2_exact;
 }
+
+static bool
+is_sorted_asc_x_asc_y(const double * restrict data, size_t n)
+{
+    for (size_t i = 1; i < n; i++) {
+        const double * a = data + 2 * (i - 1), * b = data + 2 * i;
+        if (a[0] > b[0] || (a[0] == b[0] && a[1] > b[1]))
+            return false;
+    }
+    return true;
+}
+
+static double
+r2_exact_2d(const double * restrict data, size_t n, const double * restrict ref)
+{
+    // Fast path: the rows are already sorted, so we do not need to sort them.
+    if (is_sorted_asc_x_asc_y(data, n))
+        return r2_exact_2d_sorted(data, NULL, n, ref, 0, 1);
+
+    // p is sorted by f1 (primarily), then f2 (secondarily)
+    const double ** p = generate_row_pointers_asc_x_asc_y(data, n);
+    if (unlikely(!p)) return -1;
+    double r2 = r2_exact_2d_sorted(NULL, p, n, ref, 0, 1);
+    free(p);
+    return r2;
+}
+
+/* Exact R2 of each of the nsets bi-objective sets.  All sets are sorted at
+   once by a single radix sort over rows (f2, f1, k), where k is the index of
+   the set, in lexicographic order of k, f1 and f2 (the last column is the
+   primary key of radix_sort_asc_rev()).  Then, each set is evaluated in a
+   single pass without further allocations.  */
+static void
+r2_exact_sets_2d(double * restrict r2, const double * restrict data,
+                 const size_t * restrict cumsizes, size_t nsets,
+                 const double * restrict ref)
+{
+    const size_t n = cumsizes[nsets - 1];
+    double * rows = MOOCORE_MALLOC(3 * n, double);
+    for (size_t k = 0, i = 0; k < nsets; k++) {
+        for (; i < cumsizes[k]; i++) {
+            rows[3 * i] = data[2 * i + 1];
+            rows[3 * i + 1] = data[2 * i];
+            rows[3 * i + 2] = (double) k;
+        }
+    }
+    const double ** p = generate_row_pointers(rows, n, 3);
+    // Sets are contiguous, thus sorting by k does not move rows across sets.
+    radix_sort_asc_rev(p, n, 2);
+    // With the columns swapped, ref must be swapped as well.
+    const double ref_swapped[2] = { ref[1], ref[0] };
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t k = 0; k < nsets; k++) {
+        const size_t start = (k == 0) ? 0 : cumsizes[k - 1];
+        r2[k] = (cumsizes[k] == start) ? -1
+            : r2_exact_2d_sorted(NULL, p + start, cumsizes[k] - start, ref_swapped, 1, 0);
+    }
+    free(p);
+    free(rows);
+}
+
+/******************************************************************************
+ Exact R2 for more than two objectives.
+
+ Let y = a - ref (clipped at zero) and s = 1 / y, component-wise.  The
+ Tchebycheff utility of w is the smallest t such that the corner t / w of the
+ box {y : max_i w_i y_i <= t} weakly dominates a point of A.  Changing the
+ variables (t, w) to s, where dt dw = (sum_i s_i)^-(d+1) ds, gives
+
+   R2(A) = (d-1)! * integral of (sum_i s_i)^-(d+1) ds over R^d_+ \ U,
+
+ where U is the union of the boxes [0, 1 / y] of each point, that is, the
+ region dominated by the transformed points if they were maximised with
+ respect to the origin.  The integral is computed by slicing along one
+ coordinate at a time, as the HSO algorithm does for the hypervolume.  Between
+ two consecutive points, the cross-section does not change and the integral
+ along the slicing coordinate has a closed form, so each slab reduces to two
+ integrals of the same form over the cross-section, in one dimension less:
+
+   I_k(U, c) = integral of (c + sum_i s_i)^-(k+1) ds over R^k_+ \ U.
+
+ For k = 2, the integral is computed in closed form over the staircase of the
+ cross-section, thus the total cost is O(n^(d-1)) time and O(d n) space.
+******************************************************************************/
+
+// Descending order of the first coordinate.
+DEFINE_QSORT_CMP(cmp_ppdouble_desc_x, double **)
+{
+    return cmp_double_asc((*b)[0], (*a)[0]);
+}
+
+/* I_2(U, c) for the points p sorted by p[0] in descending order.  */
+static double
+r2_slice_2d(const double ** restrict p, size_t n, double c)
+{
+    double h_top = p[0][0], b = p[0][1];
+    double r2 = 1 / (c + h_top);
+    for (size_t i = 1; i < n; i++) {
+        if (p[i][1] <= b)
+            continue;
+        if (p[i][0] < h_top)
+            r2 += 1 / (c + p[i][0] + b) - 1 / (c + h_top + b);
+        b = p[i][1];
+        h_top = p[i][0];
+    }
+    r2 += 1 / (c + b) - 1 / (c + h_top + b);
+    return r2 / 2;
+}
+
+/* True if q is weakly dominated by any of the first m points of x, which are
+   sorted by x[0] in descending order, in terms of maximisation.  */
+static bool
+r2_weakly_dominated(const double ** restrict x, size_t m,
+                    const double * restrict q, dimension_t dim)
+{
+    for (size_t i = 0; i < m && x[i][0] >= q[0]; i++) {
+        dimension_t d = 1;
+        while (d < dim && x[i][d] >= q[d])
+            d++;
+        if (d == dim)
+            return true;
+    }
+    return false;
+}
+
+/* Insert q in x, keeping it sorted by x[0] in descending order, and remove the
+   points dominated by q.  Return the new size of x.  */
+static size_t
+r2_insert(const double ** restrict x, size_t m, const double * restrict q,
+          dimension_t dim)
+{
+    size_t j = 0;
+    for (size_t i = 0; i < m; i++) {
+        dimension_t d = 0;
+        while (d < dim && q[d] >= x[i][d])
+            d++;
+        if (d < dim)
+            x[j++] = x[i];
+    }
+    size_t pos = j;
+    while (pos > 0 && x[pos - 1][0] < q[0]) {
+        x[pos] = x[pos - 1];
+        pos--;
+    }
+    x[pos] = q;
+    return j + 1;
+}
+
+/* I_k(U, c) for the points p with k coordinates sorted by p[0] in descending
+   order.  work must have room for (k - 2) * n pointers.  */
+static double
+r2_slice(const double ** restrict p, size_t n, dimension_t k, double c,
+         const double ** restrict work)
+{
+    ASSUME(k >= 2);
+    ASSUME(n > 0);
+    if (k == 2)
+        return r2_slice_2d(p, n, c);
+
+    double inv_factorial = 1; // 1 / (k-1)!
+    for (dimension_t i = 2; i < k; i++)
+        inv_factorial /= i;
+
+    // Cross-section: the remaining k - 1 coordinates of the points above the
+    // current slab that are not dominated by each other.
+    const double ** restrict x = work;
+    const double ** restrict next_work = work + n;
+    size_t m = 0;
+    double h_top = p[0][0];
+    double r2 = inv_factorial / (c + h_top);
+    x[m++] = p[0] + 1;
+    for (size_t i = 1; i < n; i++) {
+        const double * q = p[i] + 1;
+        if (r2_weakly_dominated(x, m, q, k - 1))
+            continue;
+        const double h = p[i][0];
+        if (h < h_top)
+            r2 += r2_slice(x, m, k - 1, c + h, next_work)
+                - r2_slice(x, m, k - 1, c + h_top, next_work);
+        m = r2_insert(x, m, q, k - 1);
+        h_top = h;
+    }
+    r2 += r2_slice(x, m, k - 1, c, next_work)
+        - r2_slice(x, m, k - 1, c + h_top, next_work);
+    return r2 / k;
+}
+
+static double
+r2_exact_nd(const double * restrict data, size_t n, dimension_t dim,
+            const double * restrict ref)
+{
+    ASSUME(dim >= 3);
+    double * s = MOOCORE_MALLOC(n * dim, double);
+    for (size_t i = 0; i < n; i++) {
+        bool ref_dominated = true;
+        for (dimension_t d = 0; d < dim; d++) {
+            double y = data[i * dim + d] - ref[d];
+            ref_dominated &= (y <= 0);
+            s[i * dim + d] = (y > 0) ? 1 / y : INFINITY;
+        }
+        if (ref_dominated) { // The utility is zero for all weights.
+            free(s);
+            return 0.0;
+        }
+    }
+    const double ** p = generate_row_pointers(s, n, dim);
+    qsort_typesafe(p, n, cmp_ppdouble_desc_x);
+    const double ** work = MOOCORE_MALLOC((dim - 2) * n, const double *);
+    double r2 = r2_slice(p, n, dim, 0, work);
+    for (dimension_t d = 2; d < dim; d++)
+        r2 *= d;
+    free(work);
+    free(p);
+    free(s);
+    return r2;
+}
+
+double r2_exact(const double * restrict data, size_t n, dimension_t dim,
+                const double * restrict ref)
+{
+    ASSUME(dim >= 2);
+    if (unlikely(n == 0)) return -1;
+    if (dim == 2)
+        return r2_exact_2d(data, n, ref);
+    return r2_exact_nd(data, n, dim, ref);
+}
+
+void r2_exact_sets(double * restrict r2, const double * restrict data,
+                   dimension_t dim, const size_t * restrict cumsizes, size_t nsets,
+                   const double * restrict ref)
+{
+    ASSUME(dim >= 2);
+    if (unlikely(nsets == 0)) return;
+    /* Small sets are sorted by insertion sort anyway, so copying the rows for
+       the radix sort only pays off when sets are large on average.  */
+    if (dim == 2 && cumsizes[nsets - 1] <= UINT32_MAX
+        && cumsizes[nsets - 1] > RADIX_INSERTION_THRESHOLD * nsets) {
+        r2_exact_sets_2d(r2, data, cumsizes, nsets, ref);
+        return;
+    }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t k = 0; k < nsets; k++) {
+        const size_t start = (k == 0) ? 0 : cumsizes[k - 1];
+        r2[k] = r2_exact(data + start * dim, cumsizes[k] - start, dim, ref);
+    }
+}
@@ -24,7 +24,14 @@
 // C++ needs to know that types and declarations are C, not C++.
 BEGIN_C_DECLS
 
+/* Exact R2 of the n points of data with respect to the ideal point ref.
+   Coordinates smaller than ref are treated as equal to it.  */
 MOOCORE_API double r2_exact(const double * restrict data, size_t n, dimension_t d, const double * restrict ref);
+/* r2[k] is the exact R2 of set k, given by rows cumsizes[k-1], ...,
+   cumsizes[k] - 1 of data (with cumsizes[-1] == 0).  */
+MOOCORE_API void r2_exact_sets(double * restrict r2, const double * restrict data,
+                               dimension_t d, const size_t * restrict cumsizes,
+                               size_t nsets, const double * restrict ref);
 
 END_C_DECLS
 
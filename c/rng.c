@@ -98,19 +98,24 @@ rng_standard_normal(rng_state *rng)
     }
 }
 
+/* Sample n points from a normal distribution in dim dimensions with mean mu
+   and standard deviation sigma along each dimension, where the correlation
+   between the first dimension and each of the others is rho.  With dim == 2,
+   this is the bivariate normal distribution.  */
 void
-rng_bivariate_normal_fill(rng_state * rng,
-                          double mu1, double mu2,
-                          double sigma1, double sigma2, double rho,
-                          double *out, int n)
+rng_correlated_normal_fill(rng_state * rng, dimension_t dim,
+                           const double * mu, double sigma, double rho,
+                           double *out, int n)
 {
-    const double sigma2rho = sigma2 * rho;
-    const double nu = sigma2 * sqrt(1 - rho*rho);
+    const double sigma_rho = sigma * rho;
+    const double nu = sigma * sqrt(1 - rho*rho);
     for (int i = 0; i < n; i++) {
         const double x1 = rng_standard_normal(rng);
-        *out = mu1 + x1 * sigma1;
-        out++;
-        *out = mu2 + x1 * sigma2rho + nu * rng_standard_normal(rng);
+        *out = mu[0] + x1 * sigma;
         out++;
+        for (dimension_t d = 1; d < dim; d++) {
+            *out = mu[d] + x1 * sigma_rho + nu * rng_standard_normal(rng);
+            out++;
+        }
     }
 }
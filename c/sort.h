@@ -274,4 +274,29 @@ generate_sorted_doublep_2d_filter_by_ref(const double * restrict points,
     return p;
 }
 
+/* Hypervolume of the union of a and b, both as returned by
+   generate_sorted_doublep_2d_filter_by_ref().  Same as hv2d() of the union,
+   but merging both lists instead of sorting the union.  */
+static inline double
+hv2d_union_sorted(const double ** restrict a, size_t na,
+                  const double ** restrict b, size_t nb, const double * restrict ref)
+{
+    double hyperv = 0;
+    double prev_j = ref[1];
+    size_t i = 0, j = 0;
+    while (i < na || j < nb) {
+        const double * p;
+        if (j == nb || (i < na && (a[i][0] < b[j][0]
+                                   || (a[i][0] == b[j][0] && a[i][1] <= b[j][1]))))
+            p = a[i++];
+        else
+            p = b[j++];
+        if (p[1] < prev_j) {
+            hyperv += (ref[0] - p[0]) * (prev_j - p[1]);
+            prev_j = p[1];
+        }
+    }
+    return hyperv;
+}
+
 #endif 	    /* !SORT_H_ */
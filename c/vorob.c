@@ -0,0 +1,152 @@
+#include <string.h>
+#include "eaf.h"
+#include "hv.h"
+#include "sort.h"
+
+/* Vorob'ev threshold, expectation and deviation.
+
+   The threshold is found by bisection over the percentiles in [0, 100] until
+   two consecutive steps give the same hypervolume.  The hypervolume of each
+   level is computed at most once.  */
+
+static void
+hypervolume_sets(double * restrict hv, const double * restrict data, dimension_t nobj,
+                 const size_t * restrict cumsizes, int nruns, const double * restrict ref)
+{
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int k = 0; k < nruns; k++) {
+        const size_t start = (k == 0) ? 0 : cumsizes[k - 1];
+        hv[k] = fpli_hv(data + start * nobj, cumsizes[k] - start, nobj, ref);
+    }
+}
+
+/* Neumaier compensated sum, computed in the order of the sets, so that the
+   result does not depend on the number of threads and does not lose accuracy
+   with many sets.  */
+static double
+mean(const double * x, int n)
+{
+    double sum = 0, c = 0;
+    for (int k = 0; k < n; k++) {
+        double t = sum + x[k];
+        c += (fabs(sum) >= fabs(x[k])) ? (sum - t) + x[k] : (x[k] - t) + sum;
+        sum = t;
+    }
+    return (sum + c) / n;
+}
+
+double *
+vorob_expectation(double * restrict threshold, double * restrict avg_hyp,
+                  size_t * restrict ve_npoints, double * restrict data, int nobj,
+                  const size_t * restrict cumsizes, int nruns,
+                  const double * restrict ref)
+{
+    const dimension_t dim = (dimension_t) nobj;
+    double * hv = malloc(nruns * sizeof(*hv));
+    hypervolume_sets(hv, data, dim, cumsizes, nruns, ref);
+    const double avg = mean(hv, nruns);
+
+    /* eaf3d() and eafnd() compute all the levels anyway, so all the surfaces
+       are computed at once.  eaf2d() computes a single level much faster than
+       all of them, so only the levels visited by the bisection are
+       computed.  */
+    eaf_t ** eaf;
+    if (nobj == 2) {
+        eaf = calloc(nruns, sizeof(*eaf));
+    } else {
+        int * level = levels_from_percentiles(NULL, nruns, nruns);
+        eaf = attsurf(data, nobj, cumsizes, nruns, level, nruns,
+                      /* store_attained = */false);
+        free(level);
+    }
+
+    // hv[k] is now the hypervolume of level k + 1, or -1 if not computed yet.
+    for (int k = 0; k < nruns; k++)
+        hv[k] = -1;
+
+    double a = 0, b = 100, c = 50;
+    double prev_hyp = INFINITY, diff = INFINITY;
+    int k = 0;
+    while (diff != 0) {
+        c = (a + b) / 2;
+        k = percentile2level(c, nruns) - 1;
+        if (hv[k] < 0) {
+            if (eaf[k] == NULL) {
+                const int level = k + 1;
+                eaf_t ** surf = attsurf(data, nobj, cumsizes, nruns, &level, 1,
+                                        /* store_attained = */false);
+                eaf[k] = surf[0];
+                free(surf);
+            }
+            hv[k] = fpli_hv(eaf[k]->data, eaf[k]->size, dim, ref);
+        }
+        if (hv[k] > avg)
+            a = c;
+        else
+            b = c;
+        diff = prev_hyp - hv[k];
+        prev_hyp = hv[k];
+    }
+
+    double * ve = malloc(eaf[k]->size * nobj * sizeof(*ve));
+    memcpy(ve, eaf[k]->data, eaf[k]->size * nobj * sizeof(*ve));
+    *ve_npoints = eaf[k]->size;
+    *threshold = c;
+    *avg_hyp = avg;
+    for (int l = 0; l < nruns; l++)
+        if (eaf[l]) eaf_delete(eaf[l]);
+    free(eaf);
+    free(hv);
+    return ve;
+}
+
+/* Hypervolume of the symmetric difference between A and B:
+   2 * H(A U B) - H(A) - H(B).  */
+double
+vorob_deviation(const double * restrict data, int nobj,
+                const size_t * restrict cumsizes, int nruns,
+                const double * restrict ref,
+                const double * restrict ve, size_t ve_npoints)
+{
+    const dimension_t dim = (dimension_t) nobj;
+    double * hv = malloc(nruns * sizeof(*hv));
+    hypervolume_sets(hv, data, dim, cumsizes, nruns, ref);
+    const double h1 = mean(hv, nruns);
+    const double h2 = fpli_hv(ve, ve_npoints, dim, ref);
+
+    if (nobj == 2) {
+        // The expectation is sorted only once.
+        size_t ve_n = ve_npoints;
+        const double ** ve_p = generate_sorted_doublep_2d_filter_by_ref(ve, &ve_n, ref[0]);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int k = 0; k < nruns; k++) {
+            const size_t start = (k == 0) ? 0 : cumsizes[k - 1];
+            size_t size = cumsizes[k] - start;
+            const double ** p = generate_sorted_doublep_2d_filter_by_ref(
+                data + start * nobj, &size, ref[0]);
+            hv[k] = hv2d_union_sorted(p, size, ve_p, ve_n, ref);
+            if (size > 0) free(p);
+        }
+        if (ve_n > 0) free(ve_p);
+    } else {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int k = 0; k < nruns; k++) {
+            const size_t start = (k == 0) ? 0 : cumsizes[k - 1];
+            const size_t size = cumsizes[k] - start;
+            double * both = malloc((size + ve_npoints) * nobj * sizeof(*both));
+            memcpy(both, data + start * nobj, size * nobj * sizeof(*both));
+            memcpy(both + size * nobj, ve, ve_npoints * nobj * sizeof(*both));
+            hv[k] = fpli_hv(both, size + ve_npoints, dim, ref);
+            free(both);
+        }
+    }
+    const double vd = 2 * mean(hv, nruns);
+    free(hv);
+    return vd - h1 - h2;
+}
@@ -1,6 +1,8 @@
 #include <float.h>
+#include <math.h>
 #include "whv.h"
 #include "common.h"
+#include "sort.h"
 
 // FIXME: This function already exists in sort.h.
 static inline int
@@ -26,23 +28,29 @@ cmp_rectangles_y_desc (const void * p1, const void * p2)
         : 0;
 }
 
+/* Clip the rectangles (lower corner, upper corner and color in each row) to
+   the reference point and remove those that become empty.  Returns either
+   rectangles, which is modified, or a new array that must be freed.  */
 static double *
-whv_preprocess_rectangles(double * rectangles, int nrow,
+whv_preprocess_rectangles(double * rectangles, int nrow, dimension_t nobj,
                           const double *reference, int *new_nrow_p)
 {
-    const int ncol = 5;
+    const int ncol = 2 * nobj + 1;
     for (int k = 0; k < nrow; k++) {
-        rectangles[k * ncol + 0] = MIN(rectangles[k * ncol + 0], reference[0]);
-        rectangles[k * ncol + 1] = MIN(rectangles[k * ncol + 1], reference[1]);
-        rectangles[k * ncol + 2] = MIN(rectangles[k * ncol + 2], reference[0]);
-        rectangles[k * ncol + 3] = MIN(rectangles[k * ncol + 3], reference[1]);
+        for (dimension_t j = 0; j < nobj; j++) {
+            rectangles[k * ncol + j] = MIN(rectangles[k * ncol + j], reference[j]);
+            rectangles[k * ncol + nobj + j] = MIN(rectangles[k * ncol + nobj + j], reference[j]);
+        }
     }
     int * skip = malloc(nrow * sizeof(*skip));
     int skip_nrow = 0;
     for (int k = 0; k < nrow; k++) {
-        if (rectangles[k * ncol + 0] == rectangles[k * ncol + 2]
-            || rectangles[k * ncol + 1] == rectangles[k * ncol + 3])
-            skip[skip_nrow++] = k;
+        for (dimension_t j = 0; j < nobj; j++) {
+            if (rectangles[k * ncol + j] == rectangles[k * ncol + nobj + j]) {
+                skip[skip_nrow++] = k;
+                break;
+            }
+        }
     }
 
     if (skip_nrow == 0) {
@@ -56,12 +64,12 @@ whv_preprocess_rectangles(double * rectangles, int nrow,
         *new_nrow_p = 0;
         return NULL;
     }
-    double *dest = malloc(sizeof(*dest) * 5 * new_nrow);
+    double *dest = malloc(sizeof(*dest) * ncol * new_nrow);
     skip[skip_nrow] = nrow;
     int j = 0, k = 0;
     for (int s = 0; s <= skip_nrow; s++) {
         while (k < skip[s]) {
-            for (int c = 0; c < 5; c++)
+            for (int c = 0; c < ncol; c++)
                 dest[j * ncol + c] = rectangles[k * ncol + c];
             k++, j++;
         }
@@ -72,9 +80,44 @@ whv_preprocess_rectangles(double * rectangles, int nrow,
     return dest;
 }
 
-double
-rect_weighted_hv2d(double *data, int n, double * rectangles,
-                   int rectangles_nrow, const double * reference)
+/* Remove dominated and repeated points from data sorted by
+   cmp_data_y_desc().  The sweep below assumes that, going down, each point is
+   to the right of the previous one.  Returns the number of points left.  */
+static int
+whv_remove_dominated_2d(double * data, int n)
+{
+    bool * keep = malloc(n * sizeof(*keep));
+    double min_x = INFINITY;
+    // Going up, a point is nondominated if it is to the left of all points
+    // below it.  Among points with the same y, only the leftmost one (the
+    // first one) may be kept.
+    for (int i = n - 1; i >= 0; ) {
+        int g = i;
+        while (g > 0 && data[2 * (g - 1) + 1] == data[2 * i + 1])
+            g--;
+        for (int j = g + 1; j <= i; j++)
+            keep[j] = false;
+        keep[g] = data[2 * g] < min_x;
+        min_x = MIN(min_x, data[2 * g]);
+        i = g - 1;
+    }
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        if (keep[i]) {
+            data[2 * k] = data[2 * i];
+            data[2 * k + 1] = data[2 * i + 1];
+            k++;
+        }
+    }
+    free(keep);
+    return k;
+}
+
+/* data is sorted in place and its dominated points are removed.  rectangles must have been preprocessed by
+   whv_preprocess_rectangles() and sorted by cmp_rectangles_y_desc().  */
+static double
+rect_weighted_hv2d_prepared(double *data, int n, const double * rectangles,
+                            int rectangles_nrow)
 {
 #define debug_print_point(k, p, r, rect)                                       \
     DEBUG2_PRINT("%d: p[%zu] = (%16.15g, %16.15g)"                             \
@@ -100,7 +143,7 @@ rect_weighted_hv2d(double *data, int n, double * rectangles,
 #define next_point() do {                                                      \
         top = p[1];                                                            \
         pk++;                                                                  \
-        if (pk >= n || top == last_top || p[0] >= last_right)                  \
+        if (pk >= n || top <= last_bottom || p[0] >= last_right)               \
             goto return_whv;                                                   \
         p += nobj;                                                             \
         debug_print_point(pk, p, r, rect);                                     \
@@ -109,16 +152,9 @@ rect_weighted_hv2d(double *data, int n, double * rectangles,
     DEBUG2_PRINT("n = %zu\trectangles = %zu\n", (size_t)n, (size_t)rectangles_nrow);
     if (rectangles_nrow <= 0 || n <= 0) return 0;
 
-    int old_rectangles_nrow = rectangles_nrow;
-    rectangles =
-        whv_preprocess_rectangles(rectangles, old_rectangles_nrow, reference, &rectangles_nrow);
-    if (rectangles_nrow == 0)
-        return 0;
-
     const int nobj = 2;
     qsort(data, n, 2 * sizeof(*data), &cmp_data_y_desc);
-    qsort(rectangles, rectangles_nrow, (nobj * 2 + 1) * sizeof(*rectangles),
-          &cmp_rectangles_y_desc);
+    n = whv_remove_dominated_2d(data, n);
 
     double whv = 0.0;
     int r = 0;
@@ -131,11 +167,12 @@ rect_weighted_hv2d(double *data, int n, double * rectangles,
     int pk = 0;
     debug_print_point(pk, p, r, rect);
     double top = upper1;
-    // lowest_upper1;
-    const double last_top = rectangles[rectangles_nrow * (nobj * 2 + 1) - 2];
+    // lowest lower1: points below it do not add anything.
+    double last_bottom = DBL_MAX;
     // largest upper0;
     double last_right = -DBL_MAX;
     for (r = 0; r < rectangles_nrow; r++) {
+        last_bottom = MIN (last_bottom, rectangles[r * (nobj * 2 + 1) + 1]);
         last_right = MAX (last_right, rectangles[r * (nobj * 2 + 1) + 2]);
     }
     // Find first useful point.
@@ -174,9 +211,136 @@ rect_weighted_hv2d(double *data, int n, double * rectangles,
         } while (top == p[1] && p[1] >= upper1);
     }
 return_whv:
-    if (old_rectangles_nrow != rectangles_nrow)
-        free (rectangles);
-
     DEBUG2_PRINT("whv: %16.15g\n", whv);
     return whv;
+#undef debug_print_point
+#undef debug_print_rect
+#undef get_rectangle
+#undef next_point
+}
+
+static double *
+whv_prepare_rectangles(double * rectangles, int nrow, dimension_t nobj,
+                       const double * reference, int * new_nrow_p)
+{
+    rectangles = whv_preprocess_rectangles(rectangles, nrow, nobj, reference, new_nrow_p);
+    if (nobj == 2 && *new_nrow_p > 0)
+        qsort(rectangles, *new_nrow_p, (nobj * 2 + 1) * sizeof(*rectangles),
+              &cmp_rectangles_y_desc);
+    return rectangles;
+}
+
+double
+rect_weighted_hv2d(double *data, int n, double * rectangles,
+                   int rectangles_nrow, const double * reference)
+{
+    if (rectangles_nrow <= 0 || n <= 0) return 0;
+    int new_nrow;
+    double * rect = whv_prepare_rectangles(rectangles, rectangles_nrow, 2, reference, &new_nrow);
+    double whv = rect_weighted_hv2d_prepared(data, n, rect, new_nrow);
+    if (rect != rectangles)
+        free(rect);
+    return whv;
+}
+
+/******************************************************************************
+ Weighted hypervolume in 3D.
+
+ The region dominated by the points within a box [l, u] is the region
+ dominated by the points max(p, l), for all p that strictly dominate u, and
+ bounded by u.  Thus, the contribution of each rectangle is its color times
+ the hypervolume of those points with respect to u, which is computed by
+ HV3D+.
+******************************************************************************/
+
+double hv3d(const double * restrict data, size_t n, const double * restrict ref);
+
+/* rectangles must have been preprocessed by whv_preprocess_rectangles().
+   buffer must have space for 3 * n doubles.  */
+static double
+rect_weighted_hv3d_prepared(const double * restrict data, int n,
+                            const double * restrict rectangles, int rectangles_nrow,
+                            double * restrict buffer)
+{
+    const dimension_t nobj = 3;
+    const int ncol = 2 * nobj + 1;
+    double whv = 0;
+    for (int r = 0; r < rectangles_nrow; r++) {
+        const double * lower = rectangles + r * ncol;
+        const double * upper = lower + nobj;
+        const double color = lower[2 * nobj];
+        size_t m = 0;
+        bool covered = false;
+        for (int i = 0; i < n; i++) {
+            const double * p = data + i * nobj;
+            if (!strongly_dominates(p, upper, nobj))
+                continue;
+            if (weakly_dominates(p, lower, nobj)) { // The whole box is dominated.
+                covered = true;
+                break;
+            }
+            double * q = buffer + m * nobj;
+            for (dimension_t k = 0; k < nobj; k++)
+                q[k] = MAX(p[k], lower[k]);
+            m++;
+        }
+        double vol;
+        if (covered) {
+            vol = 1;
+            for (dimension_t k = 0; k < nobj; k++)
+                vol *= upper[k] - lower[k];
+        } else {
+            vol = (m == 0) ? 0 : hv3d(buffer, m, upper);
+        }
+        whv += color * vol;
+    }
+    return whv;
+}
+
+double
+rect_weighted_hv3d(const double *data, int n, double * rectangles,
+                   int rectangles_nrow, const double * reference)
+{
+    if (rectangles_nrow <= 0 || n <= 0) return 0;
+    int new_nrow;
+    double * rect = whv_prepare_rectangles(rectangles, rectangles_nrow, 3, reference, &new_nrow);
+    double * buffer = MOOCORE_MALLOC(3 * (size_t) n, double);
+    double whv = rect_weighted_hv3d_prepared(data, n, rect, new_nrow, buffer);
+    free(buffer);
+    if (rect != rectangles)
+        free(rect);
+    return whv;
+}
+
+void
+rect_weighted_hv_sets(double * restrict whv, double * restrict data, dimension_t nobj,
+                      const size_t * restrict cumsizes, size_t nsets,
+                      double * restrict rectangles, int rectangles_nrow,
+                      const double * restrict reference)
+{
+    ASSUME(nobj == 2 || nobj == 3);
+    int new_nrow = 0;
+    // The rectangles are preprocessed only once for all sets.
+    double * rect = (rectangles_nrow <= 0) ? NULL
+        : whv_prepare_rectangles(rectangles, rectangles_nrow, nobj, reference, &new_nrow);
+    if (new_nrow == 0) {
+        for (size_t k = 0; k < nsets; k++)
+            whv[k] = 0;
+        return;
+    }
+    size_t max_size = 0;
+    for (size_t k = 0; k < nsets; k++)
+        max_size = MAX(max_size, cumsizes[k] - ((k == 0) ? 0 : cumsizes[k - 1]));
+    double * buffer = (nobj == 3) ? MOOCORE_MALLOC(nobj * max_size, double) : NULL;
+    for (size_t k = 0; k < nsets; k++) {
+        const size_t start = (k == 0) ? 0 : cumsizes[k - 1];
+        const int n = (int) (cumsizes[k] - start);
+        double * points = data + start * nobj;
+        whv[k] = (n == 0) ? 0
+            : (nobj == 2) ? rect_weighted_hv2d_prepared(points, n, rect, new_nrow)
+            : rect_weighted_hv3d_prepared(points, n, rect, new_nrow, buffer);
+    }
+    free(buffer);
+    if (rect != rectangles)
+        free(rect);
 }
@@ -1,4 +1,14 @@
 #ifndef WHV_H
 #define WHV_H
+#include <stddef.h>
+#include "libmoocore-config.h"
 double rect_weighted_hv2d(double *data, int n, double * rectangles, int  rectangles_nrow, const double *reference);
+double rect_weighted_hv3d(const double *data, int n, double * rectangles, int rectangles_nrow, const double *reference);
+/* whv[k] is the weighted hypervolume of set k (2 or 3 objectives), given by
+   rows cumsizes[k-1], ..., cumsizes[k] - 1 of data (with cumsizes[-1] == 0).
+   The rectangles are preprocessed only once.  */
+void rect_weighted_hv_sets(double *whv, double *data, dimension_t nobj,
+                           const size_t *cumsizes, size_t nsets,
+                           double *rectangles, int rectangles_nrow,
+                           const double *reference);
 #endif // WHV_H
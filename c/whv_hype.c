@@ -2,22 +2,34 @@
 #include "common.h"
 #include "nondominated.h"
 #include "rng.h"
+#include "sort.h"
 #include <float.h>
 #include <math.h>
 
+/* Samples are generated and evaluated in blocks of this size, so that memory
+   does not grow with the number of samples.  */
+#ifndef HYPE_SAMPLES_BLOCK
+#define HYPE_SAMPLES_BLOCK 65536
+#endif
+
 enum hype_sample_dist_type { HYPE_DIST_UNIFORM, HYPE_DIST_EXPONENTIAL, HYPE_DIST_GAUSSIAN };
 
 typedef struct hype_sample_dist hype_sample_dist;
 
-typedef double *(*hype_sample_fn)(hype_sample_dist *, int);
+/* Generate samples start, ..., end - 1 out of nsamples.  Calling it for
+   consecutive ranges gives the same samples as a single call for the whole
+   range.  */
+typedef void (*hype_sample_fn)(hype_sample_dist *, double * restrict samples,
+                               int start, int end, int nsamples);
 
 struct hype_sample_dist {
     enum hype_sample_dist_type type;
+    dimension_t nobj;
     rng_state * rng;
     double * lower;
     double * range;
     double * mu;
-    hype_sample_fn create_samples;
+    hype_sample_fn fill_samples;
 };
 
 enum hype_sample_dist_type
@@ -27,76 +39,81 @@ hype_dist_get_type(const hype_sample_dist * d)
     return d->type;
 }
 
-static double *
-gaussian_dist_sample(hype_sample_dist * dist, int nsamples)
+static void
+gaussian_dist_sample(hype_sample_dist * dist, double * restrict samples,
+                     int start, int end, int nsamples _attr_maybe_unused)
 {
-    const int nobj = 2;
-    double * samples = malloc(sizeof(double) * nsamples * nobj);
+    const dimension_t nobj = dist->nobj;
     /* FIXME: Dimo's paper uses a t vector instead of rho */
-    double sigma_x = 0.25;
-    double sigma_y = 0.25;
-    rng_bivariate_normal_fill(dist->rng,
-                              dist->mu[0], dist->mu[1],
-                              sigma_x, sigma_y, /*rho=*/1.0,
-                              samples, nsamples);
+    const double sigma = 0.25;
+    rng_correlated_normal_fill(dist->rng, nobj, dist->mu, sigma, /*rho=*/1.0,
+                               samples, end - start);
     /* FIXME: do we need to use the truncated distribution?
        samples[i * nobj + 0] = CLAMP(dist->mu[0] + x, 0.0, 1.0);
        samples[i * nobj + 1] = CLAMP(dist->mu[1] + y, 0.0, 1.0);
     */
-    return samples;
 }
 
-static double *
-exp_dist_sample(hype_sample_dist * dist, int nsamples)
+/* The samples are split in nobj consecutive blocks of (almost) equal size.
+   Block k follows an exponential distribution along objective k and a
+   uniform one along the others.  */
+static inline int
+exp_dist_block_end(dimension_t k, dimension_t nobj, int nsamples)
+{
+    return (k == nobj - 1) ? nsamples : (int)((k + 1) * (double) nsamples / nobj);
+}
+
+static void
+exp_dist_sample(hype_sample_dist * dist, double * restrict samples,
+                int start, int end, int nsamples)
 {
-    const int nobj = 2;
+    const dimension_t nobj = dist->nobj;
     const double *lower = dist->lower;
     const double *range = dist->range;
-
-    double * samples = malloc(sizeof(double) * nsamples * nobj);
-    int n = (int)(0.5 * nsamples);
     double mu = dist->mu[0];
     rng_state * rng = dist->rng;
-    for (int i = 0; i < n; i++) {
-        double x = rng_random(rng);
-        assert(x > 0);
-        samples[i * nobj + 0] = lower[0] - mu * log(x);
-        x = rng_random(rng);
-        samples[i * nobj + 1] = lower[1] + x * range[1];
-    }
-    for (int i = n; i < nsamples; i++) {
-        double x = rng_random(rng);
-        samples[i * nobj + 0] = lower[0] + x * range[0];
-        x = rng_random(rng);
-        assert(x > 0);
-        samples[i * nobj + 1] = lower[1] - mu * log(x);
+    dimension_t k = 0;
+    while (start >= exp_dist_block_end(k, nobj, nsamples))
+        k++;
+    for (int i = start; i < end; i++) {
+        // Blocks may be empty when nsamples < nobj.
+        while (i == exp_dist_block_end(k, nobj, nsamples))
+            k++;
+        double * restrict sample = samples + (i - start) * nobj;
+        for (dimension_t d = 0; d < nobj; d++) {
+            double x = rng_random(rng);
+            if (d == k) {
+                assert(x > 0);
+                sample[d] = lower[d] - mu * log(x);
+            } else {
+                sample[d] = lower[d] + x * range[d];
+            }
+        }
     }
-    return samples;
 }
 
-static double *
-uniform_dist_sample(hype_sample_dist * dist, int nsamples)
+static void
+uniform_dist_sample(hype_sample_dist * dist, double * restrict samples,
+                    int start, int end, int nsamples _attr_maybe_unused)
 {
-    const int nobj = 2;
+    const dimension_t nobj = dist->nobj;
     const double *lower = dist->lower;
     const double *range = dist->range;
     rng_state * rng = dist->rng;
-    double * samples = malloc(sizeof(double) * nsamples * nobj);
-    for (int i = 0; i < nsamples; i++) {
+    for (int i = 0; i < end - start; i++) {
         for (int d = 0; d < nobj; d++) {
             samples[i * nobj + d] = lower[d] + rng_random(rng) * range[d];
         }
         //printf("sample: { %g, %g }\n", samples[i * nobj + 0], samples[i * nobj + 1]);
     }
-    return samples;
 }
 
 static hype_sample_dist *
-hype_dist_new(uint32_t seed)
+hype_dist_new(dimension_t nobj, uint32_t seed)
 {
     hype_sample_dist * dist = malloc(sizeof(hype_sample_dist));
     dist->rng = rng_new(seed);
-    const int nobj = 2;
+    dist->nobj = nobj;
     dist->lower = malloc(sizeof(double) * nobj);
     dist->range = malloc(sizeof(double) * nobj);
     for (int i = 0; i < nobj; i++) {
@@ -108,34 +125,33 @@ hype_dist_new(uint32_t seed)
 }
 
 static hype_sample_dist *
-hype_dist_gaussian_new(uint32_t seed, const double *mu)
+hype_dist_gaussian_new(dimension_t nobj, uint32_t seed, const double *mu)
 {
-    hype_sample_dist *dist = hype_dist_new(seed);
+    hype_sample_dist *dist = hype_dist_new(nobj, seed);
     dist->type = HYPE_DIST_GAUSSIAN;
-    const int nobj = 2;
     dist->mu = malloc(sizeof(double) * nobj);
     memcpy(dist->mu, mu, sizeof(double) * nobj);
-    dist->create_samples = gaussian_dist_sample;
+    dist->fill_samples = gaussian_dist_sample;
     return dist;
 }
 
 static hype_sample_dist *
-hype_dist_exp_new(uint32_t seed, double mu)
+hype_dist_exp_new(dimension_t nobj, uint32_t seed, double mu)
 {
-    hype_sample_dist *dist = hype_dist_new(seed);
+    hype_sample_dist *dist = hype_dist_new(nobj, seed);
     dist->type = HYPE_DIST_EXPONENTIAL;
     dist->mu = malloc(sizeof(double) * 1);
     dist->mu[0] = mu;
-    dist->create_samples = exp_dist_sample;
+    dist->fill_samples = exp_dist_sample;
     return dist;
 }
 
 static hype_sample_dist *
-hype_dist_unif_new(uint32_t seed)
+hype_dist_unif_new(dimension_t nobj, uint32_t seed)
 {
-    hype_sample_dist *dist = hype_dist_new(seed);
+    hype_sample_dist *dist = hype_dist_new(nobj, seed);
     dist->type = HYPE_DIST_UNIFORM;
-    dist->create_samples = uniform_dist_sample;
+    dist->fill_samples = uniform_dist_sample;
     return dist;
 }
 
@@ -149,48 +165,226 @@ hype_dist_free(hype_sample_dist * d)
     free(d);
 }
 
-static double
-estimate_whv(const double *points, int npoints,
-             const double * samples, int nsamples)
+/*
+   HypE shares the value of each sample equally among the points that weakly
+   dominate it, thus the sum of the shares over all points is 1 for every
+   sample dominated by at least one point and 0 otherwise.  Hence, it is
+   enough to count the samples weakly dominated by the points.
+
+   The points are preprocessed once by hype_points_new() and each block of
+   samples is counted by sorting and sweeping instead of comparing each sample
+   with each point.
+*/
+typedef struct hype_points {
+    double * points;
+    size_t npoints;
+    dimension_t nobj;
+    // 3D only: sorted first objective and rank of each point within it.
+    double * xs;
+    size_t * rank;
+} hype_points;
+
+static size_t
+upper_bound(const double * restrict x, size_t n, double value)
+{
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (x[mid] <= value) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* Takes ownership of points.
+
+   2D: Keep the staircase of nondominated points sorted by increasing x (and
+   decreasing y).
+
+   3D: Sort the points by increasing z and precompute the rank of their x
+   value.
+
+   Otherwise: Remove dominated points and sort the rest by increasing first
+   objective.  */
+static hype_points *
+hype_points_new(double * restrict points, size_t npoints, dimension_t nobj)
 {
-    const int nobj = 2;
-    /* // compute alpha factor of HypE fitness: */
-    /* double * alpha = malloc(npoints * sizeof(double)); */
-    /* for (int i = 1; i <= npoints; i++) { */
-    /*     alpha[i - 1] = 1.0 / i; */
-    /* } */
-    double whv = 0.0;
-    // compute amount of dominators in p for each sample:
-    unsigned int * dominated = calloc(nsamples, sizeof(unsigned int));
-    bool * is_dominator = malloc(npoints * sizeof(bool));
-    for (int s = 0; s < nsamples; s++) {
-        const double *sample = samples + s * nobj;
-        // compute amount of dominators in p for each sample:
-        for (int j = 0; j < npoints; j++) {
-            bool dom = true;
-            const double *p = points + j * nobj;
-            for (int d = 0; d < nobj; d++) {
-                if (sample[d] < p[d]) {
-                    dom = false;
-                    break;
-                }
+    hype_points * hp = malloc(sizeof(*hp));
+    hp->nobj = nobj;
+    hp->xs = NULL;
+    hp->rank = NULL;
+    if (npoints == 0) {
+        // Nothing to do.
+    } else if (nobj == 2) {
+        qsort(points, npoints, 2 * sizeof(*points), qsort_cmp_pdouble_asc_x_asc_y);
+        size_t n = 1;
+        for (size_t i = 1; i < npoints; i++) {
+            const double * p = points + 2 * i;
+            if (p[1] < points[2 * n - 1]) {
+                points[2 * n] = p[0];
+                points[2 * n + 1] = p[1];
+                n++;
             }
-            if (dom) dominated[s]++;
-            is_dominator[j] = dom;
         }
-        // sum up alpha values of each dominated sample:
-        for (int j = 0; j < npoints; j++) {
-            if (is_dominator[j]) {
-                assert(dominated[s] > 0);
-                whv += 1.0 / dominated[s];
-                //fprintf(stderr, "whv = %g\n", whv);
+        npoints = n;
+    } else if (nobj == 3) {
+        qsort(points, npoints, 3 * sizeof(*points), qsort_cmp_pdouble_asc_only_3d);
+        double * xs = malloc(npoints * sizeof(*xs));
+        for (size_t i = 0; i < npoints; i++)
+            xs[i] = points[3 * i];
+        qsort_typesafe(xs, npoints, cmp_pdouble_asc_1d);
+        size_t * rank = malloc(npoints * sizeof(*rank));
+        for (size_t i = 0; i < npoints; i++) {
+            // 1 + number of xs < points[i][0].
+            size_t lo = 0, hi = npoints;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (xs[mid] < points[3 * i]) lo = mid + 1;
+                else hi = mid;
             }
+            rank[i] = lo + 1;
         }
+        hp->xs = xs;
+        hp->rank = rank;
+    } else {
+        const int * minmax = minmax_minimise(nobj);
+        npoints = filter_dominated_set(points, npoints, nobj, minmax);
+        free((void *) minmax);
+        qsort(points, npoints, nobj * sizeof(*points), qsort_cmp_pdouble_asc_1d);
+    }
+    hp->points = points;
+    hp->npoints = npoints;
+    return hp;
+}
+
+static void
+hype_points_free(hype_points * hp)
+{
+    free(hp->points);
+    free(hp->xs);
+    free(hp->rank);
+    free(hp);
+}
+
+/* A sample is dominated iff the last point in the staircase with x <=
+   sample[0] has y <= sample[1].  O(s log n).  */
+static size_t
+count_dominated_samples_2d(const hype_points * hp,
+                           const double * restrict samples, size_t nsamples)
+{
+    const double * restrict points = hp->points;
+    const size_t npoints = hp->npoints;
+    size_t count = 0;
+    for (size_t j = 0; j < nsamples; j++) {
+        const double * s = samples + 2 * j;
+        // Number of points in the staircase with x <= s[0].
+        size_t lo = 0, hi = npoints;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (points[2 * mid] <= s[0]) lo = mid + 1;
+            else hi = mid;
+        }
+        count += (lo > 0 && points[2 * lo - 1] <= s[1]);
+    }
+    return count;
+}
+
+/* Sweep the points and the samples by increasing z.  Before processing a
+   sample, all points with z <= sample[2] are inserted into a Fenwick tree,
+   indexed by the rank of their x value, that keeps the minimum y of each
+   prefix.  O((n + s) log n + s log s).  The samples are reordered.  */
+static size_t
+count_dominated_samples_3d(const hype_points * hp,
+                           double * restrict samples, size_t nsamples)
+{
+    const double * restrict points = hp->points;
+    const double * restrict xs = hp->xs;
+    const size_t * restrict rank = hp->rank;
+    const size_t npoints = hp->npoints;
+    qsort(samples, nsamples, 3 * sizeof(*samples), qsort_cmp_pdouble_asc_only_3d);
+
+    // tree[1..npoints]
+    double * restrict tree = malloc((npoints + 1) * sizeof(*tree));
+    for (size_t i = 0; i <= npoints; i++)
+        tree[i] = INFINITY;
+
+    size_t count = 0, i = 0;
+    for (size_t j = 0; j < nsamples; j++) {
+        const double * s = samples + 3 * j;
+        for (; i < npoints && points[3 * i + 2] <= s[2]; i++) {
+            const double y = points[3 * i + 1];
+            for (size_t k = rank[i]; k <= npoints; k += k & (~k + 1))
+                tree[k] = MIN(tree[k], y);
+        }
+        double min_y = INFINITY;
+        for (size_t k = upper_bound(xs, npoints, s[0]); k > 0; k &= k - 1)
+            min_y = MIN(min_y, tree[k]);
+        count += (min_y <= s[1]);
+    }
+    free(tree);
+    return count;
+}
+
+/* Each sample only needs to be compared with the points whose first
+   objective is not larger.  */
+static size_t
+count_dominated_samples_nd(const hype_points * hp,
+                           const double * restrict samples, size_t nsamples)
+{
+    const double * restrict points = hp->points;
+    const size_t npoints = hp->npoints;
+    const dimension_t nobj = hp->nobj;
+    size_t count = 0;
+    for (size_t j = 0; j < nsamples; j++) {
+        const double * s = samples + nobj * j;
+        for (size_t i = 0; i < npoints; i++) {
+            const double * p = points + nobj * i;
+            if (p[0] > s[0])
+                break;
+            if (weakly_dominates(p, s, nobj)) {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+static size_t
+count_dominated_samples_part(const hype_points * hp,
+                             double * restrict samples, size_t nsamples)
+{
+    switch (hp->nobj) {
+      case 2:
+          return count_dominated_samples_2d(hp, samples, nsamples);
+      case 3:
+          return count_dominated_samples_3d(hp, samples, nsamples);
+      default:
+          return count_dominated_samples_nd(hp, samples, nsamples);
     }
-    free(dominated);
-    free(is_dominator);
-    //free(alpha);
-    return whv;
+}
+
+/* The samples are split into parts that are counted in parallel.  The count
+   does not depend on the number of threads.  */
+static size_t
+count_dominated_samples(const hype_points * hp,
+                        double * restrict samples, size_t nsamples)
+{
+    if (hp->npoints == 0) return 0;
+    // The 3D sweep visits all points for each part.
+    const size_t part_size = MAX((size_t) 4096, hp->npoints);
+    const size_t nparts = (nsamples + part_size - 1) / part_size;
+    const dimension_t nobj = hp->nobj;
+    size_t count = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:count) schedule(static)
+#endif
+    for (size_t k = 0; k < nparts; k++) {
+        const size_t start = k * part_size;
+        const size_t n = MIN(part_size, nsamples - start);
+        count += count_dominated_samples_part(hp, samples + start * nobj, n);
+    }
+    return count;
 }
 
 static double
@@ -227,12 +421,20 @@ whv_hype_sample(const double *points, int npoints,
                 const double *ideal, const double *ref,
                 int nsamples, hype_sample_dist * dist)
 {
-    const int nobj = 2;
-    const double * samples = dist->create_samples(dist, nsamples);
-    const double * points2 = normalise01(points, npoints, nobj, ideal, ref);
-    double whv = estimate_whv(points2, npoints, samples, nsamples);
-    free((void *)samples);
-    free((void *)points2);
+    const dimension_t nobj = dist->nobj;
+    hype_points * hp = hype_points_new(
+        normalise01(points, npoints, nobj, ideal, ref), npoints, nobj);
+    const int block_size = MIN(nsamples, HYPE_SAMPLES_BLOCK);
+    double * samples = malloc(sizeof(double) * block_size * nobj);
+    size_t count = 0;
+    for (int start = 0; start < nsamples; start += block_size) {
+        const int end = MIN(nsamples, start + block_size);
+        dist->fill_samples(dist, samples, start, end, nsamples);
+        count += count_dominated_samples(hp, samples, end - start);
+    }
+    free(samples);
+    hype_points_free(hp);
+    double whv = (double) count;
     /* Eq 18 */
     //fprintf(stderr, "whv = %g\n", whv);
     whv *= calculate_volume_between_points(ideal, ref, nobj) / nsamples;
@@ -245,7 +447,7 @@ whv_hype_estimate(const double *points, int npoints,
                   const double *ideal, const double *ref,
                   hype_sample_dist * dist, int nsamples)
 {
-    const int nobj = 2;
+    const dimension_t nobj = dist->nobj;
     /* FIXME: this modifies mu, it would be better to keep mu and use a copy */
     if (dist->type == HYPE_DIST_GAUSSIAN) {
         normalise01_inplace(dist->mu, 1, nobj, ideal, ref);
@@ -255,34 +457,33 @@ whv_hype_estimate(const double *points, int npoints,
 }
 
 double
-whv_hype_unif(const double *points, int npoints,
+whv_hype_unif(const double *points, int npoints, dimension_t nobj,
               const double *ideal, const double *ref,
               int nsamples, uint32_t seed)
 {
-    hype_sample_dist * dist = hype_dist_unif_new(seed);
+    hype_sample_dist * dist = hype_dist_unif_new(nobj, seed);
     double whv = whv_hype_sample(points, npoints, ideal, ref, nsamples, dist);
     hype_dist_free(dist);
     return whv;
 }
 
 double
-whv_hype_expo(const double *points, int npoints,
+whv_hype_expo(const double *points, int npoints, dimension_t nobj,
               const double *ideal, const double *ref,
               int nsamples, uint32_t seed, double mu)
 {
-    hype_sample_dist * dist = hype_dist_exp_new(seed, mu);
+    hype_sample_dist * dist = hype_dist_exp_new(nobj, seed, mu);
     double whv = whv_hype_sample(points, npoints, ideal, ref, nsamples, dist);
     hype_dist_free(dist);
     return whv;
 }
 
 double
-whv_hype_gaus(const double *points, int npoints,
+whv_hype_gaus(const double *points, int npoints, dimension_t nobj,
               const double *ideal, const double *ref,
               int nsamples, uint32_t seed, const double *mu)
 {
-    hype_sample_dist * dist = hype_dist_gaussian_new(seed, mu);
-    const int nobj = 2;
+    hype_sample_dist * dist = hype_dist_gaussian_new(nobj, seed, mu);
     // FIXME: this modifies mu, it would be better to keep mu and use a copy.
     normalise01_inplace(dist->mu, 1, nobj, ideal, ref);
     double whv = whv_hype_sample(points, npoints, ideal, ref, nsamples, dist);
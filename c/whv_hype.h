@@ -1,14 +1,15 @@
 #ifndef WHV_HYPE_H
 #define WHV_HYPE_H
 #include <stdint.h>
+#include "libmoocore-config.h"
 
-double whv_hype_unif(const double *points, int npoints,
+double whv_hype_unif(const double *points, int npoints, dimension_t nobj,
                      const double *ideal, const double *ref,
                      int nsamples, uint32_t seed);
-double whv_hype_expo(const double *points, int npoints,
+double whv_hype_expo(const double *points, int npoints, dimension_t nobj,
                      const double *ideal, const double *ref,
                      int nsamples, uint32_t seed, double mu);
-double whv_hype_gaus(const double *points, int npoints,
+double whv_hype_gaus(const double *points, int npoints, dimension_t nobj,
                      const double *ideal, const double *ref,
                      int nsamples, uint32_t seed, const double *mu);
 
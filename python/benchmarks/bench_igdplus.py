@@ -7,8 +7,10 @@ This example benchmarks the hypervolume implementation in ``moocore`` against ot
 
 from bench import Bench, read_data, check_float_values
 
+import os
 import numpy as np
 import moocore
+from moocore._libmoocore import lib
 import pathlib
 import matplotlib.pyplot as plt
 
@@ -60,5 +62,42 @@ for name in names:
     bench(lambda n: x[:n, :])
     bench.plots(file_prefix=file_prefix, title=title)
 
+# Scaling across the number of threads.  This requires moocore to be built
+# with OpenMP support, for example, with MOOCORE_OPENMP=1 python3 -m pip install .
+
+
+def igd_plus_threads(z, ref, nthreads):
+    lib.moocore_set_num_threads(nthreads)
+    return moocore.igd_plus(z, ref=ref)
+
+
+max_threads = os.cpu_count() or 1
+threads = sorted({2**k for k in range(max_threads.bit_length())} | {max_threads})
+
+title = "IGD+ computation (threads)"
+file_prefix = "igd_plus_threads"
+print(f"Running benchmark: {title}")
+for name in names:
+    x = read_data(files[name][0])
+    ref = read_data(files[name][1])
+    n = np.arange(5000, len(x) + 1, 5000)
+
+    bench = Bench(
+        name=name,
+        n=n,
+        bench={
+            f"moocore ({k} threads)": (
+                lambda z, ref=ref, k=k: igd_plus_threads(z, ref, k)
+            )
+            for k in threads
+        },
+        check=check_float_values,
+        baseline="moocore (1 threads)",
+    )
+
+    bench(lambda n: x[:n, :])
+    bench.plots(file_prefix=file_prefix, title=title)
+lib.moocore_set_num_threads(max_threads)
+
 if "__file__" not in globals():  # Running interactively.
     plt.show()
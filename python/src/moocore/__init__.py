@@ -1,6 +1,11 @@
 # ruff: noqa: D104
 from ._moocore import (
+    AvgHausdorffDist,
+    EpsilonAdditive,
+    EpsilonMult,
     Hypervolume,
+    IGD,
+    IGDPlus,
     ReadDatasetsError,
     RelativeHypervolume,
     any_dominated,
@@ -11,6 +16,7 @@ from ._moocore import (
     epsilon_additive,
     epsilon_mult,
     r2_exact,
+    r2_approx,
     filter_dominated,
     filter_dominated_within_sets,
     generate_ndset,
@@ -45,7 +51,12 @@ del _metadata_version
 
 
 __all__ = [
+    "AvgHausdorffDist",
+    "EpsilonAdditive",
+    "EpsilonMult",
     "Hypervolume",
+    "IGD",
+    "IGDPlus",
     "ReadDatasetsError",
     "RelativeHypervolume",
     "any_dominated",
@@ -70,6 +81,7 @@ __all__ = [
     "largest_eafdiff",
     "normalise",
     "pareto_rank",
+    "r2_approx",
     "r2_exact",
     "read_datasets",
     "total_whv_rect",
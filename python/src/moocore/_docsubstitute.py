@@ -11,6 +11,9 @@ COMMON_PARAMS = {
     #
     "ref_set": """Reference set as a matrix of numerical values. Must have the same number of columns as ``points``.""",
     #
+    "norm": """Norm used to measure the distance between points: ``1`` (taxicab or Manhattan distance),
+    ``2`` (Euclidean distance) or ``numpy.inf`` (Chebyshev or maximum distance).""",
+    #
     "ref_point": """Reference point as a 1D vector. Must be either a single value, which will be used for all coordinates,
     or the same length as a single point in ``points``.""",
     #
@@ -20,6 +23,9 @@ COMMON_PARAMS = {
     #
     "sets_of_points": """1D vector or list of values that gives the set of each row of ``points``.""",
     #
+    "threads": """Number of threads used by the C code. ``None`` keeps the current setting.
+    It has no effect unless moocore was compiled with OpenMP (``MOOCORE_OPENMP=1``).""",
+    #
     "whv_rectangles": """Weighted rectangles that will bias the computation of the hypervolume.
     Maybe generated by :func:`eafdiff()` with  ``rectangles=True`` or by :func:`choose_eafdiff()`.""",
 }
@@ -14,6 +14,8 @@ from cffi import FFI
 
 # Compile in debug mode.
 DEBUG = int(os.environ.get("MOOCORE_DEBUG", "0"))
+# Compile with OpenMP multi-threading.
+OPENMP = int(os.environ.get("MOOCORE_OPENMP", "0"))
 
 libmoocore_h = "src/moocore/libmoocore.h"
 sources_path = "src/moocore/libmoocore/"
@@ -25,6 +27,7 @@ headers = """
 #include "epsilon.h"
 #include "eaf.h"
 #include "r2_exact.h"
+#include "r2_approx.h"
 #include "whv.h"
 #include "whv_hype.h"
 #include "hvapprox.h"
@@ -33,7 +36,9 @@ sources = [
     "avl.c",
     "eaf.c",
     "eaf3d.c",
+    "eafnd.c",
     "eafdiff.c",
+    "r2_approx.c",
     "r2_exact.c",
     "hv.c",
     "hvapprox.c",
@@ -42,10 +47,13 @@ sources = [
     "hvc3d.c",
     "hv_contrib.c",
     "io.c",
+    "largest_eafdiff.c",
     "libutil.c",  # For fatal_error()
     "mt19937/mt19937.c",
+    "nondominated_dispatch.c",
     "pareto.c",
     "rng.c",
+    "vorob.c",
     "whv.c",
     "whv_hype.c",
 ]
@@ -114,6 +122,11 @@ else:
     if not is_macos:
         ldflags += ["-Wl,-z,now"]
 
+if OPENMP:
+    openmp_flags = ["/openmp:llvm"] if is_windows and uses_msvc() else ["-fopenmp"]
+    cflags += openmp_flags
+    ldflags += openmp_flags
+
 cflags_env = os.environ.get("CFLAGS", "").split()
 cflags += cflags_env
 ldflags += cflags_env + os.environ.get("LDFLAGS", "").split()
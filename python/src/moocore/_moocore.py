@@ -1,8 +1,9 @@
 from __future__ import annotations
 
 import os
+from contextlib import contextmanager
 from io import StringIO
-from collections.abc import Callable, Sequence
+from collections.abc import Callable, Iterator, Sequence
 from numpy.typing import ArrayLike  # For type hints
 from typing import Literal, Any, NamedTuple
 
@@ -17,10 +18,9 @@ import numpy as np
 
 from ._utils import (
     asarray_maybe_copy,
-    unique_nosort,
     np2d_to_double_array,
     np1d_to_double_array,
-    np1d_to_int_array,
+    np1d_to_c_array,
     array_1d_of_length_n,
     is_integer_value,
     _get_seed_for_c,
@@ -185,6 +185,28 @@ def _parse_maximise_to_bool_array(
     )
 
 
+def _group_by_sets(
+    sets: ArrayLike, nrows: int
+) -> tuple[np.ndarray, ffi.CData, ffi.CData]:
+    """Order rows by set and compute the cumulative sizes of the sets.
+
+    The C library expects the points grouped by set. A stable sort keeps the
+    relative order of points within each set, which matters for duplicates.
+    """
+    sets = np.ravel(sets)
+    if len(sets) != nrows:
+        raise ValueError(
+            f"'sets' must have length {nrows}, but it has length {len(sets)}"
+        )
+    order = np.argsort(sets, kind="stable")
+    sets = sets.take(order)
+    cumsizes = np.append(np.flatnonzero(sets[1:] != sets[:-1]) + 1, nrows)
+    cumsizes_p, nsets = np1d_to_c_array(
+        cumsizes.astype(np.uintp), ctype_data="size_t", ctype_size="size_t"
+    )
+    return order, cumsizes_p, nsets
+
+
 def _all_positive(x: ArrayLike) -> bool:
     return x.min() > 0
 
@@ -194,7 +216,15 @@ def _igd_python(
     ref: ArrayLike,
     maximise: bool | Sequence[bool] = False,
     p: int = 1,
+    norm: float = 2,
 ) -> float:
+    if norm != 2:
+        points = np.asarray(points, dtype=float)
+        ref = np.atleast_2d(np.asarray(ref, dtype=float))
+        dists = np.array(
+            [np.linalg.norm(points - r, ord=norm, axis=1).min() for r in ref]
+        )
+        return float((dists**p).mean() ** (1.0 / p))
     points = np.asarray(points, dtype=float)
     points_sq = (points * points).sum(axis=1)
     ref = np.atleast_2d(np.asarray(ref, dtype=float))
@@ -207,7 +237,9 @@ def _igd_python(
     return float(res)
 
 
-def _igd_plus_python(points, ref, maximise: bool | Sequence[bool] = False):
+def _igd_plus_python(
+    points, ref, maximise: bool | Sequence[bool] = False, norm: float = 2
+):
     points, points_copied = asarray_maybe_copy(points)
     ref, ref_copied = asarray_maybe_copy(ref)
     ref = np.atleast_2d(ref)
@@ -222,16 +254,26 @@ def _igd_plus_python(points, ref, maximise: bool | Sequence[bool] = False):
             ref = ref.copy()
         ref[:, maximise] = -ref[:, maximise]
 
-    res = np.sqrt(
-        [(np.maximum(points - r, 0) ** 2).sum(axis=1).min() for r in ref]
-    ).mean()
+    res = np.mean(
+        [
+            np.linalg.norm(np.maximum(points - r, 0), ord=norm, axis=1).min()
+            for r in ref
+        ]
+    )
     return float(res)
 
 
 def _avg_hausdorff_dist_python(
-    points, ref, maximise: bool | Sequence[bool] = False, p: int = 1
+    points,
+    ref,
+    maximise: bool | Sequence[bool] = False,
+    p: int = 1,
+    norm: float = 2,
 ):
-    return max(_igd_python(points, ref, p), _igd_python(ref, points, p))
+    return max(
+        _igd_python(points, ref, p=p, norm=norm),
+        _igd_python(ref, points, p=p, norm=norm),
+    )
 
 
 def _epsilon_addi_python(points, ref, maximise: bool | Sequence[bool] = False):
@@ -309,6 +351,16 @@ def _unary_refset_common(
     return nobj, points_p, npoints_c, nobj_c, ref_p, ref_size, maximise_p
 
 
+def _parse_norm(norm: float):
+    if norm == 1:
+        return lib.DIST_NORM_L1
+    if norm == 2:
+        return lib.DIST_NORM_L2
+    if norm == np.inf:
+        return lib.DIST_NORM_LINF
+    raise ValueError(f"'norm' must be 1, 2 or numpy.inf, not {norm}")
+
+
 @DocSubstitute()
 def igd(
     points: ArrayLike,
@@ -316,6 +368,7 @@ def igd(
     ref: ArrayLike,
     *,
     maximise: bool | Sequence[bool] = False,
+    norm: float = 2,
 ) -> float:
     """Inverted Generational Distance (IGD).
 
@@ -330,6 +383,8 @@ def igd(
         ${ref_set}
     maximise :
         ${maximise}
+    norm :
+        ${norm}
 
     Returns
     -------
@@ -339,9 +394,10 @@ def igd(
     nobj, points_p, n, d, ref_p, ref_size, maximise_p = _unary_refset_common(
         points, ref, maximise
     )
+    norm_c = _parse_norm(norm)
     if nobj == 1 or nobj > DIMENSION_MAX:
-        return _igd_python(points, ref)
-    return lib.IGD(points_p, n, d, ref_p, ref_size, maximise_p)
+        return _igd_python(points, ref, norm=norm)
+    return lib.IGD_norm(points_p, n, d, ref_p, ref_size, maximise_p, norm_c)
 
 
 @DocSubstitute()
@@ -351,6 +407,7 @@ def igd_plus(
     ref: ArrayLike,
     *,
     maximise: bool | Sequence[bool] = False,
+    norm: float = 2,
 ) -> float:
     r"""Modified IGD (IGD+).
 
@@ -366,6 +423,8 @@ def igd_plus(
         ${ref_set}
     maximise :
         ${maximise}
+    norm :
+        ${norm}
 
 
     Returns
@@ -402,14 +461,25 @@ def igd_plus(
     which both contradict Pareto optimality. By contrast,
     IGD+(A)=1.482842712474619 < IGD+(B)=2.260112615949154, which is correct.
 
+    Other norms, such as the taxicab (L1) norm, may be used to measure
+    distances:
+
+    >>> moocore.igd_plus(A, ref, norm=1)
+    1.6
+    >>> moocore.igd_plus(A, ref, norm=np.inf)
+    1.4
+
 
     """  # noqa: D401
     nobj, points_p, n, d, ref_p, ref_size, maximise_p = _unary_refset_common(
         points, ref, maximise
     )
+    norm_c = _parse_norm(norm)
     if nobj == 1 or nobj > DIMENSION_MAX:
-        return _igd_plus_python(points, ref, maximise)
-    return lib.IGD_plus(points_p, n, d, ref_p, ref_size, maximise_p)
+        return _igd_plus_python(points, ref, maximise, norm=norm)
+    return lib.IGD_plus_norm(
+        points_p, n, d, ref_p, ref_size, maximise_p, norm_c
+    )
 
 
 @DocSubstitute()
@@ -420,6 +490,7 @@ def avg_hausdorff_dist(
     *,
     maximise: bool | Sequence[bool] = False,
     p: int = 1,
+    norm: float = 2,
 ) -> float:
     """Average Hausdorff distance.
 
@@ -435,6 +506,8 @@ def avg_hausdorff_dist(
         ${maximise}
     p :
         Hausdorff distance parameter. Must be larger than 0.
+    norm :
+        ${norm}
 
     Returns
     -------
@@ -448,16 +521,387 @@ def avg_hausdorff_dist(
         raise ValueError("'p' must be an integer")
     if p <= 0:
         raise ValueError("'p' must be larger than zero")
+    norm_c = _parse_norm(norm)
 
     if nobj == 1 or nobj > DIMENSION_MAX:
-        return _avg_hausdorff_dist_python(points, ref, p)
+        return _avg_hausdorff_dist_python(points, ref, p=p, norm=norm)
 
     p = ffi.cast("unsigned int", p)
-    return lib.avg_Hausdorff_dist(
-        points_p, n, d, ref_p, ref_size, maximise_p, p
+    return lib.avg_Hausdorff_dist_norm(
+        points_p, n, d, ref_p, ref_size, maximise_p, p, norm_c
     )
 
 
+class _RefSetIndicator:
+    """Reference set prepared once for computing a unary indicator of many sets.
+
+    The reference set is validated and copied to the C library only once,
+    instead of on every call.  Subclasses set ``_refset_new`` and
+    ``_refset_free`` to the C functions that create and free the prepared
+    reference set.
+    """
+
+    _check_all_positive = False
+
+    def __init__(
+        self, ref: ArrayLike, maximise: bool | Sequence[bool] = False
+    ) -> None:
+        ref = np.atleast_2d(np.asarray(ref, dtype=float))
+        nobj = ref.shape[1]
+        if nobj == 0:
+            raise ValueError("The number of columns cannot be 0")
+        if len(ref) == 0:
+            raise ValueError("The reference set cannot be empty")
+        if self._check_all_positive and not _all_positive(ref):
+            raise ValueError(
+                "All values must be larger than 0 in the reference set"
+            )
+        self._nobj = nobj
+        self._maximise = _parse_maximise(maximise, nobj)
+        self._refset = None
+        if nobj == 1 or nobj > DIMENSION_MAX:
+            # Fallback to the Python implementation.
+            self._ref = ref
+            return
+        ref_p, ref_size = np1d_to_double_array(ref, ctype_size="size_t")
+        maximise_p = _parse_maximise_to_bool_array(self._maximise, nobj)
+        self._refset = ffi.gc(
+            self._new_refset(ref_p, ref_size, nobj, maximise_p),
+            type(self)._refset_free,
+        )
+
+    def _new_refset(self, ref_p, ref_size, nobj, maximise_p):
+        return type(self)._refset_new(ref_p, ref_size, nobj, maximise_p)
+
+    def _points(self, points: ArrayLike):
+        points = np.asarray(points, dtype=float)
+        if points.shape[1] != self._nobj:
+            raise ValueError(
+                f"points and ref need to have the same number of columns ({points.shape[1]} != {self._nobj})"
+            )
+        if self._check_all_positive and not _all_positive(points):
+            raise ValueError(
+                "All values must be larger than 0 in the input points"
+            )
+        if self._refset is None:
+            return points, None
+        points_p, npoints, _ = np2d_to_double_array(
+            points, ctype_shape=("size_t", "uint_fast8_t")
+        )
+        return points_p, npoints
+
+
+class _GDRefSet(_RefSetIndicator):
+    # The C library also builds a k-d tree over the reference set, if useful.
+    _refset_new = lib.gd_refset_new
+    _refset_free = lib.gd_refset_free
+
+    def __init__(
+        self,
+        ref: ArrayLike,
+        maximise: bool | Sequence[bool] = False,
+        norm: float = 2,
+    ) -> None:
+        self._norm_c = _parse_norm(norm)
+        self._norm = norm
+        super().__init__(ref=ref, maximise=maximise)
+
+    def _new_refset(self, ref_p, ref_size, nobj, maximise_p):
+        return type(self)._refset_new(
+            ref_p, ref_size, nobj, maximise_p, self._norm_c
+        )
+
+
+class _EpsilonRefSet(_RefSetIndicator):
+    _refset_new = lib.epsilon_refset_new
+    _refset_free = lib.epsilon_refset_free
+
+
+@DocSubstitute()
+class IGD(_GDRefSet):
+    """Object-oriented interface for the inverted generational distance (IGD).
+
+    The reference set is preprocessed once, which makes computing the IGD of
+    many sets with respect to the same reference set faster than calling
+    :func:`igd` repeatedly.
+
+    .. seealso:: For details of the calculation, see :func:`igd`.
+
+    Parameters
+    ----------
+    ref :
+        ${ref_set}
+    maximise :
+        ${maximise}
+    norm :
+        ${norm}
+
+
+    Examples
+    --------
+    >>> ref = np.array([[1, 6], [2, 5], [3, 4], [4, 3], [5, 2], [6, 1]])
+    >>> igd_ind = moocore.IGD(ref)
+    >>> igd_ind([[3.5, 5.5], [3.6, 4.1], [4.1, 3.2], [5.5, 1.5]])
+    1.0627908666722465
+
+    See Also
+    --------
+    IGDPlus, AvgHausdorffDist
+
+    """
+
+    @DocSubstitute()
+    def __call__(self, points: ArrayLike) -> float:
+        """Compute the IGD of ``points``.
+
+        Parameters
+        ----------
+        points :
+            ${points}
+
+        Returns
+        -------
+            A single numerical value.
+
+        """
+        points_p, n = self._points(points)
+        if n is None:
+            return _igd_python(points_p, self._ref, norm=self._norm)
+        return lib.IGD_refset(self._refset, points_p, n)
+
+
+@DocSubstitute()
+class IGDPlus(_GDRefSet):
+    """Object-oriented interface for the modified IGD (IGD+).
+
+    The reference set is preprocessed once, which makes computing the IGD+ of
+    many sets with respect to the same reference set faster than calling
+    :func:`igd_plus` repeatedly.
+
+    .. seealso:: For details of the calculation, see :func:`igd_plus`.
+
+    Parameters
+    ----------
+    ref :
+        ${ref_set}
+    maximise :
+        ${maximise}
+    norm :
+        ${norm}
+
+
+    Examples
+    --------
+    >>> ref = np.array([[1, 6], [2, 5], [3, 4], [4, 3], [5, 2], [6, 1]])
+    >>> igd_plus_ind = moocore.IGDPlus(ref)
+    >>> igd_plus_ind([[3.5, 5.5], [3.6, 4.1], [4.1, 3.2], [5.5, 1.5]])
+    0.9855036468106652
+
+    See Also
+    --------
+    IGD, AvgHausdorffDist
+
+    """
+
+    @DocSubstitute()
+    def __call__(self, points: ArrayLike) -> float:
+        """Compute the IGD+ of ``points``.
+
+        Parameters
+        ----------
+        points :
+            ${points}
+
+        Returns
+        -------
+            A single numerical value.
+
+        """
+        points_p, n = self._points(points)
+        if n is None:
+            return _igd_plus_python(
+                points_p, self._ref, self._maximise, norm=self._norm
+            )
+        return lib.IGD_plus_refset(self._refset, points_p, n)
+
+
+@DocSubstitute()
+class AvgHausdorffDist(_GDRefSet):
+    """Object-oriented interface for the average Hausdorff distance.
+
+    The reference set is preprocessed once, which makes computing the average
+    Hausdorff distance of many sets with respect to the same reference set
+    faster than calling :func:`avg_hausdorff_dist` repeatedly.
+
+    .. seealso:: For details of the calculation, see :func:`avg_hausdorff_dist`.
+
+    Parameters
+    ----------
+    ref :
+        ${ref_set}
+    maximise :
+        ${maximise}
+    p :
+        Hausdorff distance parameter. Must be larger than 0.
+    norm :
+        ${norm}
+
+
+    Examples
+    --------
+    >>> ref = np.array([[1, 6], [2, 5], [3, 4], [4, 3], [5, 2], [6, 1]])
+    >>> hausdorff_ind = moocore.AvgHausdorffDist(ref)
+    >>> hausdorff_ind([[3.5, 5.5], [3.6, 4.1], [4.1, 3.2], [5.5, 1.5]])
+    1.0627908666722465
+
+    See Also
+    --------
+    IGD, IGDPlus
+
+    """
+
+    def __init__(
+        self,
+        ref: ArrayLike,
+        maximise: bool | Sequence[bool] = False,
+        p: int = 1,
+        norm: float = 2,
+    ) -> None:
+        if not is_integer_value(p):
+            raise ValueError("'p' must be an integer")
+        if p <= 0:
+            raise ValueError("'p' must be larger than zero")
+        super().__init__(ref=ref, maximise=maximise, norm=norm)
+        self._p = int(p)
+
+    @DocSubstitute()
+    def __call__(self, points: ArrayLike) -> float:
+        """Compute the average Hausdorff distance of ``points``.
+
+        Parameters
+        ----------
+        points :
+            ${points}
+
+        Returns
+        -------
+            A single numerical value.
+
+        """
+        points_p, n = self._points(points)
+        if n is None:
+            return _avg_hausdorff_dist_python(
+                points_p, self._ref, p=self._p, norm=self._norm
+            )
+        return lib.avg_Hausdorff_dist_refset(
+            self._refset, points_p, n, ffi.cast("unsigned int", self._p)
+        )
+
+
+@DocSubstitute()
+class EpsilonAdditive(_EpsilonRefSet):
+    """Object-oriented interface for the additive epsilon metric.
+
+    The reference set is preprocessed once, which makes computing the additive
+    epsilon metric of many sets with respect to the same reference set faster
+    than calling :func:`epsilon_additive` repeatedly.
+
+    .. seealso:: For details of the calculation, see :func:`epsilon_additive`.
+
+    Parameters
+    ----------
+    ref :
+        ${ref_set}
+    maximise :
+        ${maximise}
+
+
+    Examples
+    --------
+    >>> ref = np.array([[1, 6], [2, 5], [3, 4], [4, 3], [5, 2], [6, 1]])
+    >>> eps_ind = moocore.EpsilonAdditive(ref)
+    >>> eps_ind([[3.5, 5.5], [3.6, 4.1], [4.1, 3.2], [5.5, 1.5]])
+    2.5
+
+    See Also
+    --------
+    EpsilonMult
+
+    """
+
+    @DocSubstitute()
+    def __call__(self, points: ArrayLike) -> float:
+        """Compute the additive epsilon metric of ``points``.
+
+        Parameters
+        ----------
+        points :
+            ${points}
+
+        Returns
+        -------
+            A single numerical value.
+
+        """
+        points_p, n = self._points(points)
+        if n is None:
+            return _epsilon_addi_python(points_p, self._ref, self._maximise)
+        return lib.epsilon_additive_refset(self._refset, points_p, n)
+
+
+@DocSubstitute()
+class EpsilonMult(_EpsilonRefSet):
+    """Object-oriented interface for the multiplicative epsilon metric.
+
+    The reference set is preprocessed once, which makes computing the
+    multiplicative epsilon metric of many sets with respect to the same
+    reference set faster than calling :func:`epsilon_mult` repeatedly.
+
+    .. seealso:: For details of the calculation, see :func:`epsilon_mult`.
+
+    Parameters
+    ----------
+    ref :
+        ${ref_set}
+    maximise :
+        ${maximise}
+
+
+    Examples
+    --------
+    >>> ref = np.array([[1, 6], [2, 5], [3, 4], [4, 3], [5, 2], [6, 1]])
+    >>> eps_ind = moocore.EpsilonMult(ref)
+    >>> eps_ind([[3.5, 5.5], [3.6, 4.1], [4.1, 3.2], [5.5, 1.5]])
+    3.5
+
+    See Also
+    --------
+    EpsilonAdditive
+
+    """
+
+    _check_all_positive = True
+
+    @DocSubstitute()
+    def __call__(self, points: ArrayLike) -> float:
+        """Compute the multiplicative epsilon metric of ``points``.
+
+        Parameters
+        ----------
+        points :
+            ${points}
+
+        Returns
+        -------
+            A single numerical value.
+
+        """
+        points_p, n = self._points(points)
+        if n is None:
+            return _epsilon_mult_python(points_p, self._ref, self._maximise)
+        return lib.epsilon_mult_refset(self._refset, points_p, n)
+
+
 @DocSubstitute()
 def epsilon_additive(
     points: ArrayLike,
@@ -468,10 +912,12 @@ def epsilon_additive(
 ) -> float:
     r"""Additive epsilon metric.
 
-    The current implementation uses the naive algorithm that requires
-    :math:`O(m \cdot |A| \cdot |R|)`, where :math:`m` is the number of
-    objectives (dimension of vectors), :math:`A` is the input set and :math:`R`
-    is the reference set.
+    Let :math:`m` be the number of objectives (dimension of vectors), :math:`A`
+    the input set and :math:`R` the reference set.  When :math:`m \leq 8`,
+    :math:`|A| \geq 256` and :math:`|R| \geq 16`, the current implementation
+    searches a k-d tree built over :math:`A` for each point of :math:`R`, which
+    skips most of :math:`A` and gives exactly the same result.  Otherwise, it
+    uses the naive algorithm that requires :math:`O(m \cdot |A| \cdot |R|)`.
 
     .. seealso:: For details of the calculation, see :ref:`epsilon_metric`.
 
@@ -524,7 +970,7 @@ def epsilon_mult(
     .. warning::
        All values in ``points`` and ``ref`` must be larger than 0.
 
-    .. seealso:: For examples, see :func:`epsilon_additive`.  For details of the calculation, see :ref:`epsilon_metric`.
+    .. seealso:: For examples and the algorithm used, see :func:`epsilon_additive`.  For details of the calculation, see :ref:`epsilon_metric`.
 
     Parameters
     ----------
@@ -1415,10 +1861,14 @@ def is_nondominated(
 
     For :math:`m \geq 4`, functions :func:`is_nondominated` and
     :func:`filter_dominated` use the best-known :math:`O(n \log^{m-2} n)`
-    algorithm :footcite:p:`KunLucPre1975jacm` when :math:`n > \KUNGSMALLTHRESHOLD`,
-    and the naive :math:`O(m n^2)` algorithm otherwise.
-    Function :func:`any_dominated` always uses the naive algorithm for :math:`m
-    \geq 4`.
+    algorithm :footcite:p:`KunLucPre1975jacm` when :math:`n` reaches a
+    threshold that depends on :math:`m`, and the naive :math:`O(m n^2)`
+    algorithm otherwise.  By default, the threshold is :math:`n \geq 24` for
+    :math:`m \leq 5` and :math:`n > \KUNGSMALLTHRESHOLD` for :math:`m \geq 6`.
+    Function :func:`any_dominated` uses the same algorithms and stops as soon as
+    it finds a dominated point.  Since the naive algorithm may stop earlier,
+    its default threshold is :math:`n \geq 48` for :math:`m \leq 5`
+    and :math:`n > \KUNGSMALLTHRESHOLD` for :math:`m \geq 6`.
 
 
     References
@@ -1567,8 +2017,9 @@ def is_nondominated_within_sets(
 
     Executes the :func:`is_nondominated` function within each set in a dataset
     and returns back a 1D array of booleans. This is equivalent to
-    ``apply_within_sets(points, sets, is_nondominated, ...)`` but slightly
-    faster.
+    ``apply_within_sets(points, sets, is_nondominated, ...)`` but much faster
+    when there are many sets, because all sets are processed by a single call
+    to the C library.
 
     Parameters
     ----------
@@ -1624,26 +2075,33 @@ def is_nondominated_within_sets(
 
     """
     points = np.asarray(points, dtype=float)
-    ncols = points.shape[1]
+    if len(points.shape) != 2:
+        raise ValueError("'points' must be a matrix")
+    nrows, ncols = points.shape
     if ncols < 2:
         raise ValueError("'points' must have at least 2 columns (2 objectives)")
-
-    # FIXME: How can we make this faster?
-    _, idx, inv = np.unique(sets, return_index=True, return_inverse=True)
-    # Remember the original position of each element of each set.
-    idx = [np.flatnonzero(inv == i) for i in idx.argsort()]
-    points = np.concatenate(
-        [
-            is_nondominated(
-                points.take(g_idx, axis=0),
-                maximise=maximise,
-                keep_weakly=keep_weakly,
-            )
-            for g_idx in idx
-        ]
+    _check_dimension_max(ncols, DIMENSION_MAX)
+    order, cumsizes_p, nsets = _group_by_sets(sets, nrows)
+    if nrows == 0:
+        return np.array([], dtype=bool)
+    keep_weakly = ffi.cast("bool", bool(keep_weakly))
+    maximise_p = _parse_maximise_to_bool_array(maximise, ncols)
+    points_p, _, nobj = np2d_to_double_array(
+        points.take(order, axis=0), ctype_shape=("size_t", "uint_fast8_t")
     )
-    idx = np.concatenate(idx).argsort()
-    return points.take(idx, axis=0)
+    nondom = np.empty(nrows, dtype=bool)
+    lib.is_nondominated_within_sets(
+        ffi.from_buffer("uint8_t []", nondom.view(np.uint8)),
+        points_p,
+        nobj,
+        cumsizes_p,
+        nsets,
+        keep_weakly,
+        maximise_p,
+    )
+    res = np.empty(nrows, dtype=bool)
+    res[order] = nondom
+    return res
 
 
 @DocSubstitute()
@@ -1974,9 +2432,35 @@ def normalise(
     return points
 
 
+@contextmanager
+def _num_threads(threads: int | None) -> Iterator[None]:
+    """Temporarily set the number of threads used by the C code.
+
+    It has no effect unless moocore was compiled with OpenMP.
+    """
+    if threads is None:
+        yield
+        return
+    if not is_integer_value(threads) or threads < 1:
+        raise ValueError(
+            f"'threads' must be a positive integer, got {threads!r}"
+        )
+    old_threads = lib.moocore_get_num_threads()
+    lib.moocore_set_num_threads(int(threads))
+    try:
+        yield
+    finally:
+        lib.moocore_set_num_threads(old_threads)
+
+
 @DocSubstitute()
 def eaf(
-    points: ArrayLike, /, sets: ArrayLike, *, percentiles: Sequence[float] = ()
+    points: ArrayLike,
+    /,
+    sets: ArrayLike,
+    *,
+    percentiles: Sequence[float] = (),
+    threads: int | None = None,
 ) -> np.ndarray:
     r"""Exact computation of the Empirical Attainment Function (EAF).
 
@@ -1990,6 +2474,8 @@ def eaf(
         ${sets_of_points}
     percentiles :
         List indicating which percentiles are computed. By default, all possible percentiles are calculated.
+    threads :
+        ${threads}
 
     Returns
     -------
@@ -2005,7 +2491,12 @@ def eaf(
     proposed by :footcite:t:`FonGueLopPaq2011emo`, which have complexity
     :math:`\Theta(m\log m + nm)` in 2D and :math:`O(n^2 m \log m)` in 3D, where
     :math:`n` is the number of input sets and :math:`m` is the total number of
-    input points.
+    input points.  With more than three objectives, the points are swept in
+    increasing order of the last objective and, for each point, the EAF of the
+    points seen so far is computed without the last objective, but only within
+    the region dominated by that point.  This requires :math:`O(m)`
+    computations of the EAF with one objective less, thus it is only practical
+    for moderately sized inputs.
 
 
     References
@@ -2067,10 +2558,6 @@ def eaf(
     ncols = points.shape[1]
     if ncols < 2:
         raise ValueError("'points' must have at least 2 columns")
-    if ncols > 3:
-        raise NotImplementedError(
-            "Only 2D or 3D datasets are currently supported for computing the EAF"
-        )
     if len(sets) != points.shape[0]:
         raise ValueError(
             "'sets' must have the same length as the number of rows of 'points'"
@@ -2079,7 +2566,9 @@ def eaf(
     _, cumsizes = np.unique(sets, return_counts=True)
     nsets = len(cumsizes)
     cumsizes = np.cumsum(cumsizes)
-    cumsizes_p, ncumsizes = np1d_to_int_array(cumsizes)
+    cumsizes_p, ncumsizes = np1d_to_c_array(
+        cumsizes.astype(np.uintp), ctype_data="size_t", ctype_size="int"
+    )
     percentiles = np.ravel(percentiles)
     if len(percentiles) == 0:
         percentiles = np.arange(1.0, nsets + 1) * (100.0 / nsets)
@@ -2089,16 +2578,17 @@ def eaf(
 
     # Get C pointers + matrix size for calling CFFI generated extension module
     points_p, _, nobj = np2d_to_double_array(points)
-    eaf_npoints = ffi.new("int *")
-    eaf_data_p = lib.eaf_compute_matrix(
-        eaf_npoints,
-        points_p,
-        nobj,
-        cumsizes_p,
-        ncumsizes,
-        percentile_p,
-        npercentiles,
-    )
+    eaf_npoints = ffi.new("size_t *")
+    with _num_threads(threads):
+        eaf_data_p = lib.eaf_compute_matrix(
+            eaf_npoints,
+            points_p,
+            nobj,
+            cumsizes_p,
+            ncumsizes,
+            percentile_p,
+            npercentiles,
+        )
     eaf_npoints = eaf_npoints[0]
     eaf_buf = ffi.buffer(
         eaf_data_p, ffi.sizeof("double") * eaf_npoints * (ncols + 1)
@@ -2106,6 +2596,23 @@ def eaf(
     return np.frombuffer(eaf_buf).reshape((eaf_npoints, -1))
 
 
+def _vorob_args(points: ArrayLike, sets: ArrayLike, ref: ArrayLike):
+    points = np.asarray(points, dtype=float)
+    nobj = points.shape[1]
+    if nobj < 2:
+        raise ValueError("'points' must have at least 2 columns")
+    _check_dimension_max(nobj, HV_DIMENSION_MAX)
+    ref = np.array(ref, dtype=float, ndmin=1)
+    if len(ref) == 1:
+        ref = np.full((nobj), ref[0])
+    elif len(ref) != nobj:
+        raise ValueError(
+            f"points and ref need to have the same number of objectives ({nobj} != {len(ref)})"
+        )
+    order, cumsizes_p, nsets = _group_by_sets(sets, points.shape[0])
+    return points, ref, order, cumsizes_p, ffi.cast("int", nsets)
+
+
 class VorobtResult(NamedTuple):
     threshold: float
     ve: np.ndarray
@@ -2159,28 +2666,29 @@ def vorob_t(
     >>> res.ve.shape
     (213, 2)
     """
-    points = np.asarray(points, dtype=float)
+    points, ref, order, cumsizes_p, nsets = _vorob_args(points, sets, ref)
     nobj = points.shape[1]
-    if nobj < 2:
-        raise ValueError("'points' must have at least 2 columns")
-
-    hv_ind = Hypervolume(ref=ref)
-    avg_hyp = np.mean(apply_within_sets(points, sets, hv_ind))
-    prev_hyp = diff = np.inf  # hypervolume of quantile at previous step
-    a = 0.0
-    b = 100.0
-    while diff != 0:
-        c = (a + b) / 2.0
-        eaf_res = eaf(points, sets=sets, percentiles=c)[:, :nobj]
-        tmp = hv_ind(eaf_res)
-        if tmp > avg_hyp:
-            a = c
-        else:
-            b = c
-        diff = prev_hyp - tmp
-        prev_hyp = tmp
-
-    return VorobtResult(threshold=c, ve=eaf_res, avg_hyp=float(avg_hyp))
+    points_p, _, nobj_p = np2d_to_double_array(points.take(order, axis=0))
+    threshold = ffi.new("double *")
+    avg_hyp = ffi.new("double *")
+    ve_npoints = ffi.new("size_t *")
+    ve_p = lib.vorob_expectation(
+        threshold,
+        avg_hyp,
+        ve_npoints,
+        points_p,
+        nobj_p,
+        cumsizes_p,
+        nsets,
+        ffi.from_buffer("double []", ref),
+    )
+    size = ve_npoints[0] * nobj
+    # Ensure that Python can free the data allocated by the C library.
+    ve_p = ffi.gc(ve_p, lib.free, size=size)
+    ve = np.frombuffer(ffi.buffer(ve_p, ffi.sizeof("double") * size))
+    return VorobtResult(
+        threshold=threshold[0], ve=ve.reshape(-1, nobj), avg_hyp=avg_hyp[0]
+    )
 
 
 @DocSubstitute()
@@ -2230,27 +2738,26 @@ def vorob_dev(
     3017.12989402326
 
     """
-    points = np.asarray(points, dtype=float)
-    nobj = points.shape[1]
-    if nobj < 2:
-        raise ValueError("'points' must have at least 2 columns")
-
-    # Hypervolume of the symmetric difference between A and B:
-    # 2 * H(AUB) - H(A) - H(B)
-    hv_ind = Hypervolume(ref=ref)
-
     if ve is None:
-        res = vorob_t(points, sets=sets, ref=ref)
-        ve = res.ve
-        h1 = res.avg_hyp
-    else:
-        h1 = np.mean(apply_within_sets(points, sets, hv_ind))
-
-    h2 = hv_ind(ve)
-    vd = 2 * np.mean(
-        apply_within_sets(points, sets, lambda g: hv_ind(np.vstack((g, ve))))
+        ve = vorob_t(points, sets=sets, ref=ref).ve
+    points, ref, order, cumsizes_p, nsets = _vorob_args(points, sets, ref)
+    nobj = points.shape[1]
+    points_p, _, nobj_p = np2d_to_double_array(points.take(order, axis=0))
+    ve = np.asarray(ve, dtype=float)
+    if ve.ndim != 2 or ve.shape[1] != nobj:
+        raise ValueError(f"'ve' must have {nobj} columns")
+    ve_p, ve_npoints, _ = np2d_to_double_array(
+        ve, ctype_shape=("size_t", "int")
+    )
+    return lib.vorob_deviation(
+        points_p,
+        nobj_p,
+        cumsizes_p,
+        nsets,
+        ffi.from_buffer("double []", ref),
+        ve_p,
+        ve_npoints,
     )
-    return float(vd - h1 - h2)
 
 
 @DocSubstitute()
@@ -2262,6 +2769,7 @@ def eafdiff(
     intervals: int | None = None,
     maximise: bool | Sequence[bool] = False,
     rectangles: bool = False,
+    threads: int | None = None,
 ) -> np.ndarray:
     """Compute empirical attainment function (EAF) differences.
 
@@ -2277,7 +2785,9 @@ def eafdiff(
     x, y : ArrayLike
        Numpy matrices corresponding to the input data of left and right sides,
        respectively. Each data frame has at least three columns, the third one
-       being the set of each point. See also :func:`read_datasets`.
+       being the set of each point. See also :func:`read_datasets`.  They may
+       have a different number of sets, since the difference is computed from
+       the fraction of sets of each side that attain each point.
 
     intervals :
        The absolute range of the differences :math:`[0, 1]` is partitioned into the number of intervals provided.
@@ -2288,6 +2798,9 @@ def eafdiff(
     rectangles :
        If ``True``, the output is in the form of rectangles of the same color.
 
+    threads :
+        ${threads}
+
 
     Returns
     -------
@@ -2342,14 +2855,14 @@ def eafdiff(
            [ 3. ,  3. ,  0. ],
            [ 4. ,  2.5,  1. ]])
     >>> moocore.eafdiff(A1, A2, rectangles=True)
-    array([[ 2. ,  1. ,  2.5,  2. , -1. ],
-           [ 1. ,  2. ,  2. ,  inf,  2. ],
-           [ 2.5,  1. ,  inf,  2. ,  0. ],
+    array([[ 1. ,  2. ,  2. ,  inf,  2. ],
+           [ 2. ,  1. ,  2.5,  2. , -1. ],
+           [ 2. ,  3. ,  2.5,  inf,  2. ],
            [ 2. ,  2. ,  3. ,  3. ,  1. ],
-           [ 2. ,  3.5,  2.5,  inf,  2. ],
-           [ 2. ,  3. ,  3. ,  3.5,  2. ],
-           [ 3. ,  2.5,  4. ,  3. ,  2. ],
-           [ 3. ,  2. ,  inf,  2.5,  2. ],
+           [ 2.5,  3. ,  3. ,  3.5,  2. ],
+           [ 3. ,  2. ,  4. ,  3. ,  2. ],
+           [ 2.5,  1. ,  inf,  2. ,  0. ],
+           [ 4. ,  2. ,  inf,  2.5,  2. ],
            [ 4. ,  2.5,  inf,  3. ,  1. ]])
 
     """
@@ -2366,14 +2879,13 @@ def eafdiff(
     y = y[y[:, -1].argsort(), :]
     _, cumsizes_x = np.unique(x[:, -1], return_counts=True)
     _, cumsizes_y = np.unique(y[:, -1], return_counts=True)
-    cumsizes_x = np.cumsum(cumsizes_x)
-    cumsizes_y = np.cumsum(cumsizes_y)
-    cumsizes = np.concatenate((cumsizes_x, cumsizes_x[-1] + cumsizes_y))
-    nsets = len(cumsizes)
+    nsets = len(cumsizes_x) + len(cumsizes_y)
 
-    data = np.vstack((x[:, :-1], y[:, :-1]))
+    x = x[:, :-1]
+    y = y[:, :-1]
     if maximise.any():
-        data[:, maximise] = -data[:, maximise]
+        x[:, maximise] = -x[:, maximise]
+        y[:, maximise] = -y[:, maximise]
 
     if intervals is None:
         intervals = int(nsets / 2.0)
@@ -2381,29 +2893,40 @@ def eafdiff(
         assert is_integer_value(intervals)
         intervals = min(intervals, int(nsets / 2.0))
 
-    data_p, _, nobj_int = np2d_to_double_array(data)
-    cumsizes_p, nsets = np1d_to_int_array(cumsizes)
-    eaf_npoints = ffi.new("int *")
-    intervals = ffi.cast("int", intervals)
-
-    if rectangles:
-        eaf_data = lib.eafdiff_compute_rectangles(
-            eaf_npoints, data_p, nobj_int, cumsizes_p, nsets, intervals
-        )
-        ncols = 2 * nobj + 1  # 2x2D points + color
-    else:
-        eaf_data = lib.eafdiff_compute_matrix(
-            eaf_npoints, data_p, nobj_int, cumsizes_p, nsets, intervals
+    x_p, _, _ = np2d_to_double_array(x)
+    y_p, _, _ = np2d_to_double_array(y)
+    cumsizes_x_p, nsets_x = np1d_to_c_array(
+        np.cumsum(cumsizes_x).astype(np.uintp),
+        ctype_data="size_t",
+        ctype_size="int",
+    )
+    cumsizes_y_p, nsets_y = np1d_to_c_array(
+        np.cumsum(cumsizes_y).astype(np.uintp),
+        ctype_data="size_t",
+        ctype_size="int",
+    )
+    eaf_npoints = ffi.new("size_t *")
+    with _num_threads(threads):
+        eaf_data = lib.eafdiff2d(
+            eaf_npoints,
+            x_p,
+            cumsizes_x_p,
+            nsets_x,
+            y_p,
+            cumsizes_y_p,
+            nsets_y,
+            ffi.cast("int", intervals),
+            ffi.cast("bool", rectangles),
+            ffi.NULL,
         )
-        ncols = nobj + 1  # 2D points + color
-
-    eaf_npoints = eaf_npoints[0]
-    eaf_data = ffi.buffer(eaf_data, ffi.sizeof("double") * eaf_npoints * ncols)
-    eaf_data = np.frombuffer(eaf_data).reshape((eaf_npoints, -1))
-    # FIXME: We should remove duplicated rows in C code.
-    eaf_data = unique_nosort(eaf_data, axis=0)
-    # FIXME: Check that we do not generate duplicated nor overlapping
-    # rectangles with different colors. That would be a bug.
+    # 2x2D points + color, or 2D points + color
+    ncols = 2 * nobj + 1 if rectangles else nobj + 1
+    size = eaf_npoints[0] * ncols
+    # Ensure that Python can free the data allocated by the C library.
+    eaf_data = ffi.gc(eaf_data, lib.free, size=size)
+    eaf_data = np.frombuffer(
+        ffi.buffer(eaf_data, ffi.sizeof("double") * size)
+    ).reshape((-1, ncols))
 
     if maximise.any():
         if rectangles:
@@ -2463,13 +2986,14 @@ def whv_rect(
     *,
     ref: ArrayLike,
     maximise: bool | Sequence[bool] = False,
-) -> float:
+    sets: ArrayLike | None = None,
+) -> float | np.ndarray:
     """Compute weighted hypervolume given a set of rectangles.
 
     .. seealso:: For examples, see :func:`total_whv_rect`.
 
     .. warning::
-        The current implementation only supports 2 objectives.
+        The current implementation only supports 2 and 3 objectives.
 
 
     Parameters
@@ -2477,29 +3001,40 @@ def whv_rect(
     points :
         ${points}
     rectangles :
-        ${whv_rectangles}
+        ${whv_rectangles} With 3 objectives, each row gives the lower corner,
+        the upper corner and the weight of a box (7 columns).
     ref :
         ${ref_point}
     maximise :
         ${maximise}
+    sets :
+        ${sets_of_points} If given, the weighted hypervolume is computed for
+        each set with a single call to the C library, which preprocesses the
+        rectangles only once.
 
 
     Returns
     -------
-        A single numerical value, the weighted hypervolume.
+        A single numerical value, the weighted hypervolume, or, if ``sets`` is
+        given, one value per set in the order of ``numpy.unique(sets)``.
 
     See Also
     --------
     total_whv_rect, whv_hype
 
     """
-    points, _ = asarray_maybe_copy(points)
+    # The C code may reorder the points, so always make a copy.
+    points = np.array(points, dtype=float)
     nobj = points.shape[1]
-    if nobj != 2:
-        raise NotImplementedError("Only 2D points are currently supported")
-    if rectangles.shape[1] != 5:
+    if nobj not in (2, 3):
+        raise NotImplementedError(
+            "Only 2D and 3D points are currently supported"
+        )
+    # The C code modifies the rectangles, so always make a copy.
+    rectangles = np.array(rectangles, dtype=float)
+    if rectangles.ndim != 2 or rectangles.shape[1] != 2 * nobj + 1:
         raise ValueError(
-            "Invalid number of columns in 'rectangles' (should be 5)"
+            f"Invalid number of columns in 'rectangles' (should be {2 * nobj + 1})"
         )
 
     maximise = _parse_maximise(maximise, nobj)
@@ -2517,12 +3052,35 @@ def whv_rect(
     #         rectangles[:, pos] = -rectangles[:, pos]
     ref = array_1d_of_length_n(np.asarray(ref, dtype=float), nobj, name="ref")
     ref = ffi.from_buffer("double []", ref)
-    points, npoints, _ = np2d_to_double_array(points)
     rectangles, rectangles_nrow, _ = np2d_to_double_array(rectangles)
-    hv = lib.rect_weighted_hv2d(
-        points, npoints, rectangles, rectangles_nrow, ref
+    if sets is None:
+        points, npoints, _ = np2d_to_double_array(points)
+        rect_weighted_hv = (
+            lib.rect_weighted_hv2d if nobj == 2 else lib.rect_weighted_hv3d
+        )
+        return rect_weighted_hv(
+            points, npoints, rectangles, rectangles_nrow, ref
+        )
+
+    nrows = points.shape[0]
+    order, cumsizes_p, nsets = _group_by_sets(sets, nrows)
+    if nrows == 0:
+        return np.array([], dtype=float)
+    points_p, _, nobj = np2d_to_double_array(
+        points.take(order, axis=0), ctype_shape=("size_t", "uint_fast8_t")
     )
-    return hv
+    whv = np.empty(int(nsets), dtype=float)
+    lib.rect_weighted_hv_sets(
+        ffi.from_buffer("double []", whv),
+        points_p,
+        nobj,
+        cumsizes_p,
+        nsets,
+        rectangles,
+        rectangles_nrow,
+        ref,
+    )
+    return whv
 
 
 def get_ideal(x, maximise):
@@ -2552,7 +3110,7 @@ def total_whv_rect(
     details of the computation are given by :footcite:t:`DiaLop2020ejor`.
 
     .. warning::
-        The current implementation only supports 2 objectives.
+        The current implementation only supports 2 and 3 objectives.
 
     Parameters
     ----------
@@ -2606,11 +3164,9 @@ def total_whv_rect(
     """
     points = np.asarray(points, dtype=float)
     nobj = points.shape[1]
-    if nobj != 2:
-        raise NotImplementedError("Only 2D datasets are currently supported")
-    if rectangles.shape[1] != 5:
-        raise ValueError(
-            "Invalid number of columns in 'rectangles' (should be 5)"
+    if nobj not in (2, 3):
+        raise NotImplementedError(
+            "Only 2D and 3D datasets are currently supported"
         )
     if scalefactor <= 0 or scalefactor > 1:
         raise ValueError("'scalefactor' must be within (0,1]")
@@ -2639,12 +3195,20 @@ def largest_eafdiff(
     maximise: bool | Sequence[bool] = False,
     intervals: int = 5,
     ideal: ArrayLike = None,
-) -> tuple[tuple[int, int], float]:
+) -> tuple[tuple[int, int] | None, float]:
     """Identify largest EAF differences.
 
     Given a list of datasets, return the indexes of the pair with the largest
     EAF differences according to the method proposed by :footcite:t:`DiaLop2020ejor`.
 
+    The value of a pair is the minimum, over both datasets, of the area within
+    ``[ideal, ref]`` where the EAF difference in favour of that dataset is at
+    least 1 (:func:`whv_rect` of ``ideal`` using those rectangles of
+    :func:`eafdiff` with weight 1).  The pairs are evaluated in decreasing
+    order of an upper bound of their value, and pairs whose bound cannot
+    exceed the best value found are skipped.  If several pairs have the
+    largest value, the first one is returned.
+
     .. warning::
         The current implementation only supports 2 objectives.
 
@@ -2669,7 +3233,8 @@ def largest_eafdiff(
     Returns
     -------
     pair : tuple[int,int]
-        Pair of indexes into the list that give the largest EAF difference.
+        Pair of indexes into the list that give the largest EAF difference, or
+        ``None`` if no pair has a positive value.
 
     value : float
         Value of the largest difference.
@@ -2730,36 +3295,44 @@ def largest_eafdiff(
             maximise=maximise,
         )
 
-    ideal = ideal.reshape(1, -1)
-
-    best_value = 0
-    for a in range(n - 1):
-        for b in range(a + 1, n):
-            diff = eafdiff(
-                x[a],
-                x[b],
-                intervals=intervals,
-                maximise=maximise,
-                rectangles=True,
-            )
-            # Set color to 1
-            a_rectangles = diff[diff[:, -1] >= 1, :]
-            a_rectangles[:, -1] = 1
-            a_value = whv_rect(
-                ideal, rectangles=a_rectangles, ref=ref, maximise=maximise
-            )
-
-            b_rectangles = diff[diff[:, -1] <= -1, :]
-            b_rectangles[:, -1] = 1
-            b_value = whv_rect(
-                ideal, rectangles=b_rectangles, ref=ref, maximise=maximise
-            )
+    # ideal and ref may be negated below, so always make a copy.
+    ideal = array_1d_of_length_n(
+        np.array(ideal, dtype=float), nobj, name="ideal"
+    )
+    ref = array_1d_of_length_n(np.array(ref, dtype=float), nobj, name="ref")
+    assert is_integer_value(intervals)
 
-            value = min(a_value, b_value)
-            if value > best_value:
-                best_value = value
-                best_pair = (a, b)
+    # The C code expects points within a set to be contiguous.
+    x = [z[z[:, -1].argsort(kind="stable"), :] for z in x]
+    sizes = [np.unique(z[:, -1], return_counts=True)[1] for z in x]
+    data = np.concatenate([z[:, :-1] for z in x])
+    if maximise.any():
+        data[:, maximise] = -data[:, maximise]
+        ideal[maximise] = -ideal[maximise]
+        ref[maximise] = -ref[maximise]
 
+    data_p, _, _ = np2d_to_double_array(data)
+    cumsizes_p, _ = np1d_to_c_array(
+        np.cumsum(np.concatenate(sizes)).astype(np.uintp),
+        ctype_data="size_t",
+        ctype_size="int",
+    )
+    cumruns_p, ndata = np1d_to_c_array(
+        np.cumsum([len(s) for s in sizes]), ctype_data="int", ctype_size="int"
+    )
+    best = ffi.new("int [2]")
+    best_value = lib.largest_eafdiff(
+        best,
+        best + 1,
+        data_p,
+        cumsizes_p,
+        cumruns_p,
+        ndata,
+        int(intervals),
+        ffi.from_buffer("double []", ideal),
+        ffi.from_buffer("double []", ref),
+    )
+    best_pair = (best[0], best[1]) if best[0] >= 0 else None
     return best_pair, best_value
 
 
@@ -2776,15 +3349,12 @@ def whv_hype(
     dist: Literal["uniform", "point", "exponential"] = "uniform",
     mu: float | ArrayLike | None = None,
 ) -> float:
-    r"""Approximation of the (weighted) hypervolume by Monte-Carlo sampling (2D only).
+    r"""Approximation of the (weighted) hypervolume by Monte-Carlo sampling.
 
     Return an estimation of the hypervolume of the space dominated by the input
     points following the procedure described by :footcite:t:`AugBadBroZit2009gecco`.
     A weight distribution describing user preferences may be specified.
 
-    .. warning::
-        The current implementation only supports 2 objectives.
-
     Parameters
     ----------
     points :
@@ -2813,6 +3383,9 @@ def whv_hype(
 
        ``'exponential'``
          describes an exponential distribution with rate parameter ``1/mu``, i.e., :math:`\lambda = \frac{1}{\mu}`.
+         With :math:`m` objectives, the samples are split in :math:`m` groups
+         of equal size and group :math:`i` follows the exponential distribution
+         along objective :math:`i` and a uniform distribution along the others.
     mu :
         Parameter of ``dist``. See above for details.
 
@@ -2868,9 +3441,6 @@ def whv_hype(
     # something like [10, 10] then numpy would interpret it as an int array.
     points, points_copied = asarray_maybe_copy(points)
     nobj = points.shape[1]
-    if nobj != 2:
-        raise NotImplementedError("Only 2D points are currently supported")
-
     ref = array_1d_of_length_n(np.asarray(ref, dtype=float), nobj, name="ref")
     ideal = array_1d_of_length_n(
         np.asarray(ideal, dtype=float), nobj, name="ideal"
@@ -2895,17 +3465,19 @@ def whv_hype(
     nsamples = ffi.cast("int", nsamples)
 
     if dist == "uniform":
-        hv = lib.whv_hype_unif(points_p, npoints, ideal, ref, nsamples, seed)
+        hv = lib.whv_hype_unif(
+            points_p, npoints, nobj, ideal, ref, nsamples, seed
+        )
     elif dist == "exponential":
         mu = ffi.cast("double", mu)
         hv = lib.whv_hype_expo(
-            points_p, npoints, ideal, ref, nsamples, seed, mu
+            points_p, npoints, nobj, ideal, ref, nsamples, seed, mu
         )
     elif dist == "point":
         mu = array_1d_of_length_n(np.asarray(mu, dtype=float), nobj, name="mu")
         mu, _ = np1d_to_double_array(mu)
         hv = lib.whv_hype_gaus(
-            points_p, npoints, ideal, ref, nsamples, seed, mu
+            points_p, npoints, nobj, ideal, ref, nsamples, seed, mu
         )
     else:
         raise ValueError("Unknown value of dist = {dist}")
@@ -3022,7 +3594,8 @@ def r2_exact(
     ref: ArrayLike,
     *,
     maximise: bool | Sequence[bool] = False,
-) -> float:
+    sets: ArrayLike | None = None,
+) -> float | np.ndarray:
     r"""Exact R2 indicator.
 
     Computes the exact R2 indicator with respect to a given ideal/utopian reference point
@@ -3030,9 +3603,6 @@ def r2_exact(
 
     .. seealso:: For details of the R2 indicator, see :ref:`r2_indicator`.
 
-    .. warning::
-        The current implementation only supports 2 objectives.
-
     Parameters
     ----------
     points :
@@ -3041,15 +3611,31 @@ def r2_exact(
         ${ref_point}
     maximise :
         ${maximise}
+    sets :
+        ${sets_of_points} If given, the R2 indicator is computed for each set
+        with a single call to the C library.
 
     Returns
     -------
-        A single numerical value, the exact R2 indicator.
+        A single numerical value, the exact R2 indicator, or, if ``sets`` is
+        given, one value per set in the order of ``numpy.unique(sets)``.
 
     Notes
     -----
-    The current implementation exclusively supports bi-objective solution sets and runs in :math:`O(n \log n)`.
+    For bi-objective solution sets, the computation runs in :math:`O(n \log n)`.
     For more details on the computation of the exact R2 indicator refer to :footcite:t:`SchKer2025r2v2`.
+    For more objectives, the R2 indicator is computed by integrating over the
+    region not dominated by the points (after transforming each point
+    :math:`a` into :math:`1/(a - r)`), slicing one objective at a time, which
+    runs in :math:`O(n^{m-1})` for :math:`m` objectives.
+
+    In any number of objectives, coordinates smaller than the reference point
+    are treated as equal to it, as in :func:`r2_approx`.
+
+    Bi-objective points already sorted in ascending order of the first
+    objective (and of the second one for ties) are not sorted again.  With
+    ``sets``, all bi-objective sets are sorted together by a single radix
+    sort when they are large enough.
 
     References
     ----------
@@ -3087,6 +3673,11 @@ def r2_exact(
     >>> moocore.r2_exact(dat, ref=0)
     0.3336076878950565
 
+    More than two objectives are also supported:
+
+    >>> moocore.r2_exact([[1, 1, 1]], ref=0)  # 11/18
+    0.611111111111111
+
     """
     # Convert to numpy.array in case the user provides a list.  We use
     # np.asarray to convert it to floating-point, otherwise if a user inputs
@@ -3094,8 +3685,8 @@ def r2_exact(
     # an int array.
     points, points_copied = asarray_maybe_copy(points)
     nobj = points.shape[1]
-    if nobj != 2:
-        raise NotImplementedError("Only 2D points are currently supported")
+    if nobj < 2:
+        raise ValueError("input points must have at least 2 columns")
     # Make sure it is a 1D array of length nobj.
     ref = array_1d_of_length_n(np.asarray(ref, dtype=float), nobj, name="ref")
 
@@ -3108,12 +3699,179 @@ def r2_exact(
         ref = ref.copy()
         ref[maximise] = -ref[maximise]
 
-    points_p, npoints, nobj = np2d_to_double_array(
-        points, ctype_shape=("size_t", "uint_fast8_t")
+    ref = ffi.from_buffer("double []", ref)
+    if sets is None:
+        points_p, npoints, nobj = np2d_to_double_array(
+            points, ctype_shape=("size_t", "uint_fast8_t")
+        )
+        r2 = lib.r2_exact(points_p, npoints, nobj, ref)
+        # if r2 < 0:
+        #     raise MemoryError("memory allocation failed")
+        return r2
+
+    nrows = points.shape[0]
+    order, cumsizes_p, nsets = _group_by_sets(sets, nrows)
+    if nrows == 0:
+        return np.array([], dtype=float)
+    points_p, _, nobj = np2d_to_double_array(
+        points.take(order, axis=0), ctype_shape=("size_t", "uint_fast8_t")
     )
+    r2 = np.empty(int(nsets), dtype=float)
+    lib.r2_exact_sets(
+        ffi.from_buffer("double []", r2), points_p, nobj, cumsizes_p, nsets, ref
+    )
+    return r2
+
+
+@DocSubstitute()
+def r2_approx(
+    points: ArrayLike,
+    /,
+    ref: ArrayLike,
+    *,
+    maximise: bool | Sequence[bool] = False,
+    sets: ArrayLike | None = None,
+    weights: ArrayLike | None = None,
+    nsamples: int = 16_384,
+    method: Literal["Rphi", "Hua-Wang"] = "Rphi",
+) -> float | np.ndarray:
+    r"""Approximate the R2 indicator using a finite set of weight vectors.
+
+    Computes the R2 indicator with respect to a given ideal/utopian reference
+    point as the average, over a set of weight vectors, of the minimum
+    Tchebycheff utility of the points.  With many weight vectors uniformly
+    distributed on the unit simplex, the value converges to :func:`r2_exact`,
+    but this function is much faster for many objectives.  As in
+    :func:`r2_exact`, coordinates smaller than the reference point are treated
+    as equal to it.
+
+    .. seealso:: For details of the R2 indicator, see :ref:`r2_indicator`.
+
+    Parameters
+    ----------
+    points :
+        ${points}
+    ref :
+        ${ref_point}
+    maximise :
+        ${maximise}
+    sets :
+        ${sets_of_points} If given, the R2 indicator is computed for each set
+        with a single call to the C library.
+    weights :
+        Matrix of weight vectors (one per row) with as many columns as
+        ``points``.  If ``None``, ``nsamples`` weight vectors are generated
+        according to ``method``.
+    nsamples :
+        Number of weight vectors generated if ``weights`` is ``None``.
+    method :
+        Low-discrepancy sequence used to generate the weight vectors.
+        ``"Rphi"`` uses the :math:`R_\phi` sequence
+        :footcite:p:`Rob2018unreasonable` and ``"Hua-Wang"`` uses the good
+        lattice points also used by :func:`hv_approx`.  In both cases, the
+        points are mapped to the unit simplex such that they are uniformly
+        distributed.
+
+    Returns
+    -------
+        A single numerical value, the R2 indicator, or, if ``sets`` is given,
+        one value per set in the order of ``numpy.unique(sets)``.
+
+    See Also
+    --------
+    r2_exact
+
+    References
+    ----------
+    .. footbibliography::
+
+    Examples
+    --------
+    >>> dat = np.array([[5, 5], [4, 6], [2, 7], [7, 4]])
+    >>> moocore.r2_exact(dat, ref=[0, 0])
+    2.594191919191919
+    >>> moocore.r2_approx(dat, ref=[0, 0])  # doctest: +ELLIPSIS
+    2.5941...
+
+    The R2 indicator of each set of a dataset:
+
+    >>> x = moocore.get_dataset("input1.dat")
+    >>> moocore.r2_approx(x[:, :-1], ref=0, sets=x[:, -1])
+    array([0.41703783, 1.8471246 , 1.80400927, 0.69452315, 1.83829392,
+           1.66011757, 1.60461493, 2.51160929, 1.31278684, 0.81831441])
+
+    """
+    points, points_copied = asarray_maybe_copy(points)
+    if len(points.shape) != 2:
+        raise ValueError("'points' must be a matrix")
+    nrows, nobj = points.shape
+    if nobj < 2:
+        raise ValueError("input points must have at least 2 columns")
+    _check_dimension_max(nobj, HVAPPROX_DIMENSION_MAX)
+    ref = array_1d_of_length_n(np.asarray(ref, dtype=float), nobj, name="ref")
+
+    maximise = _parse_maximise(maximise, nobj)
+    if maximise.any():
+        if not points_copied:
+            points = points.copy()
+        points[:, maximise] = -points[:, maximise]
+        ref = ref.copy()
+        ref[maximise] = -ref[maximise]
+
+    if weights is None:
+        if (
+            not is_integer_value(nsamples)
+            or nsamples <= 0
+            or nsamples > 2147483648
+        ):
+            raise ValueError(
+                f"nsamples ({nsamples}) must be a positive integer value smaller than 2147483648"
+            )
+        weights = np.empty((nsamples, nobj), dtype=float)
+        weights_p = ffi.from_buffer("double []", weights)
+        match method:
+            case "Rphi":
+                lib.r2_weights_rphi(
+                    weights_p, nobj, ffi.cast("uint_fast32_t", nsamples)
+                )
+            case "Hua-Wang":
+                lib.r2_weights_hua_wang(
+                    weights_p, nobj, ffi.cast("uint_fast32_t", nsamples)
+                )
+            case _:
+                raise ValueError(f"Unknown method = {method}")
+    else:
+        weights = np.asarray(weights, dtype=float)
+        if weights.ndim != 2 or weights.shape[1] != nobj:
+            raise ValueError(f"'weights' must be a matrix with {nobj} columns")
+        if weights.shape[0] == 0 or (weights < 0).any():
+            raise ValueError("'weights' must be nonnegative and nonempty")
+        weights = np.ascontiguousarray(weights)
+        weights_p = ffi.from_buffer("double []", weights)
+    nweights = ffi.cast("size_t", weights.shape[0])
     ref = ffi.from_buffer("double []", ref)
-    r2 = lib.r2_exact(points_p, npoints, nobj, ref)
-    # if r2 < 0:
-    #     raise MemoryError("memory allocation failed")
 
+    if sets is None:
+        points_p, npoints, nobj = np2d_to_double_array(
+            points, ctype_shape=("size_t", "uint_fast8_t")
+        )
+        return lib.r2_approx(points_p, npoints, nobj, ref, weights_p, nweights)
+
+    order, cumsizes_p, nsets = _group_by_sets(sets, nrows)
+    if nrows == 0:
+        return np.array([], dtype=float)
+    points_p, _, nobj = np2d_to_double_array(
+        points.take(order, axis=0), ctype_shape=("size_t", "uint_fast8_t")
+    )
+    r2 = np.empty(int(nsets), dtype=float)
+    lib.r2_approx_sets(
+        ffi.from_buffer("double []", r2),
+        points_p,
+        nobj,
+        cumsizes_p,
+        nsets,
+        ref,
+        weights_p,
+        nweights,
+    )
     return r2
@@ -11,53 +11,105 @@ typedef uint8_t boolvec;
 // From stdlib.h
 void free(void *);
 
+// common.h
+void moocore_set_num_threads(int nthreads);
+int moocore_get_num_threads(void);
 // io.h
 int read_datasets(const char * filename, double ** restrict data_p, int * restrict ncols_p, int * restrict datasize_p);
 // hv.h
 double fpli_hv(const double * restrict data, size_t n, dimension_t d, const double * restrict ref);
 void hv_contributions(double * restrict hvc, double * restrict points, size_t n, dimension_t d, const double * restrict ref, bool ignore_dominated);
+// kdtree.h
+typedef enum { DIST_NORM_L1 = 1, DIST_NORM_L2 = 2, DIST_NORM_LINF = 3 } dist_norm_t;
 // igd.h
+double IGD_norm(const double * restrict data, size_t n, dimension_t d, const double * restrict ref, size_t ref_size, const boolvec * restrict maximise, dist_norm_t norm);
+double IGD_plus_norm(const double * restrict data, size_t n, dimension_t d, const double * restrict ref, size_t ref_size, const boolvec * restrict maximise, dist_norm_t norm);
+double avg_Hausdorff_dist_norm(const double * restrict data, size_t n, dimension_t d, const double * restrict ref, size_t ref_size, const boolvec * restrict maximise, unsigned int p, dist_norm_t norm);
 double IGD(const double * restrict data, size_t n, dimension_t d, const double * restrict ref, size_t ref_size, const boolvec * restrict maximise);
 double IGD_plus(const double * restrict data, size_t n, dimension_t d, const double * restrict ref, size_t ref_size, const boolvec * restrict maximise);
 double avg_Hausdorff_dist(const double * restrict data, size_t n, dimension_t d, const double * restrict ref, size_t ref_size, const boolvec * restrict maximise, unsigned int p);
+typedef ... gd_refset_t;
+gd_refset_t * gd_refset_new(const double * restrict ref, size_t ref_size, dimension_t nobj, const boolvec * restrict maximise, dist_norm_t norm);
+void gd_refset_free(gd_refset_t * rs);
+double IGD_refset(const gd_refset_t * restrict rs, const double * restrict data, size_t size);
+double IGD_plus_refset(const gd_refset_t * restrict rs, const double * restrict data, size_t size);
+double avg_Hausdorff_dist_refset(const gd_refset_t * restrict rs, const double * restrict data, size_t size, unsigned int p);
 // epsilon.h
 double epsilon_additive(const double * restrict data, size_t n, dimension_t d, const double * restrict ref, size_t ref_size, const boolvec * restrict maximise);
 double epsilon_mult(const double * restrict data, size_t n, dimension_t d, const double * restrict ref, size_t ref_size, const boolvec * restrict maximise);
+typedef ... epsilon_refset_t;
+epsilon_refset_t * epsilon_refset_new(const double * restrict ref, size_t ref_size, dimension_t d, const boolvec * restrict maximise);
+void epsilon_refset_free(epsilon_refset_t * rs);
+double epsilon_additive_refset(const epsilon_refset_t * restrict rs, const double * restrict data, size_t n);
+double epsilon_mult_refset(const epsilon_refset_t * restrict rs, const double * restrict data, size_t n);
 // r2_exact.h
 double r2_exact(const double * restrict data, size_t n, dimension_t d, const double * restrict ref);
+void r2_exact_sets(double * restrict r2, const double * restrict data,
+                   dimension_t d, const size_t * restrict cumsizes,
+                   size_t nsets, const double * restrict ref);
+// r2_approx.h
+void r2_weights_rphi(double * restrict weights, dimension_t nobjs, uint_fast32_t nweights);
+void r2_weights_hua_wang(double * restrict weights, dimension_t nobjs, uint_fast32_t nweights);
+double r2_approx(const double * restrict data, size_t npoints, dimension_t nobjs,
+                 const double * restrict ref, const double * restrict weights, size_t nweights);
+void r2_approx_sets(double * restrict r2, const double * restrict data, dimension_t nobjs,
+                    const size_t * restrict cumsizes, size_t nsets,
+                    const double * restrict ref, const double * restrict weights, size_t nweights);
 
 // nondominated.h
+void moocore_set_kung_min_size(size_t find_set, size_t find_dominated);
 size_t find_weakly_dominated_point(const double * restrict points, size_t n, dimension_t d,
                                    const boolvec * restrict maximise);
 void is_nondominated(boolvec * restrict nondom,
                      const double * restrict data, size_t n, dimension_t d,
                      bool keep_weakly, const boolvec * restrict maximise);
+void is_nondominated_within_sets(boolvec * restrict nondom,
+                                 const double * restrict data, dimension_t nobj,
+                                 const size_t * restrict cumsizes, size_t nsets,
+                                 bool keep_weakly, const boolvec * restrict maximise);
 void pareto_rank(int * rank, const double * restrict points, size_t size, dimension_t dim);
 void agree_normalise(double * restrict data, size_t size, dimension_t dim,
                      const boolvec * restrict maximise,
                      const double lower_range, const double upper_range,
                      const double * restrict lbound, const double * restrict ubound);
 
-double * eaf_compute_matrix (int *eaf_npoints, double * data, int nobj, const int *cumsizes,
+double * eaf_compute_matrix (size_t *eaf_npoints, double * data, int nobj, const size_t *cumsizes,
                              int nruns, const double * percentile, int nlevels);
-double * eafdiff_compute_rectangles(int *eaf_npoints, double * data, int nobj,
-                                    const int *cumsizes, int nruns, int intervals);
+double * eafdiff_compute_rectangles(size_t *eaf_npoints, double * data, int nobj,
+                                    const size_t *cumsizes, int nruns, int intervals);
 double *
-eafdiff_compute_matrix(int *eaf_npoints, double * data, int nobj,
-                       const int *cumsizes, int nruns, int intervals);
+eafdiff_compute_matrix(size_t *eaf_npoints, double * data, int nobj,
+                       const size_t *cumsizes, int nruns, int intervals);
+double * eafdiff2d(size_t * nrows,
+                   const double * data_left, const size_t * cumsizes_left, int nruns_left,
+                   const double * data_right, const size_t * cumsizes_right, int nruns_right,
+                   int intervals, bool rectangles, FILE * stream);
+double largest_eafdiff(int * best_a, int * best_b, const double * data,
+                       const size_t * cumsizes, const int * cumruns, int ndata,
+                       int intervals, const double * ideal, const double * ref);
+double * vorob_expectation(double * threshold, double * avg_hyp, size_t * ve_npoints,
+                           double * data, int nobj, const size_t * cumsizes, int nruns,
+                           const double * ref);
+double vorob_deviation(const double * data, int nobj, const size_t * cumsizes, int nruns,
+                       const double * ref, const double * ve, size_t ve_npoints);
 
 /* whv_hype.h */
-double whv_hype_unif(const double *points, int npoints,
+double whv_hype_unif(const double *points, int npoints, dimension_t nobj,
                      const double *ideal, const double *ref,
                      int nsamples, uint32_t seed);
-double whv_hype_expo(const double *points, int npoints,
+double whv_hype_expo(const double *points, int npoints, dimension_t nobj,
                      const double *ideal, const double *ref,
                      int nsamples, uint32_t seed, double mu);
-double whv_hype_gaus(const double *points, int npoints,
+double whv_hype_gaus(const double *points, int npoints, dimension_t nobj,
                      const double *ideal, const double *ref,
                      int nsamples, uint32_t seed, const double *mu);
 /* whv.h */
 double rect_weighted_hv2d(double *data, int n, double * rectangles, int rectangles_nrow, const double * reference);
+double rect_weighted_hv3d(const double *data, int n, double * rectangles, int rectangles_nrow, const double * reference);
+void rect_weighted_hv_sets(double *whv, double *data, dimension_t nobj,
+                           const size_t *cumsizes, size_t nsets,
+                           double *rectangles, int rectangles_nrow,
+                           const double *reference);
 
 // hvapprox.h
 double hv_approx_hua_wang(const double * restrict data,
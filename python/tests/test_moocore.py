@@ -5,6 +5,7 @@ from numpy.testing import (
     assert_array_equal,
     assert_allclose,
 )
+import itertools
 import math
 import moocore
 
@@ -278,6 +279,73 @@ def test_igd():
     assert moocore.igd(x, ref=x) == 0.0
 
 
+@pytest.mark.parametrize("nobj", [1, 2, 3, 5])
+def test_refset_classes(nobj):
+    rng = np.random.default_rng(42)
+    ref = rng.random((2000, nobj)) + 0.1
+    maximise = [k % 2 == 1 for k in range(nobj)]
+    igd_ind = moocore.IGD(ref, maximise=maximise)
+    igd_plus_ind = moocore.IGDPlus(ref, maximise=maximise)
+    hausdorff_ind = moocore.AvgHausdorffDist(ref, maximise=maximise, p=2)
+    eps_add_ind = moocore.EpsilonAdditive(ref, maximise=maximise)
+    eps_mult_ind = moocore.EpsilonMult(ref, maximise=maximise)
+    for n in (1, 10, 500):
+        x = rng.random((n, nobj)) + 0.1
+        assert eps_add_ind(x) == moocore.epsilon_additive(
+            x, ref, maximise=maximise
+        )
+        assert eps_mult_ind(x) == moocore.epsilon_mult(
+            x, ref, maximise=maximise
+        )
+        assert math.isclose(igd_ind(x), moocore.igd(x, ref, maximise=maximise))
+        assert math.isclose(
+            igd_plus_ind(x), moocore.igd_plus(x, ref, maximise=maximise)
+        )
+        assert math.isclose(
+            hausdorff_ind(x),
+            moocore.avg_hausdorff_dist(x, ref, maximise=maximise, p=2),
+        )
+        if nobj > 1:
+            assert math.isclose(
+                igd_plus_ind(x),
+                moocore._moocore._igd_plus_python(x, ref, maximise=maximise),
+            )
+    with pytest.raises(ValueError, match="same number of columns"):
+        igd_ind(np.ones((3, nobj + 1)))
+    with pytest.raises(ValueError, match="larger than 0"):
+        eps_mult_ind(-x)
+    with pytest.raises(ValueError, match="larger than 0"):
+        moocore.EpsilonMult(-ref)
+
+
+@pytest.mark.parametrize("norm", [1, 2, np.inf])
+@pytest.mark.parametrize("nobj", [2, 3, 13])
+def test_igd_norm(nobj, norm):
+    rng = np.random.default_rng(42)
+    ref = rng.random((300, nobj))
+    maximise = [k % 2 == 1 for k in range(nobj)]
+    igd_plus_ind = moocore.IGDPlus(ref, maximise=maximise, norm=norm)
+    for n in (1, 10, 200):
+        x = rng.random((n, nobj))
+        assert math.isclose(
+            moocore.igd(x, ref, maximise=maximise, norm=norm),
+            moocore._moocore._igd_python(x, ref, norm=norm),
+        )
+        expected = moocore._moocore._igd_plus_python(
+            x, ref, maximise=maximise, norm=norm
+        )
+        assert math.isclose(
+            moocore.igd_plus(x, ref, maximise=maximise, norm=norm), expected
+        )
+        assert math.isclose(igd_plus_ind(x), expected)
+        assert math.isclose(
+            moocore.avg_hausdorff_dist(x, ref, p=2, norm=norm),
+            moocore._moocore._avg_hausdorff_dist_python(x, ref, p=2, norm=norm),
+        )
+    with pytest.raises(ValueError, match="'norm' must be"):
+        moocore.igd(x, ref, norm=3)
+
+
 def test_unary_setref_single_column():
     rng = np.random.default_rng()
     a = rng.random((6, 1))
@@ -383,6 +451,29 @@ def test_is_nondominated(test_datapath):
     )
 
 
+@pytest.mark.parametrize("dim", [2, 3, 5])
+def test_is_nondominated_within_sets(dim):
+    rng = np.random.default_rng(42)
+    # Few distinct values to produce many duplicates.
+    x = rng.integers(0, 5, size=(600, dim)).astype(float)
+    sets = rng.permutation(np.repeat(np.arange(37), 600 // 37 + 1)[:600])
+    for keep_weakly in [False, True]:
+        for maximise in [False, True]:
+            expected = moocore.apply_within_sets(
+                x,
+                sets,
+                moocore.is_nondominated,
+                maximise=maximise,
+                keep_weakly=keep_weakly,
+            )
+            assert_array_equal(
+                moocore.is_nondominated_within_sets(
+                    x, sets, maximise=maximise, keep_weakly=keep_weakly
+                ),
+                expected,
+            )
+
+
 def test_epsilon():
     """Same as in R package."""
     ref = np.array([10, 1, 6, 1, 2, 2, 1, 6, 1, 10]).reshape((-1, 2))
@@ -425,6 +516,24 @@ def test_epsilon_dim(dim):
         )
 
 
+@pytest.mark.parametrize("dim", [2, 3, 5, 8])
+def test_epsilon_large(dim):
+    # Large enough to use the k-d tree, which must match brute force.
+    rng = np.random.default_rng(42)
+    ref = rng.random((300, dim)) + 0.1
+    x = np.vstack((rng.random((1000, dim)) + 0.2, ref[:5]))
+    minmax = [k % 2 == 1 for k in range(dim)]
+    for maximise in (False, True, minmax):
+        assert moocore.epsilon_additive(
+            x, ref, maximise=maximise
+        ) == moocore._moocore._epsilon_addi_python(x, ref, maximise=maximise)
+        # The Python version inverts maximised objectives, which rounds.
+        assert math.isclose(
+            moocore.epsilon_mult(x, ref, maximise=maximise),
+            moocore._moocore._epsilon_mult_python(x, ref, maximise=maximise),
+        )
+
+
 def test_normalise(immutable_call):
     A = np.array(
         [
@@ -503,6 +612,137 @@ def test_eaf(test_datapath, test_name, expected_eaf_name):
         expected_eaf_pct_result,
         err_msg=f"pct_{expected_eaf_name} test failed",
     )
+    # Computing each level in a different thread gives the same result.
+    assert_array_equal(
+        moocore.eaf(x, sets=sets, percentiles=[0, 50, 100], threads=2),
+        eaf_pct_test,
+    )
+
+
+def eaf_brute_force(x, sets, level):
+    """Minimal points attained by at least ``level`` sets.
+
+    The points are searched on the grid of the coordinates of the input points.
+    """
+    grid = np.array(list(itertools.product(*[np.unique(c) for c in x.T])))
+    attained = np.zeros(len(grid), dtype=int)
+    for s in np.unique(sets):
+        xs = x[sets == s]
+        attained += (xs[None, :, :] <= grid[:, None, :]).all(axis=2).any(axis=1)
+    grid = grid[attained >= level]
+    return grid[moocore.is_nondominated(grid)]
+
+
+@pytest.mark.parametrize("nobj", [4, 5])
+def test_eaf_nd(nobj):
+    rng = np.random.default_rng(nobj)
+    nsets = 4
+    sets = np.repeat(np.arange(nsets), 4)
+    # Few distinct values to produce ties.
+    x = rng.integers(0, 4, size=(len(sets), nobj)).astype(float)
+    res = moocore.eaf(x, sets=sets)
+    for level in range(1, nsets + 1):
+        pct = 100 * level / nsets
+        got = res[res[:, -1] == pct, :-1]
+        expected = eaf_brute_force(x, sets, level)
+        assert_array_equal(
+            got[np.lexsort(got.T[::-1])],
+            expected[np.lexsort(expected.T[::-1])],
+        )
+
+
+def test_eaf_threads():
+    x = moocore.get_dataset("input1.dat")
+    for threads in (0, -1, 1.5, "2"):
+        with pytest.raises(ValueError, match="threads"):
+            moocore.eaf(x[:, :-1], sets=x[:, -1], threads=threads)
+    A, B = x[x[:, -1] <= 5, :], x[x[:, -1] > 5, :]
+    assert_array_equal(
+        moocore.eafdiff(A, B, rectangles=True, threads=3),
+        moocore.eafdiff(A, B, rectangles=True),
+    )
+
+
+def test_eafdiff_different_nsets():
+    x = moocore.get_dataset("input1.dat")
+    A, B = x[x[:, -1] <= 3, :], x[x[:, -1] > 3, :]
+    nsets_A, nsets_B = len(np.unique(A[:, -1])), len(np.unique(B[:, -1]))
+    assert nsets_A != nsets_B
+    intervals = (nsets_A + nsets_B) // 2
+
+    def attained(z, p):
+        dom = np.all(z[:, :-1] <= p, axis=1)
+        return len(np.unique(z[dom, -1]))
+
+    diff = moocore.eafdiff(A, B)
+    for row in diff:
+        p = row[:-1]
+        expected = intervals * (
+            attained(A, p) / nsets_A - attained(B, p) / nsets_B
+        )
+        assert_allclose(row[-1], expected)
+    rect = moocore.eafdiff(A, B, rectangles=True)
+    assert len(np.unique(rect, axis=0)) == len(rect)
+    # The lower-left corner of each rectangle has its difference.
+    for row in rect:
+        p = row[:2]
+        expected = intervals * (
+            attained(A, p) / nsets_A - attained(B, p) / nsets_B
+        )
+        assert_allclose(row[-1], expected)
+
+
+def test_largest_eafdiff():
+    x = moocore.get_dataset("input1.dat")
+    # Four datasets with different numbers of sets.
+    x = [x[x[:, -1] == k, :] for k in range(1, 11)]
+    x = [np.vstack(x[0:2]), np.vstack(x[2:5]), x[5], np.vstack(x[6:10])]
+    ref = np.array([10.0, 10.0])
+    ideal = np.vstack(x)[:, :-1].min(axis=0)
+
+    def value(a, b, intervals):
+        diff = moocore.eafdiff(a, b, intervals=intervals, rectangles=True)
+        rects = [diff[diff[:, -1] >= 1, :], diff[diff[:, -1] <= -1, :]]
+        whv = []
+        for r in rects:
+            r[:, -1] = 1
+            whv.append(moocore.whv_rect(ideal.reshape(1, -1), r, ref=ref))
+        return min(whv)
+
+    for intervals in (1, 2, 5):
+        values = {
+            (a, b): value(x[a], x[b], intervals)
+            for a in range(len(x) - 1)
+            for b in range(a + 1, len(x))
+        }
+        pair, best = moocore.largest_eafdiff(x, ref=ref, intervals=intervals)
+        expected = max(values.values())
+        assert_allclose(best, expected)
+        assert pair == min(p for p, v in values.items() if v == expected)
+
+    # Maximising the negated objectives gives the same pair.
+    neg = [np.column_stack((-z[:, :-1], z[:, -1])) for z in x]
+    assert moocore.largest_eafdiff(
+        neg, ref=-ref, maximise=True
+    ) == moocore.largest_eafdiff(x, ref=ref)
+
+
+def test_vorob_unsorted_sets():
+    CPFs = moocore.get_dataset("CPFs.txt.xz")
+    x, sets = CPFs[:, :-1], CPFs[:, -1]
+    res = moocore.vorob_t(x, sets=sets, ref=(2, 200))
+    vd = moocore.vorob_dev(x, sets=sets, ref=(2, 200), ve=res.ve)
+    # The rows of each set do not need to be contiguous.
+    perm = np.random.default_rng(42).permutation(len(sets))
+    res_perm = moocore.vorob_t(x[perm], sets=sets[perm], ref=(2, 200))
+    assert res_perm.threshold == res.threshold
+    assert_allclose(res_perm.avg_hyp, res.avg_hyp)
+    assert_array_equal(res_perm.ve, res.ve)
+    assert_allclose(
+        moocore.vorob_dev(x[perm], sets=sets[perm], ref=(2, 200), ve=res.ve), vd
+    )
+    with pytest.raises(ValueError, match="ve"):
+        moocore.vorob_dev(x, sets=sets, ref=(2, 200), ve=res.ve[:, :1])
 
 
 def test_get_dataset_path():
@@ -606,6 +846,64 @@ def test_hvc(dim):
     check_hvc(points, ref, err_msg=f"dim={dim}, seed={seed}: ")
 
 
+def whv_rect_grid(points, rectangles, ref, size):
+    """Weighted hypervolume of integer points by counting unit cells."""
+    dim = points.shape[1]
+    whv = 0.0
+    for cell in itertools.product(range(size), repeat=dim):
+        cell = np.array(cell)
+        if (cell + 1 > ref).any() or not (points <= cell).all(axis=1).any():
+            continue
+        for r in rectangles:
+            upper = np.minimum(r[dim : 2 * dim], ref)
+            if (r[:dim] <= cell).all() and (cell + 1 <= upper).all():
+                whv += r[-1]
+    return whv
+
+
+@pytest.mark.parametrize("dim", [2, 3, 4, 5])
+def test_whv_hype(dim):
+    x = moocore.generate_ndset(50, dim, method="simplex", seed=42)
+    ref = np.full(dim, 1.1)
+    true_hv = moocore.hypervolume(x, ref=ref)
+    hv = moocore.whv_hype(x, ref=ref, ideal=0, nsamples=200_000, seed=42)
+    assert_allclose(hv, true_hv, rtol=0.01)
+    # Dominated points do not change the estimate.
+    assert moocore.whv_hype(
+        np.vstack((x, x + 0.1)), ref=ref, ideal=0, nsamples=10_000, seed=1
+    ) == moocore.whv_hype(x, ref=ref, ideal=0, nsamples=10_000, seed=1)
+
+
+@pytest.mark.parametrize("dim", [2, 3])
+def test_whv_rect(dim):
+    rng = np.random.default_rng(42)
+    size = 6
+    ref = np.full(dim, size)
+    for _ in range(20):
+        # Dominated and repeated points are allowed.
+        points = rng.integers(0, size, (rng.integers(1, 8), dim))
+        lower = rng.integers(0, size, (4, dim))
+        upper = lower + rng.integers(1, 4, (4, dim))
+        rectangles = np.hstack((lower, upper, rng.integers(1, 4, (4, 1))))
+        assert_allclose(
+            moocore.whv_rect(points, rectangles, ref=ref),
+            whv_rect_grid(points, rectangles, ref, size),
+        )
+
+    points = rng.random((100, dim))
+    sets = rng.integers(0, 5, 100)
+    lower = rng.random((10, dim)) / 2
+    rectangles = np.hstack((lower, lower + 0.5, np.ones((10, 1))))
+    whv = moocore.whv_rect(points, rectangles, ref=1, sets=sets)
+    assert_allclose(
+        whv,
+        [
+            moocore.whv_rect(points[sets == k], rectangles, ref=1)
+            for k in range(5)
+        ],
+    )
+
+
 @pytest.mark.parametrize("dim", range(5, 11))
 def test_generate_ndset(dim):
     n = 10
@@ -745,3 +1043,92 @@ class TestR2Exact:
         moocore.r2_exact(dat, ref=[10, 10])
 
         assert_allclose(r2, 0.33360768789505657)
+
+    @pytest.mark.parametrize("dim", [3, 4, 5])
+    def test_r2_nd(self, dim):
+        """Checks the exact R2 for more than two objectives."""
+        # For a single point, R2 is the expected maximum weight.
+        expected = sum(1 / k for k in range(1, dim + 1)) / dim
+        assert_allclose(moocore.r2_exact(np.ones((1, dim)), ref=0), expected)
+        assert moocore.r2_exact(np.zeros((2, dim)), ref=0) == 0.0
+
+        rng = np.random.default_rng(42)
+        x = rng.random((20, dim))
+        # Dominated points are ignored.
+        r2 = moocore.r2_exact(x, ref=0)
+        assert_allclose(
+            moocore.r2_exact(moocore.filter_dominated(x), ref=0), r2
+        )
+        assert_allclose(
+            moocore.r2_exact(-x, ref=0, maximise=True), r2, rtol=1e-12
+        )
+        # Monte-Carlo estimate with uniformly distributed weights.
+        w = rng.dirichlet(np.ones(dim), size=50000)
+        utility = np.min(np.max(w[:, None, :] * x[None, :, :], axis=2), axis=1)
+        assert_allclose(r2, utility.mean(), rtol=0.02)
+
+    @pytest.mark.parametrize("dim", [2, 3, 4])
+    def test_r2_below_ref(self, dim):
+        """Checks that coordinates smaller than ref are treated as equal to it."""
+        x = np.array(
+            [
+                [0.808, 0.515],
+                [0.286, 0.054],
+                [0.383, 0.408],
+                [0.045, 0.049],
+                [0.999, 0.652],
+                [0.235, 0.435],
+                [0.974, 0.898],
+            ]
+        )
+        ref = np.array([0.153, 0.0177])
+        if dim == 2:
+            assert_allclose(moocore.r2_exact(x, ref=ref), 0.01565)
+        rng = np.random.default_rng(3)
+        x = rng.random((20, dim))
+        ref = np.full(dim, 0.3)
+        clipped = np.maximum(x, ref)
+        r2 = moocore.r2_exact(x, ref=ref)
+        assert_allclose(r2, moocore.r2_exact(clipped, ref=ref), rtol=1e-12)
+        assert_allclose(moocore.r2_approx(x, ref=ref), r2, rtol=1e-3)
+        w = rng.dirichlet(np.ones(dim), size=100)
+        utility = np.max(w[:, None, :] * (clipped - ref)[None, :, :], axis=2)
+        assert_allclose(
+            moocore.r2_approx(x, ref=ref, weights=w), utility.min(axis=1).mean()
+        )
+
+    @pytest.mark.parametrize("size", [5, 300])
+    @pytest.mark.parametrize("dim", [2, 3])
+    def test_r2_exact_sets(self, dim, size):
+        """Checks that the R2 of each set matches the R2 of the set alone."""
+        rng = np.random.default_rng(7)
+        x = rng.integers(0, 20, size=(4 * size, dim)) / 10 - 0.2
+        sets = rng.integers(0, 4, size=4 * size)
+        r2 = moocore.r2_exact(x, ref=0, sets=sets)
+        expected = [moocore.r2_exact(x[sets == k], ref=0) for k in range(4)]
+        assert_array_equal(r2, expected)
+        # Presorted input gives the same value.
+        if dim == 2:
+            y = x[np.lexsort((x[:, 1], x[:, 0]))]
+            assert moocore.r2_exact(y, ref=0) == moocore.r2_exact(x, ref=0)
+
+    @pytest.mark.parametrize("dim", [2, 3, 5])
+    @pytest.mark.parametrize("method", ["Rphi", "Hua-Wang"])
+    def test_r2_approx(self, dim, method):
+        """Checks that the R2 approximation converges to the exact value."""
+        rng = np.random.default_rng(42)
+        x = rng.random((60, dim))
+        sets = np.repeat([3, 1, 2], 20)
+        r2 = moocore.r2_approx(x, ref=0, sets=sets, method=method)
+        exact = [moocore.r2_exact(x[sets == k], ref=0) for k in (1, 2, 3)]
+        assert_allclose(r2, exact, rtol=1e-3)
+        assert_allclose(
+            moocore.r2_approx(x[sets == 2], ref=0, method=method), r2[1]
+        )
+        # Explicit weights.
+        w = rng.dirichlet(np.ones(dim), size=100)
+        utility = np.min(np.max(w[:, None, :] * x[None, :, :], axis=2), axis=1)
+        assert_allclose(
+            moocore.r2_approx(-x, ref=0, weights=w, maximise=True),
+            utility.mean(),
+        )
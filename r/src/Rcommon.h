@@ -3,6 +3,7 @@
 #include <Rinternals.h>
 #include <R_ext/Error.h>
 #include <R_ext/Memory.h>
+#include <limits.h>
 #include <stdint.h>
 
 #include "common.h"
@@ -135,6 +136,15 @@
         Rf_error ("Argument '" #S "' is not a string");                       \
     const char * var = CHAR(STRING_ELT(S,0));
 
+/* Number of rows of a matrix created by Rf_allocMatrix(), which takes an int.  */
+static inline int
+size_t_2_nrows(size_t n)
+{
+    if (n > INT_MAX)
+        Rf_error("too many rows (%zu) for an R matrix", n);
+    return (int) n;
+}
+
 static inline void
 bool_2_logical_vector(int *dst, const bool *src, size_t n)
 {
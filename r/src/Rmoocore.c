@@ -7,9 +7,18 @@
 #undef DECLARE_CALL
 #undef DECLARE_CALL_VOID
 
+static size_t *
+cumsizes_to_size_t(const int * cumsizes, int nruns)
+{
+    size_t * set_cumsizes = malloc(nruns * sizeof(*set_cumsizes));
+    for (int k = 0; k < nruns; k++)
+        set_cumsizes[k] = (size_t) cumsizes[k];
+    return set_cumsizes;
+}
+
 static eaf_t **
 compute_eaf_helper (SEXP DATA, int nobj, const int * cumsizes, int nruns,
-                    const double *percentile, int nlevels)
+                    const double *percentile, int nlevels, bool store_attained)
 {
     double *data = REAL(DATA);
     int *level = levels_from_percentiles(percentile, nlevels, nruns);
@@ -30,7 +39,10 @@ compute_eaf_helper (SEXP DATA, int nobj, const int * cumsizes, int nruns,
         Rprintf ("}, %d)\n", nlevels);
         );
 
-    eaf_t **eaf = attsurf (data, nobj, cumsizes, nruns, level, nlevels);
+    size_t * set_cumsizes = cumsizes_to_size_t(cumsizes, nruns);
+    eaf_t **eaf = attsurf (data, nobj, set_cumsizes, nruns, level, nlevels,
+                           store_attained);
+    free (set_cumsizes);
     free (level);
 
     DEBUG2(
@@ -50,16 +62,77 @@ compute_eaf_C(SEXP DATA, SEXP CUMSIZES, SEXP PERCENTILE)
     SEXP_2_DOUBLE_VECTOR_OR_NULL(PERCENTILE, percentile, nlevels);
     if (!percentile) nlevels = nruns;
 
-    eaf_t **eaf = compute_eaf_helper(DATA, nobj, cumsizes, nruns, percentile, nlevels);
-    int totalpoints = eaf_totalpoints (eaf, nlevels);
+    eaf_t **eaf = compute_eaf_helper(DATA, nobj, cumsizes, nruns, percentile, nlevels,
+                                     /* store_attained = */false);
+    const size_t totalpoints = eaf_totalpoints (eaf, nlevels);
 
-    SEXP mat = PROTECT(Rf_allocMatrix(REALSXP, totalpoints, nobj + 1));
+    SEXP mat = PROTECT(Rf_allocMatrix(REALSXP, size_t_2_nrows(totalpoints), nobj + 1));
     eaf2matrix_R(REAL(mat), eaf, nobj, totalpoints, percentile, nlevels);
     eaf_free(eaf, nlevels);
     UNPROTECT(1);
     return mat;
 }
 
+SEXP
+vorob_t_C(SEXP DATA, SEXP CUMSIZES, SEXP REFERENCE)
+{
+    int nprotected = 0;
+    const int nobj = Rf_nrows(DATA); /* We transpose the matrix before calling this function. */
+    SEXP_2_INT_VECTOR(CUMSIZES, cumsizes, nruns);
+    SEXP_2_DOUBLE_VECTOR(REFERENCE, reference, reference_len);
+    assert(nobj == reference_len);
+
+    size_t * set_cumsizes = cumsizes_to_size_t(cumsizes, nruns);
+    double threshold, avg_hyp;
+    size_t ve_npoints;
+    double * ve = vorob_expectation(&threshold, &avg_hyp, &ve_npoints, REAL(DATA), nobj,
+                                    set_cumsizes, nruns, reference);
+    free(set_cumsizes);
+
+    new_real_matrix(ve_mat, size_t_2_nrows(ve_npoints), nobj);
+    for (size_t i = 0; i < ve_npoints; i++)
+        for (int j = 0; j < nobj; j++)
+            ve_mat[i + j * ve_npoints] = ve[j + i * nobj];
+    free(ve);
+
+    new_real_vector(thr, 1);
+    thr[0] = threshold;
+    new_real_vector(avg, 1);
+    avg[0] = avg_hyp;
+
+    new_list(res, 3);
+    list_push_back(res, thr);
+    list_push_back(res, ve_mat);
+    list_push_back(res, avg);
+
+    new_string_vector(names, list_len(res));
+    string_vector_push_back(names, "threshold");
+    string_vector_push_back(names, "ve");
+    string_vector_push_back(names, "avg_hyp");
+    set_names(res, names);
+
+    UNPROTECT(nprotected);
+    return Rexp(res);
+}
+
+SEXP
+vorob_dev_C(SEXP DATA, SEXP CUMSIZES, SEXP REFERENCE, SEXP VE)
+{
+    /* We transpose the matrices before calling this function. */
+    const int nobj = Rf_nrows(DATA);
+    SEXP_2_INT_VECTOR(CUMSIZES, cumsizes, nruns);
+    SEXP_2_DOUBLE_VECTOR(REFERENCE, reference, reference_len);
+    SEXP_2_DOUBLE_MATRIX(VE, ve, ve_nobj, ve_npoints);
+    assert(nobj == reference_len);
+    assert(nobj == ve_nobj);
+
+    size_t * set_cumsizes = cumsizes_to_size_t(cumsizes, nruns);
+    double vd = vorob_deviation(REAL(DATA), nobj, set_cumsizes, nruns, reference,
+                                ve, (size_t) ve_npoints);
+    free(set_cumsizes);
+    return Rf_ScalarReal(vd);
+}
+
 SEXP
 compute_eafdiff_C(SEXP DATA, SEXP CUMSIZES, SEXP INTERVALS)
 {
@@ -67,21 +140,22 @@ compute_eafdiff_C(SEXP DATA, SEXP CUMSIZES, SEXP INTERVALS)
     SEXP_2_INT_VECTOR(CUMSIZES, cumsizes, nruns);
     SEXP_2_INT(INTERVALS, intervals);
     /* FIXME: This is similar to eafdiff_compute_matrix() */
-    eaf_t **eaf = compute_eaf_helper(DATA, nobj, cumsizes, nruns, NULL, nruns);
-    const int totalpoints = eaf_totalpoints (eaf, nruns);
+    eaf_t **eaf = compute_eaf_helper(DATA, nobj, cumsizes, nruns, NULL, nruns,
+                                     /* store_attained = */true);
+    const size_t totalpoints = eaf_totalpoints (eaf, nruns);
 
-    SEXP mat = PROTECT(Rf_allocMatrix(REALSXP, totalpoints, nobj + 1));
+    SEXP mat = PROTECT(Rf_allocMatrix(REALSXP, size_t_2_nrows(totalpoints), nobj + 1));
     double * rmat = REAL(mat);
 
-    int pos = 0;
+    size_t pos = 0;
     for (int k = 0; k < nruns; k++) {
-        int npoints = (int) eaf[k]->size;
+        const size_t npoints = eaf[k]->size;
         DEBUG2(
-            int totalsize = npoints * nobj;
-            Rprintf ("totalpoints eaf[%d] = %d\n", k, totalsize)
+            size_t totalsize = npoints * nobj;
+            Rprintf ("totalpoints eaf[%d] = %zu\n", k, totalsize)
             );
         // FIXME: Find the most efficient order of the loop.
-        for (int i = 0; i < npoints; i++) {
+        for (size_t i = 0; i < npoints; i++) {
             for (int j = 0; j < nobj; j++) {
                 rmat[pos + j * totalpoints] = eaf[k]->data[j + i * nobj];
             }
@@ -91,8 +165,8 @@ compute_eafdiff_C(SEXP DATA, SEXP CUMSIZES, SEXP INTERVALS)
     const int nsets1 = nruns / 2;
     pos += (nobj - 1) * totalpoints;
     for (int k = 0; k < nruns; k++) {
-        int npoints = (int) eaf[k]->size;
-        for (int i = 0; i < npoints; i++) {
+        const size_t npoints = eaf[k]->size;
+        for (size_t i = 0; i < npoints; i++) {
             rmat[pos] = eafdiff_percentile(eaf[k], i, nsets1, nruns, intervals);
             pos++;
         }
@@ -134,12 +208,13 @@ compute_eafdiff_rectangles_C(SEXP DATA, SEXP CUMSIZES, SEXP INTERVALS)
     SEXP_2_INT_VECTOR(CUMSIZES, cumsizes, nruns);
     SEXP_2_INT(INTERVALS, intervals);
 
-    eaf_t ** eaf = compute_eaf_helper(DATA, nobj, cumsizes, nruns, NULL, nruns);
+    eaf_t ** eaf = compute_eaf_helper(DATA, nobj, cumsizes, nruns, NULL, nruns,
+                                      /* store_attained = */true);
     eaf_polygon_t * rects = eaf_compute_rectangles(eaf, nobj, nruns);
     eaf_free(eaf, nruns);
 
     const int division = nruns / 2;
-    int nrow = (int) vector_int_size(&rects->col);
+    const int nrow = size_t_2_nrows(vector_int_size(&rects->col));
     // Two points per row + color
     new_real_matrix (result, nrow, 2 * nobj + 1);
     const double * p_xy = vector_objective_begin(&rects->xy);
@@ -173,7 +248,8 @@ compute_eafdiff_polygon_C(SEXP DATA, SEXP CUMSIZES, SEXP INTERVALS)
     SEXP_2_INT_VECTOR(CUMSIZES, cumsizes, nruns);
     SEXP_2_INT(INTERVALS, intervals);
 
-    eaf_t **eaf = compute_eaf_helper(DATA, nobj, cumsizes, nruns, NULL, nruns);
+    eaf_t **eaf = compute_eaf_helper(DATA, nobj, cumsizes, nruns, NULL, nruns,
+                                     /* store_attained = */true);
     eaf_polygon_t *p = eaf_compute_area(eaf, nobj, nruns);
     eaf_free(eaf, nruns);
 
@@ -445,19 +521,19 @@ whv_hype_C(SEXP DATA, SEXP IDEAL, SEXP REFERENCE, SEXP NSAMPLES, SEXP DIST, SEXP
     SEXP_2_DOUBLE_VECTOR(REFERENCE, reference, reference_len);
     SEXP_2_INT(NSAMPLES, nsamples);
     assert(reference_len == ideal_len);
-    assert(reference_len == 2);
+    assert(reference_len == nobj);
     SEXP_2_STRING(DIST, dist_type);
     SEXP_2_UINT32(SEED, seed);
 
     double hv;
     if (0 == strcmp(dist_type, "uniform")) {
-        hv = whv_hype_unif(data, npoints, ideal, reference, nsamples, seed);
+        hv = whv_hype_unif(data, npoints, (dimension_t) nobj, ideal, reference, nsamples, seed);
     } else if (0 == strcmp(dist_type, "exponential")) {
         const double * mu = REAL(MU);
-        hv = whv_hype_expo(data, npoints, ideal, reference, nsamples, seed, mu[0]);
+        hv = whv_hype_expo(data, npoints, (dimension_t) nobj, ideal, reference, nsamples, seed, mu[0]);
     } else if (0 == strcmp(dist_type, "point")) {
         const double * mu = REAL(MU);
-        hv = whv_hype_gaus(data, npoints, ideal, reference, nsamples, seed, mu);
+        hv = whv_hype_gaus(data, npoints, (dimension_t) nobj, ideal, reference, nsamples, seed, mu);
     } else {
         Rf_error("unknown 'dist' value: %s", dist_type);
     }
@@ -538,7 +614,7 @@ enum unary_metric_t {
 
 static inline SEXP
 unary_metric_ref(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE,
-                 enum unary_metric_t metric, SEXP EXTRA)
+                 enum unary_metric_t metric, SEXP EXTRA, SEXP NORM)
 {
     // We transpose the matrix before calling this function.
     SEXP_2_DOUBLE_MATRIX(DATA, data, nobj, npoint);
@@ -556,15 +632,21 @@ unary_metric_ref(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE,
       case EPSILON_MUL:
           value = epsilon_mult(data, npoint, nobj, ref, ref_size, maximise);
           break;
-      case INV_GD:
-          value = IGD(data, npoint, nobj, ref, ref_size, maximise);
+      case INV_GD: {
+          SEXP_2_INT(NORM, norm);
+          value = IGD_norm(data, npoint, nobj, ref, ref_size, maximise, (dist_norm_t) norm);
           break;
-      case INV_GDPLUS:
-          value = IGD_plus(data, npoint, nobj, ref, ref_size, maximise);
+      }
+      case INV_GDPLUS: {
+          SEXP_2_INT(NORM, norm);
+          value = IGD_plus_norm(data, npoint, nobj, ref, ref_size, maximise, (dist_norm_t) norm);
           break;
+      }
       case AVG_HAUSDORFF: {
           SEXP_2_INT(EXTRA, p);
-          value = avg_Hausdorff_dist(data, npoint, nobj, ref, ref_size, maximise, p);
+          SEXP_2_INT(NORM, norm);
+          value = avg_Hausdorff_dist_norm(data, npoint, nobj, ref, ref_size, maximise, p,
+                                          (dist_norm_t) norm);
           break;
       }
       default:
@@ -577,31 +659,104 @@ unary_metric_ref(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE,
 SEXP
 epsilon_mul_C(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE)
 {
-    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, EPSILON_MUL, R_NilValue));
+    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, EPSILON_MUL, R_NilValue, R_NilValue));
 }
 
 SEXP
 epsilon_add_C(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE)
 {
-    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, EPSILON_ADD, R_NilValue));
+    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, EPSILON_ADD, R_NilValue, R_NilValue));
+}
+
+SEXP
+igd_C(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE, SEXP NORM)
+{
+    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, INV_GD, R_NilValue, NORM));
+}
+
+SEXP
+igd_plus_C(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE, SEXP NORM)
+{
+    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, INV_GDPLUS, R_NilValue, NORM));
+}
+
+SEXP
+avg_hausdorff_dist_C(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE, SEXP P, SEXP NORM)
+{
+    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, AVG_HAUSDORFF, P, NORM));
+}
+
+static void
+gd_refset_finalizer(SEXP REFSET)
+{
+    gd_refset_t * refset = R_ExternalPtrAddr(REFSET);
+    if (refset == NULL)
+        return;
+    gd_refset_free(refset);
+    R_ClearExternalPtr(REFSET);
+}
+
+SEXP
+gd_refset_new_C(SEXP REFERENCE, SEXP MAXIMISE, SEXP NORM)
+{
+    // We transpose the matrix before calling this function.
+    SEXP_2_DOUBLE_MATRIX(REFERENCE, ref, nobj, ref_size);
+    SEXP_2_LOGICAL_INT_VECTOR(MAXIMISE, maximise, maximise_len);
+    assert (nobj == maximise_len);
+    SEXP_2_INT(NORM, norm);
+    gd_refset_t * refset = gd_refset_new(ref, (size_t) ref_size, (dimension_t) nobj, maximise,
+                                         (dist_norm_t) norm);
+    SEXP ptr = PROTECT(R_MakeExternalPtr(refset, R_NilValue, R_NilValue));
+    R_RegisterCFinalizerEx(ptr, gd_refset_finalizer, TRUE);
+    UNPROTECT(1);
+    return ptr;
+}
+
+static inline SEXP
+unary_metric_refset(SEXP REFSET, SEXP DATA, enum unary_metric_t metric, SEXP EXTRA)
+{
+    const gd_refset_t * refset = R_ExternalPtrAddr(REFSET);
+    if (refset == NULL)
+        Rf_error("invalid reference set (it cannot be saved and restored)");
+    // We transpose the matrix before calling this function.
+    SEXP_2_DOUBLE_MATRIX(DATA, data, nobj, npoint);
+    assert(nobj == refset->dim);
+
+    double value;
+    switch (metric) {
+      case INV_GD:
+          value = IGD_refset(refset, data, npoint);
+          break;
+      case INV_GDPLUS:
+          value = IGD_plus_refset(refset, data, npoint);
+          break;
+      case AVG_HAUSDORFF: {
+          SEXP_2_INT(EXTRA, p);
+          value = avg_Hausdorff_dist_refset(refset, data, npoint, p);
+          break;
+      }
+      default:
+          Rf_error("unknown unary metric");
+    }
+    return Rf_ScalarReal(value);
 }
 
 SEXP
-igd_C(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE)
+igd_refset_C(SEXP REFSET, SEXP DATA)
 {
-    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, INV_GD, R_NilValue));
+    return(unary_metric_refset(REFSET, DATA, INV_GD, R_NilValue));
 }
 
 SEXP
-igd_plus_C(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE)
+igd_plus_refset_C(SEXP REFSET, SEXP DATA)
 {
-    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, INV_GDPLUS, R_NilValue));
+    return(unary_metric_refset(REFSET, DATA, INV_GDPLUS, R_NilValue));
 }
 
 SEXP
-avg_hausdorff_dist_C(SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE, SEXP P)
+avg_hausdorff_dist_refset_C(SEXP REFSET, SEXP DATA, SEXP P)
 {
-    return(unary_metric_ref(DATA, REFERENCE, MAXIMISE, AVG_HAUSDORFF, P));
+    return(unary_metric_refset(REFSET, DATA, AVG_HAUSDORFF, P));
 }
 
 #define MOOCORE_CONSTANT_LIST(NEW_CONSTANT)                                    \
@@ -3,6 +3,8 @@ DECLARE_CALL(compute_eaf_C, SEXP DATA, SEXP CUMSIZES, SEXP PERCENTILE)
 DECLARE_CALL(compute_eafdiff_C, SEXP DATA, SEXP CUMSIZES, SEXP INTERVALS)
 DECLARE_CALL(compute_eafdiff_polygon_C, SEXP DATA, SEXP CUMSIZES, SEXP INTERVALS)
 DECLARE_CALL(compute_eafdiff_rectangles_C, SEXP DATA, SEXP CUMSIZES, SEXP INTERVALS)
+DECLARE_CALL(vorob_t_C, SEXP DATA, SEXP CUMSIZES, SEXP REFERENCE)
+DECLARE_CALL(vorob_dev_C, SEXP DATA, SEXP CUMSIZES, SEXP REFERENCE, SEXP VE)
 DECLARE_CALL(R_read_datasets, SEXP FILENAME)
 DECLARE_CALL(hypervolume_C, SEXP DATA, SEXP REFERENCE)
 DECLARE_CALL(r2_exact_C, SEXP DATA, SEXP REFERENCE)
@@ -13,9 +15,13 @@ DECLARE_CALL(any_dominated_C, SEXP DATA, SEXP MAXIMISE)
 DECLARE_CALL(pareto_ranking_C, SEXP DATA)
 DECLARE_CALL(epsilon_mul_C, SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE)
 DECLARE_CALL(epsilon_add_C, SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE)
-DECLARE_CALL(igd_C, SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE)
-DECLARE_CALL(igd_plus_C, SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE)
-DECLARE_CALL(avg_hausdorff_dist_C, SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE, SEXP P)
+DECLARE_CALL(igd_C, SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE, SEXP NORM)
+DECLARE_CALL(igd_plus_C, SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE, SEXP NORM)
+DECLARE_CALL(avg_hausdorff_dist_C, SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE, SEXP P, SEXP NORM)
+DECLARE_CALL(gd_refset_new_C, SEXP REFERENCE, SEXP MAXIMISE, SEXP NORM)
+DECLARE_CALL(igd_refset_C, SEXP REFSET, SEXP DATA)
+DECLARE_CALL(igd_plus_refset_C, SEXP REFSET, SEXP DATA)
+DECLARE_CALL(avg_hausdorff_dist_refset_C, SEXP REFSET, SEXP DATA, SEXP P)
 DECLARE_CALL(rect_weighted_hv2d_C, SEXP DATA, SEXP RECTANGLES, SEXP REFERENCE)
 DECLARE_CALL(whv_hype_C, SEXP DATA, SEXP IDEAL, SEXP REFERENCE, SEXP NSAMPLES, SEXP DIST, SEXP SEED, SEXP MU)
 DECLARE_CALL(hv_approx_dz2019_mc_C, SEXP DATA, SEXP REFERENCE, SEXP MAXIMISE, SEXP NSAMPLES, SEXP SEED)